@@ -0,0 +1,122 @@
+//
+// Created by x2h1z on 2021/12/8.
+//
+
+#ifndef ORDERBOOK_BENCH_H
+#define ORDERBOOK_BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "fmt/format.h"
+
+namespace x2h::bench
+{
+    using Clock = std::chrono::steady_clock;
+
+    /*!
+     * @brief 阻止编译器把结果当作无用值优化掉
+    */
+    template<typename T>
+    inline void do_not_optimize(const T &value) noexcept
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    inline int64_t elapsed_ns(Clock::time_point begin, Clock::time_point end) noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+    }
+
+    /*!
+     * @brief 单次操作耗时的样本集合
+    */
+    class Samples
+    {
+    public:
+        explicit Samples(size_t reserve = 0)
+        { samples_.reserve(reserve); }
+
+        /*!
+         * @brief 计时一次操作, 扣除时钟本身的开销
+        */
+        template<typename Fn>
+        void measure(Fn &&fn)
+        {
+            auto begin = Clock::now();
+            fn();
+            auto end = Clock::now();
+            samples_.push_back(std::max<int64_t>(elapsed_ns(begin, end) - overhead(), 0));
+        }
+
+        void add(int64_t ns)
+        { samples_.push_back(ns); }
+
+        size_t size() const noexcept
+        { return samples_.size(); }
+
+        /*!
+         * @brief 排序后可取分位数
+        */
+        void finish()
+        { std::sort(samples_.begin(), samples_.end()); }
+
+        int64_t percentile(double p) const noexcept
+        {
+            if (samples_.empty()) return 0;
+            auto rank = static_cast<size_t>(p * static_cast<double>(samples_.size() - 1));
+            return samples_[rank];
+        }
+
+        double mean() const noexcept
+        {
+            if (samples_.empty()) return 0;
+            long double total = 0;
+            for (auto ns: samples_) total += ns;
+            return static_cast<double>(total / samples_.size());
+        }
+
+        /*!
+         * @brief 两次连续读时钟的最小间隔
+        */
+        static int64_t overhead()
+        {
+            static const int64_t value = [] {
+                int64_t best = INT64_MAX;
+                for (int i = 0; i < 1000; ++i) {
+                    auto begin = Clock::now();
+                    auto end = Clock::now();
+                    best = std::min(best, elapsed_ns(begin, end));
+                }
+                return best;
+            }();
+            return value;
+        }
+
+    private:
+        std::vector<int64_t> samples_;
+    };
+
+    inline void print_header()
+    {
+        fmt::print("{:<28} {:>8} {:>9} {:>12} {:>10} {:>10} {:>10} {:>10} {:>11}\n",
+                   "benchmark", "depth", "ops", "ns/op", "p50", "p90", "p99", "p99.9", "max");
+    }
+
+    /*!
+     * @brief 输出一行结果, 会对样本排序
+    */
+    inline void print_result(const std::string &name, size_t depth, Samples &samples)
+    {
+        if (samples.size() == 0) return;
+        samples.finish();
+        fmt::print("{:<28} {:>8} {:>9} {:>12.1f} {:>10} {:>10} {:>10} {:>10} {:>11}\n",
+                   name, depth, samples.size(), samples.mean(), samples.percentile(0.5), samples.percentile(0.9),
+                   samples.percentile(0.99), samples.percentile(0.999), samples.percentile(1.0));
+    }
+}
+
+#endif //ORDERBOOK_BENCH_H
@@ -0,0 +1,306 @@
+#include <cstring>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "bench.h"
+#include "book/order_book.h"
+#include "timestamp.h"
+#include "types.h"
+
+/*!
+ * OrderBook 微基准
+ *
+ * 用法: ob_bench [max_depth] [filter]
+ *   max_depth 最大盘口深度(挂单数), 默认 100000
+ *   filter    只运行名称包含该字符串的基准
+ *
+ * 盘口由模型生成的深证逐笔构成: 买价 9.00~9.99, 卖价 10.00~10.99, 不会交叉;
+ * 成交总是吃掉一侧的最优挂单, 撤单随机选择挂单. 计时只包含 OrderBook 调用本身.
+*/
+
+namespace
+{
+    using namespace x2h;
+    using type::data::Order;
+    using type::data::Trade;
+
+    constexpr int TICKS = 100;
+    constexpr size_t DEPTHS[] = {10, 100, 1'000, 10'000, 100'000};
+
+    /* 逐笔类型占比(百分比), 新增与移除各半使深度保持稳定 */
+    struct Mix
+    {
+        const char *name;
+        int cancel;
+        int fill;
+    };
+
+    constexpr Mix MIXES[] = {
+            {"cancel-heavy", 45, 5},
+            {"balanced",     25, 25},
+            {"fill-heavy",   5,  45},
+    };
+
+    /*!
+     * @brief 生成逐笔并同步维护模型盘口, 保证撤单与成交总是指向存在的挂单
+    */
+    class Feed
+    {
+    public:
+        struct Resting
+        {
+            int64_t id;
+            double price;
+            int64_t qty;
+            bool buy;
+        };
+
+        explicit Feed(uint64_t seed)
+                : rng_(seed)
+        {}
+
+        Order add()
+        {
+            bool buy = rng_() % 2 == 0;
+            int tick = static_cast<int>(rng_() % TICKS);
+            Resting resting{next_id_++, (buy ? 900 + tick : 1000 + tick) / 100.0,
+                            static_cast<int64_t>(100 * (1 + rng_() % 10)), buy};
+            insert(resting);
+
+            Order order{};
+            std::strcpy(order.ticker, "000001");
+            stamp(order.time, order.time_ns);
+            order.channel_no = 1;
+            order.order_id = resting.id;
+            order.price = resting.price;
+            order.qty = resting.qty;
+            order.side = buy ? '1' : '2';
+            order.ord_type = '2';
+            order.business_no = resting.id;
+            order.exchange = type::data::Exchange::SZ;
+            return order;
+        }
+
+        Trade cancel()
+        {
+            auto resting = live_[rng_() % live_.size()];
+            erase(resting.id);
+
+            Trade trade = make_trade('4', resting.qty);
+            trade.bid_id = resting.buy ? resting.id : 0;
+            trade.ask_id = resting.buy ? 0 : resting.id;
+            return trade;
+        }
+
+        /*!
+         * @brief 新的主动单吃掉一侧的最优挂单(价格优先, 时间优先)
+        */
+        Trade fill()
+        {
+            bool buy = bids_.empty() || (!asks_.empty() && rng_() % 2 == 0);
+            int64_t id = buy ? bids_.begin()->second : asks_.begin()->second;
+            auto resting = live_[index_[id]];
+            erase(id);
+
+            int64_t aggressor = next_id_++;
+            Trade trade = make_trade('F', resting.qty);
+            trade.price = resting.price;
+            trade.bid_id = buy ? id : aggressor;
+            trade.ask_id = buy ? aggressor : id;
+            return trade;
+        }
+
+        size_t depth() const noexcept
+        { return live_.size(); }
+
+    private:
+        void stamp(int64_t &time, int64_t &time_ns) noexcept
+        {
+            time_ns = util::CONTINUOUS_TRADING_NS + ++clock_ * 1'000;
+            time = 20210903'00'00'00'000 + util::ns_to_hhmmssmmm(time_ns);
+        }
+
+        Trade make_trade(char flag, int64_t qty)
+        {
+            Trade trade{};
+            std::strcpy(trade.ticker, "000001");
+            stamp(trade.time, trade.time_ns);
+            trade.channel_id = 1;
+            trade.trade_id = next_id_;
+            trade.qty = qty;
+            trade.trade_flag = flag;
+            trade.business_no = next_id_++;
+            trade.exchange = type::data::Exchange::SZ;
+            return trade;
+        }
+
+        void insert(const Resting &resting)
+        {
+            index_[resting.id] = live_.size();
+            live_.push_back(resting);
+            if (resting.buy) {
+                bids_.emplace(-resting.price, resting.id);
+            } else {
+                asks_.emplace(resting.price, resting.id);
+            }
+        }
+
+        void erase(int64_t id)
+        {
+            size_t pos = index_[id];
+            const auto &resting = live_[pos];
+            if (resting.buy) {
+                bids_.erase({-resting.price, id});
+            } else {
+                asks_.erase({resting.price, id});
+            }
+
+            index_[live_.back().id] = pos;
+            live_[pos] = live_.back();
+            live_.pop_back();
+            index_.erase(id);
+        }
+
+        std::mt19937_64 rng_;
+        int64_t next_id_{1};
+        int64_t clock_{0};
+
+        std::vector<Resting> live_;
+        std::unordered_map<int64_t, size_t> index_;
+        /* (价格, 序号), 买侧价格取负使 begin() 为最优 */
+        std::set<std::pair<double, int64_t>> bids_;
+        std::set<std::pair<double, int64_t>> asks_;
+    };
+
+    /*!
+     * @brief 深的盘口单次操作更慢, 操作数随深度递减
+    */
+    size_t ops_for(size_t depth) noexcept
+    {
+        return std::clamp<size_t>(2'000'000 / depth, 100, 20'000);
+    }
+
+    /*!
+     * @brief 用 restore_order 直接挂入 depth 笔订单, 避免预热时逐笔撮合的平方开销
+    */
+    void seed(book::OrderBook &book, Feed &feed, size_t depth)
+    {
+        while (feed.depth() < depth) {
+            book.restore_order(feed.add());
+        }
+    }
+
+    struct Runner
+    {
+        std::string_view filter;
+
+        bool enabled(const std::string &name) const
+        { return filter.empty() || name.find(filter) != std::string::npos; }
+
+        template<typename Body>
+        void run(const std::string &name, size_t depth, Body &&body) const
+        {
+            if (!enabled(name)) return;
+
+            //! Symbol 按 8 字节拷贝代码, 字面量只有 7 字节
+            char code[8] = "000001";
+            Symbol symbol{1, code, type::data::Exchange::SZ};
+            book::OrderBook book{symbol};
+            Feed feed{depth};
+            seed(book, feed, depth);
+
+            size_t ops = ops_for(depth);
+            bench::Samples samples{ops};
+            //! 前 10% 作为预热, 不计入结果
+            bench::Samples warmup{ops / 10};
+            for (size_t i = 0; i < ops / 10; ++i) body(book, feed, warmup);
+            for (size_t i = 0; i < ops; ++i) body(book, feed, samples);
+            bench::print_result(name, depth, samples);
+        }
+    };
+
+    void run_depth(const Runner &runner, size_t depth)
+    {
+        //! 新增后撤掉同一笔, 保持深度不变
+        runner.run("on_order/add", depth, [](auto &book, auto &feed, auto &samples) {
+            auto order = feed.add();
+            samples.measure([&] { book.on_order(order); });
+            book.on_trade(feed.cancel());
+        });
+
+        runner.run("on_trade/fill", depth, [](auto &book, auto &feed, auto &samples) {
+            auto trade = feed.fill();
+            samples.measure([&] { book.on_trade(trade); });
+            book.restore_order(feed.add());
+        });
+
+        runner.run("on_trade/cancel", depth, [](auto &book, auto &feed, auto &samples) {
+            auto trade = feed.cancel();
+            samples.measure([&] { book.on_trade(trade); });
+            book.restore_order(feed.add());
+        });
+
+        //! match_order 只看 side, 在不变的盘口上重建档位快照并做一遍交叉检查; 衡量的是快照重建, 不是真实的主动成交
+        runner.run("match_order/snapshot", depth, [](auto &book, auto &, auto &samples) {
+            Order order{};
+            order.side = samples.size() % 2 == 0 ? '1' : '2';
+            order.exchange = type::data::Exchange::SZ;
+            samples.measure([&] { book.match_order(order); });
+        });
+
+        runner.run("depth/top10", depth, [](auto &book, auto &, auto &samples) {
+            type::data::PriceLevel levels[20];
+            samples.measure([&] {
+                int n = 0;
+                for (const auto &[price, qty]: book.get_bid_book()) {
+                    if (n >= 10) break;
+                    levels[n++] = {price, qty};
+                }
+                for (const auto &[price, qty]: book.get_ask_book()) {
+                    if (n >= 20) break;
+                    levels[n++] = {price, qty};
+                }
+                bench::do_not_optimize(levels);
+            });
+        });
+
+        runner.run("depth/best", depth, [](auto &book, auto &, auto &samples) {
+            samples.measure([&] {
+                bench::do_not_optimize(book.best_bid().price);
+                bench::do_not_optimize(book.best_ask().price);
+            });
+        });
+
+        for (const auto &mix: MIXES) {
+            runner.run(std::string("mix/") + mix.name, depth, [&mix](auto &book, auto &feed, auto &samples) {
+                //! 新增与移除交替, 移除按比例在撤单与成交间选择
+                if (samples.size() % 2 == 0) {
+                    auto order = feed.add();
+                    samples.measure([&] { book.on_order(order); });
+                } else {
+                    bool cancel = static_cast<int>(samples.size() / 2 % (mix.cancel + mix.fill)) < mix.cancel;
+                    auto trade = cancel ? feed.cancel() : feed.fill();
+                    samples.measure([&] { book.on_trade(trade); });
+                }
+            });
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    size_t max_depth = argc >= 2 ? std::stoull(argv[1]) : 100'000;
+    Runner runner{argc >= 3 ? std::string_view(argv[2]) : std::string_view{}};
+
+    fmt::print("clock overhead: {} ns (已从样本中扣除), 单位: ns\n", bench::Samples::overhead());
+    bench::print_header();
+    for (auto depth: DEPTHS) {
+        if (depth > max_depth) break;
+        run_depth(runner, depth);
+    }
+    return 0;
+}
@@ -0,0 +1,147 @@
+//
+// Created by x2h1z on 2021/12/15.
+//
+
+#ifndef ORDERBOOK_FLOW_H
+#define ORDERBOOK_FLOW_H
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "book/engine.h"
+#include "containers/fast_hash.h"
+#include "containers/rolling_window.h"
+#include "types.h"
+
+namespace x2h::analytics
+{
+    /*!
+     * @brief 订单流特征配置, 由 key = value 配置文件加载
+     *
+     *  flow.windows_ms = 1000,10000,60000
+     *  flow.buckets    = 20
+    */
+    struct FlowConfig
+    {
+        /* 滚动窗口长度(市场时间) */
+        std::vector<int64_t> windows_ns{1'000'000'000, 10'000'000'000, 60'000'000'000};
+        /* 每个窗口的分桶数 */
+        size_t buckets{20};
+
+        static FlowConfig load(const std::string &file_path);
+    };
+
+    /*!
+     * @brief 由最新盘口得到的瞬时特征
+    */
+    enum class Instant : uint8_t
+    {
+        MID,
+        SPREAD,
+        /* 以对侧数量加权的买一卖一价格 */
+        MICROPRICE,
+        /* 买一卖一数量不平衡 (bid_qty - ask_qty) / (bid_qty + ask_qty) */
+        IMBALANCE,
+        LAST_PRICE,
+        COUNT
+    };
+
+    /*!
+     * @brief 每个滚动窗口上的特征
+    */
+    enum class Windowed : uint8_t
+    {
+        VWAP,
+        VOLUME,
+        /* 买一卖一变化累计的订单流不平衡(Cont, Kukanov, Stoikov) */
+        OFI,
+        /* 撤单数 / 新委托数 */
+        CANCEL_RATE,
+        /* 每秒成交笔数 */
+        TRADE_INTENSITY,
+        COUNT
+    };
+
+    inline constexpr size_t INSTANT_COUNT = static_cast<size_t>(Instant::COUNT);
+    inline constexpr size_t WINDOWED_COUNT = static_cast<size_t>(Windowed::COUNT);
+
+    /*!
+     * @brief 单个窗口桶内的累计量
+    */
+    struct FlowBucket
+    {
+        double notional{0};
+        int64_t volume{0};
+        double ofi{0};
+        uint64_t orders{0};
+        uint64_t cancels{0};
+        uint64_t trades{0};
+
+        FlowBucket &operator+=(const FlowBucket &other) noexcept;
+
+        FlowBucket &operator-=(const FlowBucket &other) noexcept;
+    };
+
+    /*!
+     * @brief 增量维护的订单流特征
+     *
+     * 不自行维护盘口: 调用方先把逐笔事件应用到已有的盘口(BookSet/OrderBook), 再传入事件与更新后的买一卖一,
+     * 由此更新各窗口的分桶合计并算出特征, 不需要重新扫描深度. 快照校正等改动也随盘口反映到特征中. 每个股票的特征是一个扁平数组:
+     * 先是 Instant 的各项, 再按窗口顺序排列 Windowed 的各项; 无定义的值(如单边盘口的中间价)为 NaN.
+     * 特征反映的是该股票最后一个事件时的状态.
+    */
+    class FlowAnalytics
+    {
+    public:
+        explicit FlowAnalytics(FlowConfig config = {});
+
+        ~FlowAnalytics();
+
+        FlowAnalytics(const FlowAnalytics &) = delete;
+
+        FlowAnalytics &operator=(const FlowAnalytics &) = delete;
+
+        /*!
+         * @brief 应用逐笔事件
+         * @param bbo 该事件应用到盘口之后的买一卖一
+         * @return 被更新股票的特征
+        */
+        std::span<const double> on_event(const type::data::Event &event, const book::Bbo &bbo);
+
+        /*!
+         * @return 股票的特征, 未出现过的股票为空
+        */
+        std::span<const double> features(const char *ticker) const;
+
+        size_t feature_count() const noexcept
+        { return INSTANT_COUNT + WINDOWED_COUNT * config_.windows_ns.size(); }
+
+        static size_t index(Instant feature) noexcept
+        { return static_cast<size_t>(feature); }
+
+        static size_t index(Windowed feature, size_t window) noexcept
+        { return INSTANT_COUNT + window * WINDOWED_COUNT + static_cast<size_t>(feature); }
+
+        /*!
+         * @brief 特征名, 窗口特征带窗口长度后缀, 如 vwap_1000ms
+        */
+        std::string feature_name(size_t index) const;
+
+        size_t size() const noexcept
+        { return states_.size(); }
+
+    private:
+        struct State;
+
+        State &state(const type::data::Event &event);
+
+        FlowConfig config_;
+        std::unordered_map<uint64_t, std::unique_ptr<State>, FastHash> states_;
+    };
+}
+
+#endif //ORDERBOOK_FLOW_H
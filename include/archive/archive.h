@@ -0,0 +1,162 @@
+//
+// Created by x2h1z on 2021/11/29.
+//
+
+#ifndef ORDERBOOK_ARCHIVE_H
+#define ORDERBOOK_ARCHIVE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "containers/fast_hash.h"
+#include "dat/mapped_file.h"
+#include "types.h"
+
+namespace x2h::archive
+{
+    /*!
+     * 紧凑存档格式(.oba), 由 .dat 中的逐笔委托/成交转换而来
+     *
+     *  FileHeader
+     *  Block ... 每个块只含一个股票的连续事件, 按列存储
+     *  Footer    股票表及各股票的块索引
+     *  uint64    Footer 偏移
+     *  char[4]   "OBAR"
+     *
+     * 每列: varint(zigzag(base)) + uint8 位宽 + 定宽位打包的值.
+     * 序号/时间/价格等单调或缓变的列存 zigzag 差分, 其余列存与最小值之差;
+     * 不适用于当前行的字段沿用上一行的值(差分为 0). 只收录逐笔委托/成交.
+    */
+    inline constexpr char MAGIC[4] = {'O', 'B', 'A', 'R'};
+    inline constexpr uint32_t VERSION = 1;
+    inline constexpr uint32_t BLOCK_EVENTS = 4096;
+    /* 价格精度: 万分之一元 */
+    inline constexpr double PRICE_SCALE = 10'000.0;
+
+    struct FileHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t block_events;
+        uint32_t reserved;
+    };
+
+    struct BlockHeader
+    {
+        uint32_t symbol;
+        uint32_t count;
+        /* 块数据长度, 不含 BlockHeader */
+        uint32_t length;
+        uint32_t reserved;
+    };
+
+    struct BlockInfo
+    {
+        uint64_t offset;
+        uint32_t count;
+        int64_t first_time_ns;
+        int64_t last_time_ns;
+    };
+
+    struct SymbolInfo
+    {
+        char ticker[20];
+        type::data::Exchange exchange;
+        std::vector<BlockInfo> blocks;
+    };
+
+    /*!
+     * @brief .dat -> .oba 转换
+    */
+    class ArchiveWriter
+    {
+    public:
+        explicit ArchiveWriter(const std::string &file_path);
+
+        ~ArchiveWriter();
+
+        ArchiveWriter(const ArchiveWriter &) = delete;
+
+        ArchiveWriter &operator=(const ArchiveWriter &) = delete;
+
+        bool is_open() const noexcept
+        { return file_ != nullptr; }
+
+        void add(const type::data::Event &event);
+
+        /*!
+         * @brief 写出剩余块与索引
+        */
+        bool close();
+
+        /*!
+         * @brief 转换整个 .dat 文件
+         * @return 写入的事件数
+        */
+        static uint64_t convert(const std::string &dat_file, const std::string &archive_file);
+
+        uint64_t bytes_written() const noexcept
+        { return offset_; }
+
+    private:
+        struct Pending
+        {
+            uint32_t index;
+            std::vector<type::data::Event> events;
+        };
+
+        void flush(Pending &pending);
+
+        std::FILE *file_;
+        uint64_t offset_{0};
+        std::vector<SymbolInfo> symbols_;
+        std::unordered_map<uint64_t, Pending, FastHash> pending_;
+        std::vector<char> buffer_;
+    };
+
+    using EventCallback = std::function<void(const type::data::Event &)>;
+
+    /*!
+     * @brief .oba 读取, 支持按股票随机访问
+    */
+    class ArchiveReader
+    {
+    public:
+        explicit ArchiveReader(const std::string &file_path);
+
+        bool is_open() const noexcept
+        { return valid_; }
+
+        const std::vector<SymbolInfo> &symbols() const noexcept
+        { return symbols_; }
+
+        /*!
+         * @brief 按块在文件中的顺序读取全部事件; 单个股票内有序, 股票之间按块交错
+        */
+        uint64_t read(const EventCallback &callback) const;
+
+        /*!
+         * @brief 只读取一个股票的事件
+        */
+        uint64_t read_symbol(const char *ticker, const EventCallback &callback) const;
+
+        /*!
+         * @brief 解码一个块
+        */
+        size_t decode_block(uint64_t offset, std::vector<type::data::Event> &events) const;
+
+    private:
+        bool parse_footer();
+
+        MappedFile mapping_;
+        bool valid_{false};
+        std::vector<SymbolInfo> symbols_;
+        std::unordered_map<uint64_t, uint32_t, FastHash> index_;
+    };
+}
+
+#endif //ORDERBOOK_ARCHIVE_H
@@ -0,0 +1,102 @@
+//
+// Created by x2h1z on 2021/11/29.
+//
+
+#ifndef ORDERBOOK_BITPACK_H
+#define ORDERBOOK_BITPACK_H
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace x2h::archive
+{
+    inline uint64_t zigzag(int64_t v) noexcept
+    {
+        return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+    }
+
+    inline int64_t unzigzag(uint64_t v) noexcept
+    {
+        return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+    }
+
+    inline void put_varint(std::vector<char> &out, uint64_t v)
+    {
+        while (v >= 0x80) {
+            out.push_back(static_cast<char>(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back(static_cast<char>(v));
+    }
+
+    inline uint64_t get_varint(const char *&p) noexcept
+    {
+        uint64_t v = 0;
+        for (int shift = 0;; shift += 7) {
+            auto byte = static_cast<uint8_t>(*p++);
+            v |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (byte < 0x80) return v;
+        }
+    }
+
+    /*!
+     * @brief 打包后的字节数, 末尾多留一个字, 解码时可无分支读取相邻两个字
+    */
+    inline size_t packed_size(size_t n, int width) noexcept
+    {
+        return ((n * width + 63) / 64 + 1) * sizeof(uint64_t);
+    }
+
+    /*!
+     * @brief 定宽位打包
+    */
+    inline void pack(const uint64_t *in, size_t n, int width, std::vector<char> &out)
+    {
+        std::vector<uint64_t> words(packed_size(n, width) / sizeof(uint64_t), 0);
+        if (width > 0) {
+            for (size_t i = 0; i < n; ++i) {
+                size_t bit = i * width;
+                size_t index = bit >> 6;
+                unsigned shift = bit & 63;
+                words[index] |= in[i] << shift;
+                if (shift + width > 64) words[index + 1] |= in[i] >> (64 - shift);
+            }
+        }
+        auto offset = out.size();
+        out.resize(offset + words.size() * sizeof(uint64_t));
+        std::memcpy(out.data() + offset, words.data(), words.size() * sizeof(uint64_t));
+    }
+
+    /*!
+     * @brief 定宽位解包. 循环内无数据相关分支, 编译器可向量化
+    */
+    inline void unpack(const char *in, size_t n, int width, uint64_t *out) noexcept
+    {
+        if (width == 0) {
+            std::memset(out, 0, n * sizeof(uint64_t));
+            return;
+        }
+
+        const uint64_t mask = ~uint64_t{0} >> (64 - width);
+        for (size_t i = 0; i < n; ++i) {
+            size_t bit = i * width;
+            size_t index = bit >> 6;
+            unsigned shift = bit & 63;
+
+            uint64_t lo, hi;
+            std::memcpy(&lo, in + index * sizeof(uint64_t), sizeof(lo));
+            std::memcpy(&hi, in + (index + 1) * sizeof(uint64_t), sizeof(hi));
+            //! shift 为 0 时 hi 的贡献为 0, 拆成两次移位避免移 64 位
+            out[i] = ((lo >> shift) | ((hi << 1) << (63 - shift))) & mask;
+        }
+    }
+
+    inline int bit_width(uint64_t max) noexcept
+    {
+        return static_cast<int>(std::bit_width(max));
+    }
+}
+
+#endif //ORDERBOOK_BITPACK_H
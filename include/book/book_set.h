@@ -0,0 +1,135 @@
+//
+// Created by x2h1z on 2021/11/18.
+//
+
+#ifndef ORDERBOOK_BOOK_SET_H
+#define ORDERBOOK_BOOK_SET_H
+
+#include <cstdio>
+#include <memory>
+#include <unordered_map>
+
+#include "book/order_book.h"
+#include "containers/fast_hash.h"
+#include "types.h"
+
+namespace x2h::book
+{
+    /*!
+     * @brief 多个股票的 OrderBook 集合, 按股票代码(FastHash::Parse)索引
+    */
+    class BookSet
+    {
+    public:
+        using BookMap = std::unordered_map<uint64_t, std::unique_ptr<OrderBook>, FastHash>;
+
+        /*!
+         * @param max_books 最多维护的 OrderBook 数量, 0 表示不限
+        */
+        explicit BookSet(size_t max_books = 0);
+
+        static uint64_t key(const char *ticker) noexcept
+        { return FastHash::Parse(ticker); }
+
+        OrderBook *find(uint64_t key) const noexcept;
+
+        OrderBook *find(const char *ticker) const noexcept
+        { return find(key(ticker)); }
+
+        /*!
+         * @brief 查找或创建 OrderBook
+         * @return 超出 max_books 时返回 nullptr
+        */
+        OrderBook *get_or_create(const char *ticker, type::data::Exchange exchange);
+
+        /*!
+         * @brief 把逐笔事件应用到对应的 OrderBook
+         * @return 被更新的 OrderBook, 未能创建时返回 nullptr
+        */
+        OrderBook *apply(const type::data::Event &event);
+
+        size_t size() const noexcept
+        { return books_.size(); }
+
+        size_t max_books() const noexcept
+        { return max_books_; }
+
+        /* 因超出 max_books 被忽略的事件数 */
+        uint64_t rejected() const noexcept
+        { return rejected_; }
+
+        /*!
+         * @brief 开启空闲压缩: apply 时每隔 idle_ns 扫描一次, 超过 idle_ns 没有消息的 OrderBook 转为紧凑表示
+         * @param idle_ns 0 表示关闭
+        */
+        void set_compaction(int64_t idle_ns) noexcept
+        { idle_ns_ = idle_ns; }
+
+        /*!
+         * @brief 压缩 [now_ns - idle_ns, now_ns] 内没有消息的 OrderBook
+         * @return 本次压缩的数量
+        */
+        size_t compact_idle(int64_t now_ns, int64_t idle_ns);
+
+        /* 处于紧凑表示的 OrderBook 数量 */
+        size_t compacted() const noexcept;
+
+        /*!
+         * @brief 全部 OrderBook 的内存占用之和, 不含 BookSet 自身的哈希表
+        */
+        BookMemory memory() const noexcept;
+
+        /*!
+         * @brief 输出内存占用最多的 top 个 OrderBook 与合计
+        */
+        void log_memory(size_t top) const;
+
+        /*!
+         * @brief 全部 OrderBook 挂单集合的摘要; 各 OrderBook 的摘要是增量维护的, 这里只按股票合并
+        */
+        uint64_t digest() const noexcept;
+
+        BookMap::const_iterator begin() const noexcept
+        { return books_.begin(); }
+
+        BookMap::const_iterator end() const noexcept
+        { return books_.end(); }
+
+        void clear() noexcept
+        { books_.clear(); }
+
+        /*!
+         * @brief 取出 OrderBook 的所有权, 不存在时返回空
+        */
+        std::unique_ptr<OrderBook> extract(uint64_t key);
+
+        /*!
+         * @brief 放入 OrderBook, 替换同代码的已有 OrderBook
+        */
+        void insert(std::unique_ptr<OrderBook> book);
+
+        bool erase(uint64_t key)
+        { return books_.erase(key) > 0; }
+
+        /*!
+         * @brief 以二进制形式保存所有 OrderBook
+        */
+        bool save(std::FILE *file) const;
+
+        /*!
+         * @brief 清空当前内容并从 save 的输出恢复
+        */
+        bool load(std::FILE *file);
+
+    private:
+        BookMap books_;
+        size_t max_books_;
+        int next_id_{1};
+        uint64_t rejected_{0};
+        int64_t idle_ns_{0};
+        /* 下一次空闲扫描的时间, 0 表示尚未开始 */
+        int64_t next_compact_ns_{0};
+    };
+}
+
+#endif //ORDERBOOK_BOOK_SET_H
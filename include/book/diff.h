@@ -0,0 +1,162 @@
+//
+// Created by x2h1z on 2021/12/13.
+//
+
+#ifndef ORDERBOOK_DIFF_H
+#define ORDERBOOK_DIFF_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "book/engine.h"
+#include "containers/fast_hash.h"
+#include "perf/latency.h"
+#include "types.h"
+
+namespace x2h::book
+{
+    inline constexpr int32_t DIFF_MAX_LEVELS = 10;
+
+    /*!
+     * @brief 差分比对的结果: 首次分歧与两个引擎各自的耗时
+    */
+    struct DiffReport
+    {
+        uint64_t events{0};
+        /* 比较过的盘口次数 */
+        uint64_t compared{0};
+        /* 出现分歧的股票数, 分歧后该股票不再比较 */
+        uint64_t diverged{0};
+
+        /* 首次分歧的事件序号(从 1 开始), 0 表示没有分歧 */
+        uint64_t first_event{0};
+        char ticker[20]{};
+        /* 逐笔时间, 交易所原始格式 */
+        int64_t time{0};
+        /* "bbo" 或 "depth" */
+        const char *what{""};
+        /* 0 买 1 卖 */
+        int side{0};
+        int32_t level{0};
+        type::data::PriceLevel reference{};
+        type::data::PriceLevel candidate{};
+
+        /* 各自处理逐笔消息累计的 TSC 周期, 不含比对 */
+        uint64_t reference_cycles{0};
+        uint64_t candidate_cycles{0};
+    };
+
+    /*!
+     * @brief 输出比对结论与两个引擎的吞吐
+    */
+    void log_diff(const DiffReport &report, const char *reference, const char *candidate);
+
+    /*!
+     * @brief 以同一逐笔流同时驱动参考引擎与待测引擎, 每条消息后比对被更新股票的 BBO 与前 levels 档
+     *
+     * 两个引擎的处理分别以 TSC 计时, 比对不计入.
+    */
+    template<BookEngine Reference, BookEngine Candidate>
+    class DiffHarness
+    {
+    public:
+        explicit DiffHarness(int32_t levels = 5, double tolerance = 1e-6)
+                : levels_(std::clamp(levels, 1, DIFF_MAX_LEVELS)), tolerance_(tolerance)
+        {}
+
+        /*!
+         * @return 该股票的两个盘口是否一致
+        */
+        bool apply(const type::data::Event &event)
+        {
+            ++report_.events;
+            const auto key = FastHash::Parse(event.ticker());
+
+            auto it = books_.find(key);
+            if (it == books_.end()) {
+                Symbol symbol{next_id_++, event.ticker(), event.exchange()};
+                it = books_.emplace(key, Pair{std::make_unique<Reference>(symbol),
+                                              std::make_unique<Candidate>(symbol)}).first;
+            }
+            auto &[reference, candidate] = it->second;
+
+            uint64_t start = perf::rdtsc();
+            apply_event(*reference, event);
+            uint64_t middle = perf::rdtsc();
+            apply_event(*candidate, event);
+            uint64_t end = perf::rdtsc();
+            report_.reference_cycles += middle - start;
+            report_.candidate_cycles += end - middle;
+
+            if (diverged_.contains(key)) return false;
+            return compare(key, event, *reference, *candidate);
+        }
+
+        const DiffReport &report() const noexcept
+        { return report_; }
+
+    private:
+        using Pair = std::pair<std::unique_ptr<Reference>, std::unique_ptr<Candidate>>;
+
+        bool same(const type::data::PriceLevel &a, const type::data::PriceLevel &b) const noexcept
+        {
+            return std::abs(a.price - b.price) <= tolerance_ && a.qty == b.qty;
+        }
+
+        bool compare(uint64_t key, const type::data::Event &event, const Reference &reference,
+                     const Candidate &candidate)
+        {
+            ++report_.compared;
+
+            auto x = reference.bbo();
+            auto y = candidate.bbo();
+            if (!same(x.bid, y.bid)) return diverge(key, event, "bbo", 0, 0, x.bid, y.bid);
+            if (!same(x.ask, y.ask)) return diverge(key, event, "bbo", 1, 0, x.ask, y.ask);
+
+            type::data::PriceLevel a[DIFF_MAX_LEVELS];
+            type::data::PriceLevel b[DIFF_MAX_LEVELS];
+            for (int side = 0; side < 2; ++side) {
+                int32_t na = side == 0 ? reference.bid_depth(a, levels_) : reference.ask_depth(a, levels_);
+                int32_t nb = side == 0 ? candidate.bid_depth(b, levels_) : candidate.ask_depth(b, levels_);
+                for (int32_t i = 0; i < std::max(na, nb); ++i) {
+                    auto ra = i < na ? a[i] : type::data::PriceLevel{};
+                    auto rb = i < nb ? b[i] : type::data::PriceLevel{};
+                    if (!same(ra, rb)) return diverge(key, event, "depth", side, i, ra, rb);
+                }
+            }
+            return true;
+        }
+
+        bool diverge(uint64_t key, const type::data::Event &event, const char *what, int side, int32_t level,
+                     const type::data::PriceLevel &reference, const type::data::PriceLevel &candidate)
+        {
+            ++report_.diverged;
+            diverged_.insert(key);
+            if (report_.first_event != 0) return false;
+
+            report_.first_event = report_.events;
+            std::strncpy(report_.ticker, event.ticker(), sizeof(report_.ticker) - 1);
+            report_.time = event.type == type::data::EventType::ORDER ? event.order.time : event.trade.time;
+            report_.what = what;
+            report_.side = side;
+            report_.level = level;
+            report_.reference = reference;
+            report_.candidate = candidate;
+            return false;
+        }
+
+        int32_t levels_;
+        double tolerance_;
+        int next_id_{1};
+        std::unordered_map<uint64_t, Pair, FastHash> books_;
+        std::unordered_set<uint64_t, FastHash> diverged_;
+        DiffReport report_;
+    };
+}
+
+#endif //ORDERBOOK_DIFF_H
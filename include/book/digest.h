@@ -0,0 +1,49 @@
+//
+// Created by x2h1z on 2021/12/14.
+//
+
+#ifndef ORDERBOOK_DIGEST_H
+#define ORDERBOOK_DIGEST_H
+
+#include <cmath>
+#include <cstdint>
+
+namespace x2h::book
+{
+    /*!
+     * @brief splitmix64 的混合函数
+    */
+    inline constexpr uint64_t mix64(uint64_t x) noexcept
+    {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+
+    /*!
+     * @brief 单个挂单 (side, price, qty, id) 对盘口摘要的贡献
+     *
+     * 盘口摘要是全部挂单贡献之和(模 2^64), 与挂单顺序无关; 挂单增删改时加减对应的贡献即可增量维护.
+     * 价格按 0.0001 取整, 避免同一价格的不同浮点表示得到不同摘要.
+    */
+    inline uint64_t order_digest(bool buy, double price, int64_t qty, int64_t id) noexcept
+    {
+        auto ticks = static_cast<uint64_t>(std::llround(price * 10'000));
+        uint64_t h = mix64(ticks ^ (buy ? 0x9e3779b97f4a7c15ULL : 0));
+        h = mix64(h + static_cast<uint64_t>(qty));
+        return mix64(h + static_cast<uint64_t>(id));
+    }
+
+    /*!
+     * @brief 单个股票的盘口摘要在全市场摘要中的贡献, 空盘口为 0
+    */
+    inline uint64_t book_digest(uint64_t key, uint64_t digest) noexcept
+    {
+        return digest == 0 ? 0 : mix64(key ^ mix64(digest));
+    }
+}
+
+#endif //ORDERBOOK_DIGEST_H
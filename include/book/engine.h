@@ -0,0 +1,58 @@
+//
+// Created by x2h1z on 2021/12/13.
+//
+
+#ifndef ORDERBOOK_ENGINE_H
+#define ORDERBOOK_ENGINE_H
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+
+#include "book/symbol.h"
+#include "types.h"
+
+namespace x2h::book
+{
+    /*!
+     * @brief 买一与卖一的价格与合计数量, 没有挂单的一侧为 0
+    */
+    struct Bbo
+    {
+        type::data::PriceLevel bid{};
+        type::data::PriceLevel ask{};
+    };
+
+    /*!
+     * @brief 盘口引擎: 以逐笔委托/成交驱动, 提供按价位合计的深度与最优价
+     *
+     * OrderBook 是参考实现; 其他实现对同一逐笔流应给出相同的深度, 由 DiffHarness 比对.
+     * bid_depth/ask_depth 按价格优先写出前 count 档, 返回实际档数.
+    */
+    template<typename Engine>
+    concept BookEngine = std::constructible_from<Engine, const Symbol &> &&
+                         requires(Engine &engine, const Engine &view, const type::data::Order &order,
+                                  const type::data::Trade &trade, type::data::PriceLevel *levels, int32_t count) {
+                             engine.on_order(order);
+                             engine.on_trade(trade);
+                             { view.bid_depth(levels, count) } -> std::same_as<int32_t>;
+                             { view.ask_depth(levels, count) } -> std::same_as<int32_t>;
+                             { view.bbo() } -> std::same_as<Bbo>;
+                             { view.size() } -> std::convertible_to<size_t>;
+                         };
+
+    /*!
+     * @brief 把逐笔事件应用到引擎
+    */
+    template<BookEngine Engine>
+    void apply_event(Engine &engine, const type::data::Event &event)
+    {
+        if (event.type == type::data::EventType::ORDER) {
+            engine.on_order(event.order);
+        } else {
+            engine.on_trade(event.trade);
+        }
+    }
+}
+
+#endif //ORDERBOOK_ENGINE_H
@@ -0,0 +1,123 @@
+//
+// Created by x2h1z on 2021/12/13.
+//
+
+#ifndef ORDERBOOK_LEVEL_BOOK_H
+#define ORDERBOOK_LEVEL_BOOK_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "book/engine.h"
+#include "book/symbol.h"
+#include "containers/fast_hash.h"
+#include "types.h"
+
+namespace x2h::book
+{
+    /*!
+     * @brief 按价位组织的盘口引擎
+     *
+     * 对逐笔消息的处理规则与 OrderBook 相同(撤单, 成交删减, 迟到订单), 区别在于:
+     * 挂单存放在节点池中, 按价位串成链表并维护档位合计, 按序号索引, 撤单与成交不需要遍历整个队列;
+     * 深度查询只读前几档; 不做 OrderBook::match_order 中只写撮合快照的计算.
+     * 不支持快照校正, 压缩与存档.
+    */
+    class LevelBook
+    {
+    public:
+        explicit LevelBook(const Symbol &symbol);
+
+        const Symbol &symbol() const noexcept
+        { return symbol_; }
+
+        int64_t last_msg_time() const noexcept
+        { return last_msg_time_; }
+
+        size_t size() const noexcept
+        { return size_; }
+
+        void on_order(const type::data::Order &order);
+
+        void on_trade(const type::data::Trade &trade);
+
+        int32_t bid_depth(type::data::PriceLevel *levels, int32_t count) const noexcept;
+
+        int32_t ask_depth(type::data::PriceLevel *levels, int32_t count) const noexcept;
+
+        Bbo bbo() const noexcept;
+
+    private:
+        static constexpr int32_t NIL = -1;
+
+        struct Node
+        {
+            /* 上证 origin_order_id, 深证 order_id */
+            int64_t id;
+            int64_t qty;
+            int64_t time_ns;
+            int64_t business_no;
+            double price;
+            /* 同价位链表 */
+            int32_t prev;
+            int32_t next;
+            /* 相同序号的下一个节点 */
+            int32_t same_id;
+            bool buy;
+        };
+
+        struct Level
+        {
+            int64_t qty{0};
+            int32_t head{NIL};
+            int32_t tail{NIL};
+        };
+
+        using BidLevels = std::map<double, Level, std::greater<>>;
+        using AskLevels = std::map<double, Level, std::less<>>;
+
+        void add(const type::data::Order &order, int64_t id);
+
+        template<typename Levels>
+        void insert(Levels &levels, int32_t index);
+
+        template<typename Levels>
+        void remove(Levels &levels, typename Levels::iterator level, int32_t index);
+
+        /*!
+         * @brief 删除一侧所有序号为 id 的挂单
+        */
+        void remove_id(bool buy, int64_t id);
+
+        /*!
+         * @brief 成交: 序号匹配的挂单扣减数量, 价格不劣于成交价且时间更早的其余挂单删除
+         * @param through 价位是否需要删除, 上证含成交价, 深证不含
+        */
+        template<typename Levels, typename Through>
+        void on_traded(Levels &levels, bool buy, const type::data::Trade &trade, int64_t id, Through through);
+
+        bool trade_supped(type::data::Order &order);
+
+        void on_cancel(const type::data::Trade &trade);
+
+        Symbol symbol_;
+        int64_t last_order_id_{0};
+        int64_t last_msg_time_{0};
+        size_t size_{0};
+
+        BidLevels bids_;
+        AskLevels asks_;
+
+        std::vector<Node> nodes_;
+        int32_t free_{NIL};
+        /* 序号 -> 相同序号链表的第一个节点 */
+        std::unordered_map<int64_t, int32_t, FastHash> index_;
+
+        std::unordered_map<int64_t, int64_t, FastHash> late_orders_;
+    };
+}
+
+#endif //ORDERBOOK_LEVEL_BOOK_H
@@ -5,22 +5,52 @@
 
 #include <list>
 #include <limits>
+#include <memory>
 #include <cstring>
+#include <cstdio>
 #include <ctime>
+#include "book/digest.h"
+#include "book/engine.h"
 #include "containers/fast_hash.h"
 #include "types.h"
 #include "symbol.h"
 
 namespace x2h::book
 {
+    /*!
+     * @brief OrderBook 的内存占用, 字节数按 libstdc++ 的容器节点布局估算
+    */
+    struct BookMemory
+    {
+        size_t orders{0};
+        /* 快照档位余量与撮合用的档位快照 */
+        size_t levels{0};
+        size_t late_orders{0};
+        size_t bytes{0};
+
+        BookMemory &operator+=(const BookMemory &other) noexcept
+        {
+            orders += other.orders;
+            levels += other.levels;
+            late_orders += other.late_orders;
+            bytes += other.bytes;
+            return *this;
+        }
+    };
+
     class OrderBook
     {
     private:
         using OrderQueue = std::list<type::data::Order>;
 
+        /* 紧凑表示, 见 compact() */
+        struct Compact;
+
         Symbol symbol_;
         int64_t last_order_id_{};
         int64_t last_msg_time_{};
+        /* 最近一条消息的当日纳秒数, 用于判断是否空闲 */
+        int64_t last_time_ns_{};
 
         /* 最优买卖 Order */
         type::data::Order best_bid_{};
@@ -34,8 +64,18 @@ namespace x2h::book
         std::map<double, int64_t, std::greater<>> bid_book_snapshot_;
         std::map<double, int64_t> ask_book_snapshot_;
 
+        /* 快照重建的档位余量: 快照中尚未对应到逐笔 Order 的数量, 消耗完后回到逐笔状态 */
+        std::map<double, int64_t, std::greater<>> bid_levels_;
+        std::map<double, int64_t> ask_levels_;
+
+        /* 非空时挂单与迟到订单表保存在这里, 上面的链表与哈希表为空 */
+        std::unique_ptr<Compact> compact_;
+
+        /* 全部挂单 order_digest 之和, 随每次增删改增量维护 */
+        uint64_t digest_{0};
+
     public:
-        OrderBook() = default;
+        OrderBook();
 
         explicit OrderBook(const Symbol &symbol);
 
@@ -48,14 +88,27 @@ namespace x2h::book
         { return !empty(); }
 
         bool empty() const noexcept
-        { return size() == 0; }
+        { return size() == 0 && !hybrid(); }
 
         size_t size() const noexcept
-        { return bids_.size() + asks_.size(); }
+        { return bid_size() + ask_size(); }
+
+        size_t bid_size() const noexcept;
+
+        size_t ask_size() const noexcept;
+
+        /*!
+         * @brief 是否处于快照档位与逐笔 Order 并存的混合状态
+        */
+        bool hybrid() const noexcept
+        { return !bid_levels_.empty() || !ask_levels_.empty(); }
 
         int64_t last_msg_time() const noexcept
         { return last_msg_time_; }
 
+        int64_t last_time_ns() const noexcept
+        { return last_time_ns_; }
+
         const Symbol &symbol() const noexcept
         { return symbol_; }
 
@@ -74,14 +127,14 @@ namespace x2h::book
         { return best_ask_; }
 
         /*!
-         * @brief 获取买队列
+         * @brief 获取买队列, 压缩状态下为空
          * @return
         */
         const OrderQueue &get_bid_queue() const noexcept
         { return bids_; }
 
         /*!
-         * @brief 获取卖队列
+         * @brief 获取卖队列, 压缩状态下为空
          * @return
         */
         const OrderQueue &get_ask_queue() const noexcept
@@ -91,6 +144,11 @@ namespace x2h::book
 
         void on_trade(const type::data::Trade &order);
 
+        /*!
+         * @brief 直接挂入 Order, 不撮合也不检查迟到成交, 用于从已知状态批量重建盘口
+        */
+        void restore_order(const type::data::Order &order);
+
 
         const std::map<double, int64_t> &get_ask_book_snapshot() const noexcept
         {
@@ -102,27 +160,24 @@ namespace x2h::book
             return bid_book_snapshot_;
         }
 
-        std::map<double, int64_t> get_ask_book() const noexcept
-        {
-            std::map<double, int64_t> ask{};
-
-            for (const auto &item: asks_) {
-                ask[item.price] += item.qty;
-            }
+        std::map<double, int64_t> get_ask_book() const noexcept;
 
-            return ask;
-        }
+        std::map<double, int64_t, std::greater<>> get_bid_book() const noexcept;
 
-        std::map<double, int64_t, std::greater<>> get_bid_book() const noexcept
-        {
-            std::map<double, int64_t, std::greater<>> bid{};
+        /*!
+         * @brief 买方前 count 档, 返回实际档数. 按挂单逐笔合并, 不构造完整盘口, 不分配内存
+        */
+        int32_t bid_depth(type::data::PriceLevel *levels, int32_t count) const;
 
-            for (const auto &item: bids_) {
-                bid[item.price] += item.qty;
-            }
+        /*!
+         * @brief 卖方前 count 档, 返回实际档数. 按挂单逐笔合并, 不构造完整盘口, 不分配内存
+        */
+        int32_t ask_depth(type::data::PriceLevel *levels, int32_t count) const;
 
-            return bid;
-        }
+        /*!
+         * @brief 按价位合计的买一卖一; 与 best_bid/best_ask 不同, 已成交或撤单的 Order 不会留在这里
+        */
+        Bbo bbo() const;
 
         // std::string print_order_book(int count_limit) const;
         void match_order(const type::data::Order &order) noexcept;
@@ -131,7 +186,57 @@ namespace x2h::book
 
         void match_ask_book();
 
+        /*!
+         * @brief 以十档快照校正盘口, 进入混合状态
+         *
+         * 快照覆盖的价位区间内, 多出的 Order 按时间从早到晚扣减, 不足的数量记为档位余量;
+         * 之后快照之前的挂单被成交或撤单时从余量中扣减.
+         * @param bids 买档, 价格从高到低
+         * @param asks 卖档, 价格从低到高
+        */
+        void resync(const type::data::PriceLevel *bids, int32_t bid_count,
+                    const type::data::PriceLevel *asks, int32_t ask_count);
+
+        /*!
+         * @brief 以二进制形式保存全部状态(挂单, 迟到订单表, 最新序号)
+        */
+        bool save(std::FILE *file) const;
+
+        /*!
+         * @brief 从 save 的输出恢复状态
+        */
+        bool load(std::FILE *file);
+
+        bool compacted() const noexcept
+        { return compact_ != nullptr; }
+
+        /*!
+         * @brief 转为紧凑表示: 挂单按到达顺序存入数组, 迟到订单表按 order_id 排序存入数组,
+         * 释放链表/哈希表节点与撮合用的档位快照. 读取接口照常可用, 收到新消息时自动 expand
+        */
+        void compact();
+
+        /*!
+         * @brief 从紧凑表示恢复
+        */
+        void expand();
+
+        BookMemory memory() const noexcept;
+
+        /*!
+         * @brief 挂单集合 (side, price, qty, id) 的摘要, 与挂单顺序无关; 不含快照档位余量
+        */
+        uint64_t digest() const noexcept
+        { return digest_; }
+
     private:
+        static uint64_t hash_order(bool buy, const type::data::Order &order) noexcept;
+
+        /*!
+         * @brief 重新计算 digest_, 用于快照校正与载入这类批量改动
+        */
+        void rehash() noexcept;
+
         bool trade_supped(type::data::Order &order);
 
         void on_cancel(const type::data::Trade &trade);
@@ -139,5 +244,10 @@ namespace x2h::book
         void on_traded(const type::data::Trade &trade);
 
         void add_order(type::data::Order &order) noexcept;
+
+        /*!
+         * @brief 快照之前的挂单被成交或撤单, 从档位余量中扣减
+        */
+        void consume_level(bool buy, double price, int64_t qty) noexcept;
     };
 }
\ No newline at end of file
@@ -0,0 +1,38 @@
+//
+// Created by x2h1z on 2021/12/7.
+//
+
+#ifndef ORDERBOOK_QUOTE_H
+#define ORDERBOOK_QUOTE_H
+
+#include <cmath>
+#include <cstdint>
+
+#include "types.h"
+
+namespace x2h::book
+{
+    /* 交易所十档快照的档位数 */
+    inline constexpr int QUOTE_LEVELS = 10;
+
+    /*!
+     * @brief 拷贝快照一侧的档位, 不足十档时以空档补齐, 遇到空档即停止
+     * @param levels SSEL2_Quotation / SZSEL2_Quotation 的 BuyLevel 或 SellLevel
+     * @param count BuyLevelNo 或 SellLevelNo
+     * @return 有效档位数
+    */
+    template<typename Level>
+    int32_t quote_levels(const Level *levels, unsigned count, type::data::PriceLevel *out,
+                         int limit = QUOTE_LEVELS) noexcept
+    {
+        int32_t n = 0;
+        for (unsigned i = 0; i < count && n < limit; ++i) {
+            if (levels[i].Price <= 0) break;
+            //! 深证的量为 double
+            out[n++] = {levels[i].Price, static_cast<int64_t>(std::llround(levels[i].Volume))};
+        }
+        return n;
+    }
+}
+
+#endif //ORDERBOOK_QUOTE_H
@@ -0,0 +1,95 @@
+//
+// Created by x2h1z on 2021/12/7.
+//
+
+#ifndef ORDERBOOK_RESYNC_H
+#define ORDERBOOK_RESYNC_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "book/book_set.h"
+#include "containers/fast_hash.h"
+#include "mdt/MDTStruct.h"
+#include "types.h"
+
+namespace x2h::book
+{
+    /*!
+     * @brief 以交易所十档快照快速建立或恢复 OrderBook
+     *
+     * 中途启动时尚未校正过的股票, 以及逐笔序号出现缺口的频道上的股票, 在收到下一个快照时
+     * 以快照档位校正并进入混合状态. 混合状态下每个快照都继续校正, 直到快照之前的挂单消耗完,
+     * 恢复时间为一个快照间隔而不是从开盘重放.
+    */
+    class Resync
+    {
+    public:
+        /*!
+         * @param late_start 是否中途启动, 为真时所有股票在首个快照之前都视为不完整
+        */
+        explicit Resync(BookSet &books, bool late_start = false);
+
+        /*!
+         * @brief 是否按频道序号检测缺口, 默认开启
+        */
+        void set_gap_detection(bool enabled) noexcept
+        { gap_detection_ = enabled; }
+
+        /*!
+         * @brief 检查频道序号并把逐笔事件应用到对应的 OrderBook
+        */
+        OrderBook *apply(const type::data::Event &event);
+
+        /*!
+         * @brief 收到十档快照, 需要时校正对应的 OrderBook
+         * @return 是否进行了校正
+        */
+        bool on_snapshot(const SSEL2_Quotation &quote);
+
+        bool on_snapshot(const SZSEL2_Quotation &quote);
+
+        /*!
+         * @brief 标记在下一个快照时校正
+        */
+        void invalidate(uint64_t key)
+        { stale_.insert(key); }
+
+        uint64_t gaps() const noexcept
+        { return gaps_; }
+
+        uint64_t resyncs() const noexcept
+        { return resyncs_; }
+
+        /* 等待快照校正的股票数 */
+        size_t pending() const noexcept
+        { return stale_.size(); }
+
+        void report() const;
+
+    private:
+        template<typename Quotation>
+        bool resync(const Quotation &quote, type::data::Exchange exchange, int64_t time_ns);
+
+        void check_sequence(uint64_t key, type::data::Exchange exchange, int32_t channel_no, int64_t seq);
+
+        BookSet &books_;
+        bool late_start_;
+        bool gap_detection_{true};
+
+        /* 已由快照校正过的股票 */
+        std::unordered_set<uint64_t, FastHash> seeded_;
+        /* 等待快照校正的股票 */
+        std::unordered_set<uint64_t, FastHash> stale_;
+        /* 股票 -> 所在频道 */
+        std::unordered_map<uint64_t, uint64_t, FastHash> channels_;
+        /* 频道 -> 最新序号 */
+        std::unordered_map<uint64_t, int64_t, FastHash> sequences_;
+
+        uint64_t gaps_{0};
+        uint64_t resyncs_{0};
+    };
+}
+
+#endif //ORDERBOOK_RESYNC_H
@@ -0,0 +1,150 @@
+//
+// Created by x2h1z on 2021/12/6.
+//
+
+#ifndef ORDERBOOK_VERIFIER_H
+#define ORDERBOOK_VERIFIER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <unordered_map>
+
+#include "book/order_book.h"
+#include "book/quote.h"
+#include "containers/fast_hash.h"
+#include "containers/spsc_queue.h"
+#include "pipeline/wait_strategy.h"
+#include "types.h"
+
+namespace x2h::book
+{
+    inline constexpr int VERIFY_LEVELS = QUOTE_LEVELS;
+
+    /*!
+     * @brief OrderBook 线程 -> 校验线程: 同一时刻的重建盘口与交易所快照
+    */
+    struct VerifySample
+    {
+        char ticker[20];
+        /* 快照时间, 交易所原始格式(上证 HHMMSSmmm, 深证 YYYYMMDDHHMMSSmmm) */
+        int64_t time;
+        /* OrderBook 最后一条逐笔的时间 */
+        int64_t book_time;
+        int32_t book_count[2];
+        int32_t quote_count[2];
+        /* [0] 买 [1] 卖 */
+        type::data::PriceLevel book[2][VERIFY_LEVELS];
+        type::data::PriceLevel quote[2][VERIFY_LEVELS];
+    };
+
+    /*!
+     * @brief 单个股票的校验统计
+    */
+    struct VerifyStats
+    {
+        uint64_t checks{0};
+        uint64_t mismatches{0};
+        /* 首次/最近一次不一致的快照时间, 0 表示未出现 */
+        int64_t first_divergence{0};
+        int64_t last_divergence{0};
+        /* 各档位出错次数, [0] 买 [1] 卖 */
+        std::array<std::array<uint64_t, VERIFY_LEVELS>, 2> level_errors{};
+        /* 每次不一致时最浅的出错档位 */
+        std::array<uint64_t, VERIFY_LEVELS> first_level{};
+        /* 每次校验的出错档位数(两侧合计) */
+        std::array<uint64_t, VERIFY_LEVELS * 2 + 1> error_count{};
+    };
+
+    /*!
+     * @brief 以交易所十档快照校验重建的 OrderBook
+     *
+     * OrderBook 线程只把前十档与快照拷贝进队列, 比对与统计在独立线程完成;
+     * 队列满时丢弃样本并计数, 不阻塞 OrderBook 线程.
+    */
+    class Verifier
+    {
+    public:
+        using StatsMap = std::unordered_map<uint64_t, VerifyStats, FastHash>;
+
+        /*!
+         * @param capacity 样本队列容量
+         * @param tolerance 价格比较的容差
+        */
+        explicit Verifier(size_t capacity = 1 << 12, double tolerance = 1e-6,
+                          pipeline::WaitStrategy strategy = pipeline::WaitStrategy::BLOCKING);
+
+        ~Verifier();
+
+        Verifier(const Verifier &) = delete;
+
+        Verifier &operator=(const Verifier &) = delete;
+
+        /*!
+         * @brief 提交一次校验, 在 OrderBook 线程调用
+         * @param quote SSEL2_Quotation 或 SZSEL2_Quotation
+         * @return 队列满被丢弃时返回 false
+        */
+        template<typename Quotation>
+        bool submit(const OrderBook &book, const Quotation &quote);
+
+        /*!
+         * @brief 排空队列并停止校验线程, 之后才能读取 stats()
+        */
+        void stop();
+
+        const StatsMap &stats() const noexcept
+        { return stats_; }
+
+        uint64_t dropped() const noexcept
+        { return dropped_; }
+
+        /*!
+         * @brief 输出汇总与不一致最多的 top 个股票
+        */
+        void report(size_t top = 20) const;
+
+    private:
+        void run();
+
+        void compare(const VerifySample &sample);
+
+        static void copy_book(const OrderBook &book, VerifySample &sample);
+
+        double tolerance_;
+        SpscQueue<VerifySample> queue_;
+        pipeline::Waiter waiter_;
+        std::thread thread_;
+        uint64_t dropped_{0};
+        bool stopped_{false};
+
+        StatsMap stats_;
+    };
+
+    template<typename Quotation>
+    bool Verifier::submit(const OrderBook &book, const Quotation &quote)
+    {
+        auto *sample = queue_.alloc();
+        if (sample == nullptr) {
+            ++dropped_;
+            return false;
+        }
+
+        std::strncpy(sample->ticker, quote.Symbol, sizeof(sample->ticker) - 1);
+        sample->ticker[sizeof(sample->ticker) - 1] = '\0';
+        sample->time = static_cast<int64_t>(quote.Time);
+        sample->book_time = book.last_msg_time();
+
+        sample->quote_count[0] = quote_levels(quote.BuyLevel, quote.BuyLevelNo, sample->quote[0], VERIFY_LEVELS);
+        sample->quote_count[1] = quote_levels(quote.SellLevel, quote.SellLevelNo, sample->quote[1], VERIFY_LEVELS);
+        copy_book(book, *sample);
+
+        queue_.publish();
+        waiter_.notify();
+        return true;
+    }
+}
+
+#endif //ORDERBOOK_VERIFIER_H
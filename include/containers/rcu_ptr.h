@@ -0,0 +1,77 @@
+//
+// Created by x2h1z on 2021/12/5.
+//
+
+#ifndef ORDERBOOK_RCU_PTR_H
+#define ORDERBOOK_RCU_PTR_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/*!
+ * @brief 读多写少的指针, 基于静默状态(QSBR)延迟回收
+ *
+ * 读线程先 attach 取得槽位, 在两次访问之间调用 read 取得最新指针并宣告静默,
+ * 读路径只有两次 acquire 读和一次 release 写, 不加锁. 写线程替换指针后把旧对象挂入待回收列表,
+ * 待所有在线读线程都越过替换时的纪元后才释放, 写线程不会因读线程阻塞而等待.
+*/
+template<typename T>
+class RcuPtr
+{
+public:
+    static constexpr int MAX_READERS = 16;
+
+    explicit RcuPtr(std::unique_ptr<T> value);
+
+    ~RcuPtr();
+
+    RcuPtr(const RcuPtr &) = delete;
+
+    RcuPtr &operator=(const RcuPtr &) = delete;
+
+    //! 读线程: 注册槽位, 槽位用尽时返回 -1
+    int attach() noexcept;
+
+    //! 读线程: 注销槽位, 之后不得再使用 read 返回的指针
+    void detach(int slot) noexcept;
+
+    //! 读线程: 宣告之前取得的指针已不再使用, 并返回当前指针
+    const T *read(int slot) noexcept;
+
+    //! 写线程: 替换指针, 旧对象延迟回收
+    void publish(std::unique_ptr<T> value);
+
+    //! 写线程: 回收所有读线程都已越过的旧对象
+    size_t reclaim();
+
+    //! 待回收的旧对象数
+    size_t retired() const;
+
+private:
+    static constexpr uint64_t OFFLINE = ~uint64_t{0};
+
+    struct alignas(64) Slot
+    {
+        std::atomic<uint64_t> epoch{OFFLINE};
+        std::atomic<bool> used{false};
+    };
+
+    struct Retired
+    {
+        T *value;
+        uint64_t epoch;
+    };
+
+    std::atomic<T *> value_;
+    alignas(64) std::atomic<uint64_t> epoch_{1};
+    Slot slots_[MAX_READERS];
+
+    mutable std::mutex mutex_;
+    std::vector<Retired> retired_;
+};
+
+#include "rcu_ptr.inl"
+#endif //ORDERBOOK_RCU_PTR_H
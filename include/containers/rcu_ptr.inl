@@ -0,0 +1,78 @@
+#include <algorithm>
+#include "rcu_ptr.h"
+
+template<typename T>
+RcuPtr<T>::RcuPtr(std::unique_ptr<T> value)
+        : value_(value.release())
+{}
+
+template<typename T>
+RcuPtr<T>::~RcuPtr()
+{
+    delete value_.load(std::memory_order_relaxed);
+    for (auto &retired: retired_) delete retired.value;
+}
+
+template<typename T>
+inline int RcuPtr<T>::attach() noexcept
+{
+    for (int i = 0; i < MAX_READERS; ++i) {
+        bool expected = false;
+        if (slots_[i].used.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+            slots_[i].epoch.store(epoch_.load(std::memory_order_acquire), std::memory_order_release);
+            return i;
+        }
+    }
+    return -1;
+}
+
+template<typename T>
+inline void RcuPtr<T>::detach(int slot) noexcept
+{
+    slots_[slot].epoch.store(OFFLINE, std::memory_order_release);
+    slots_[slot].used.store(false, std::memory_order_release);
+}
+
+template<typename T>
+inline const T *RcuPtr<T>::read(int slot) noexcept
+{
+    //! 先读纪元再读指针: 纪元不小于 E 时, 纪元 E 之前发布的指针一定可见
+    uint64_t epoch = epoch_.load(std::memory_order_acquire);
+    T *value = value_.load(std::memory_order_acquire);
+    slots_[slot].epoch.store(epoch, std::memory_order_release);
+    return value;
+}
+
+template<typename T>
+void RcuPtr<T>::publish(std::unique_ptr<T> value)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    T *old = value_.exchange(value.release(), std::memory_order_acq_rel);
+    uint64_t epoch = epoch_.fetch_add(1, std::memory_order_acq_rel) + 1;
+    retired_.push_back({old, epoch});
+}
+
+template<typename T>
+size_t RcuPtr<T>::reclaim()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    uint64_t min_epoch = OFFLINE;
+    for (auto &slot: slots_) {
+        min_epoch = std::min(min_epoch, slot.epoch.load(std::memory_order_acquire));
+    }
+
+    auto it = std::partition(retired_.begin(), retired_.end(),
+                             [&](const Retired &r) { return r.epoch > min_epoch; });
+    size_t freed = retired_.end() - it;
+    for (auto p = it; p != retired_.end(); ++p) delete p->value;
+    retired_.erase(it, retired_.end());
+    return freed;
+}
+
+template<typename T>
+size_t RcuPtr<T>::retired() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return retired_.size();
+}
@@ -0,0 +1,51 @@
+//
+// Created by x2h1z on 2021/12/15.
+//
+
+#ifndef ORDERBOOK_ROLLING_WINDOW_H
+#define ORDERBOOK_ROLLING_WINDOW_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*!
+ * @brief 按时间分桶的滚动窗口合计
+ *
+ * 窗口分为 buckets 个等宽的桶组成的环, 新值计入当前桶与合计, 时间推进时移出过期桶并从合计中扣除;
+ * 每个事件 O(1)(均摊), 窗口的实际覆盖范围在 (buckets - 1) / buckets 到 1 个窗口长度之间.
+ * T 需要支持 += 与 -=, 值初始化为零.
+*/
+template<typename T>
+class RollingWindow
+{
+public:
+    RollingWindow(int64_t window_ns, size_t buckets);
+
+    /*!
+     * @brief 推进到 now_ns; 时间倒退时不移动, 值计入当前桶
+    */
+    void advance(int64_t now_ns) noexcept;
+
+    /*!
+     * @brief 计入当前桶
+    */
+    void add(const T &value) noexcept;
+
+    const T &total() const noexcept
+    { return total_; }
+
+    int64_t window_ns() const noexcept
+    { return width_ns_ * static_cast<int64_t>(buckets_.size()); }
+
+private:
+    std::vector<T> buckets_;
+    int64_t width_ns_;
+    /* 当前桶的序号(now_ns / width_ns_), -1 表示尚未开始 */
+    int64_t head_{-1};
+    size_t pos_{0};
+    T total_{};
+};
+
+#include "rolling_window.inl"
+#endif //ORDERBOOK_ROLLING_WINDOW_H
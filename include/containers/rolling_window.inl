@@ -0,0 +1,36 @@
+#include <algorithm>
+#include "rolling_window.h"
+
+template<typename T>
+RollingWindow<T>::RollingWindow(int64_t window_ns, size_t buckets)
+        : buckets_(std::max<size_t>(buckets, 1)),
+          width_ns_(std::max<int64_t>(window_ns / static_cast<int64_t>(buckets_.size()), 1))
+{}
+
+template<typename T>
+inline void RollingWindow<T>::advance(int64_t now_ns) noexcept
+{
+    int64_t head = now_ns / width_ns_;
+    if (head <= head_) return;
+
+    auto steps = static_cast<uint64_t>(head - head_);
+    if (head_ < 0 || steps >= buckets_.size()) {
+        //! 整个窗口都已过期, 直接清零, 也避免浮点合计的累积误差
+        std::fill(buckets_.begin(), buckets_.end(), T{});
+        total_ = T{};
+    } else {
+        for (uint64_t i = 0; i < steps; ++i) {
+            pos_ = pos_ + 1 == buckets_.size() ? 0 : pos_ + 1;
+            total_ -= buckets_[pos_];
+            buckets_[pos_] = T{};
+        }
+    }
+    head_ = head;
+}
+
+template<typename T>
+inline void RollingWindow<T>::add(const T &value) noexcept
+{
+    buckets_[pos_] += value;
+    total_ += value;
+}
@@ -0,0 +1,73 @@
+//
+// Created by x2h1z on 2021/11/18.
+//
+
+#ifndef ORDERBOOK_SPSC_QUEUE_H
+#define ORDERBOOK_SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+/*!
+ * @brief 有界单生产者单消费者无锁队列
+ *
+ * 生产者通过 alloc/publish 原地写入, 消费者通过 front/pop 原地读取, 避免额外拷贝
+*/
+template<typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(size_t capacity);
+
+    ~SpscQueue() = default;
+
+    SpscQueue(const SpscQueue &) = delete;
+
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    //! 生产者: 取得下一个可写槽位, 队列满时返回 nullptr
+    T *alloc() noexcept;
+
+    //! 生产者: 提交 alloc 得到的槽位
+    void publish() noexcept;
+
+    bool try_push(const T &value) noexcept;
+
+    //! 消费者: 队首元素, 队列空时返回 nullptr
+    T *front() noexcept;
+
+    //! 消费者: 弹出 front 得到的元素
+    void pop() noexcept;
+
+    bool empty() const noexcept;
+
+    size_t size() const noexcept;
+
+    size_t capacity() const noexcept
+    { return capacity_; }
+
+    //! 生产者: 标记不再写入
+    void close() noexcept
+    { closed_.store(true, std::memory_order_release); }
+
+    //! 消费者: 生产者已关闭且队列已空
+    bool drained() const noexcept
+    { return closed_.load(std::memory_order_acquire) && empty(); }
+
+private:
+    size_t capacity_;
+    size_t mask_;
+    std::unique_ptr<T[]> slots_;
+
+    alignas(64) std::atomic<size_t> head_{0};
+    size_t tail_cache_{0};
+
+    alignas(64) std::atomic<size_t> tail_{0};
+    size_t head_cache_{0};
+
+    alignas(64) std::atomic<bool> closed_{false};
+};
+
+#include "spsc_queue.inl"
+#endif //ORDERBOOK_SPSC_QUEUE_H
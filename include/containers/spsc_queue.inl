@@ -0,0 +1,65 @@
+#include <bit>
+#include "spsc_queue.h"
+
+template<typename T>
+SpscQueue<T>::SpscQueue(size_t capacity)
+        : capacity_(std::bit_ceil(capacity < 2 ? size_t{2} : capacity)),
+          mask_(capacity_ - 1),
+          slots_(std::make_unique<T[]>(capacity_))
+{}
+
+template<typename T>
+inline T *SpscQueue<T>::alloc() noexcept
+{
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_cache_ >= capacity_) {
+        tail_cache_ = tail_.load(std::memory_order_acquire);
+        if (head - tail_cache_ >= capacity_) return nullptr;
+    }
+    return &slots_[head & mask_];
+}
+
+template<typename T>
+inline void SpscQueue<T>::publish() noexcept
+{
+    head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+template<typename T>
+inline bool SpscQueue<T>::try_push(const T &value) noexcept
+{
+    T *slot = alloc();
+    if (slot == nullptr) return false;
+    *slot = value;
+    publish();
+    return true;
+}
+
+template<typename T>
+inline T *SpscQueue<T>::front() noexcept
+{
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_cache_) {
+        head_cache_ = head_.load(std::memory_order_acquire);
+        if (tail == head_cache_) return nullptr;
+    }
+    return &slots_[tail & mask_];
+}
+
+template<typename T>
+inline void SpscQueue<T>::pop() noexcept
+{
+    tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+template<typename T>
+inline bool SpscQueue<T>::empty() const noexcept
+{
+    return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+}
+
+template<typename T>
+inline size_t SpscQueue<T>::size() const noexcept
+{
+    return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+}
@@ -0,0 +1,35 @@
+//
+// Created by x2h1z on 2021/11/16.
+//
+
+#ifndef ORDERBOOK_DECODE_H
+#define ORDERBOOK_DECODE_H
+
+#include "dat/dispatch.h"
+#include "mdt/MDTStruct.h"
+#include "timestamp.h"
+#include "types.h"
+
+namespace x2h::dat
+{
+    /*!
+     * @brief MDT 逐笔结构体解码为 Order/Trade, 时间在此统一归一化为当日纳秒数
+     * @param dst 需预先清零
+    */
+    void decode(const SSEL2_Order &src, type::data::Order &dst) noexcept;
+
+    void decode(const SSEL2_Transaction &src, type::data::Trade &dst) noexcept;
+
+    void decode(const SZSEL2_Order &src, type::data::Order &dst) noexcept;
+
+    void decode(const SZSEL2_Transaction &src, type::data::Trade &dst) noexcept;
+
+    /*!
+     * @brief 按消息类型解码逐笔委托/成交
+     * @return 非逐笔消息返回 false
+    */
+    bool decode(MsgType msg_type, const void *data, type::data::Event &event) noexcept;
+}
+
+#include "decode.inl"
+#endif //ORDERBOOK_DECODE_H
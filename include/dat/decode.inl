@@ -0,0 +1,130 @@
+#include <cstring>
+#include "decode.h"
+
+namespace x2h::dat
+{
+    namespace detail
+    {
+        inline void copy_ticker(char (&dst)[20], const char *symbol) noexcept
+        {
+            //! strncpy 会补零, 保证 ticker 可直接用 FastHash::Parse
+            std::strncpy(dst, symbol, sizeof(dst) - 1);
+            dst[sizeof(dst) - 1] = '\0';
+        }
+    }
+
+    inline void decode(const SSEL2_Order &src, type::data::Order &dst) noexcept
+    {
+        detail::copy_ticker(dst.ticker, src.Symbol);
+        dst.rec_time = static_cast<int64_t>(src.MDTTime);
+        dst.time = src.Time;
+        dst.time_ns = util::hhmmssmmm_to_ns(src.Time);
+        dst.channel_no = src.SetID;
+        dst.order_id = src.RecID;
+        dst.origin_order_id = src.OrderID;
+        dst.price = src.OrderPrice;
+        dst.qty = static_cast<int64_t>(src.Balance);
+        dst.side = *src.OrderCode;
+        dst.ord_type = src.OrderType;
+        dst.business_no = src.RecNO;
+        dst.exchange = type::data::Exchange::SH;
+    }
+
+    inline void decode(const SSEL2_Transaction &src, type::data::Trade &dst) noexcept
+    {
+        detail::copy_ticker(dst.ticker, src.Symbol);
+        dst.rec_time = static_cast<int64_t>(src.MDTTime);
+        dst.time = src.TradeTime;
+        dst.time_ns = util::hhmmssmmm_to_ns(src.TradeTime);
+        dst.channel_id = src.TradeChannel;
+        dst.ask_id = src.SellRecID;
+        dst.bid_id = src.BuyRecID;
+        dst.memory = src.TradeAmount;
+        dst.price = src.TradePrice;
+        dst.qty = static_cast<int64_t>(src.TradeVolume);
+        dst.trade_flag = src.BuySellFlag;
+        dst.trade_id = src.RecID;
+        dst.business_no = src.RecNO;
+        dst.exchange = type::data::Exchange::SH;
+    }
+
+    inline void decode(const SZSEL2_Order &src, type::data::Order &dst) noexcept
+    {
+        detail::copy_ticker(dst.ticker, src.Symbol);
+        dst.rec_time = static_cast<int64_t>(src.MDTTime);
+        dst.time = src.Time;
+        dst.time_ns = util::yyyymmddhhmmssmmm_to_ns(src.Time);
+        dst.channel_no = static_cast<int32_t>(src.SetID);
+        dst.order_id = static_cast<int64_t>(src.RecID);
+        dst.origin_order_id = 0;
+        dst.price = src.OrderPrice;
+        dst.qty = static_cast<int64_t>(src.OrderVolume);
+        dst.side = src.OrderCode;
+        dst.ord_type = src.OrderType;
+        dst.business_no = static_cast<int64_t>(src.RecID);
+        dst.exchange = type::data::Exchange::SZ;
+    }
+
+    inline void decode(const SZSEL2_Transaction &src, type::data::Trade &dst) noexcept
+    {
+        detail::copy_ticker(dst.ticker, src.Symbol);
+        dst.rec_time = static_cast<int64_t>(src.MDTTime);
+        dst.time = src.TradeTime;
+        dst.time_ns = util::yyyymmddhhmmssmmm_to_ns(src.TradeTime);
+        dst.channel_id = static_cast<int32_t>(src.SetID);
+        dst.ask_id = static_cast<int64_t>(src.SellOrderID);
+        dst.bid_id = static_cast<int64_t>(src.BuyOrderID);
+        dst.memory = 0;
+        dst.price = src.TradePrice;
+        dst.qty = static_cast<int64_t>(src.TradeVolume);
+        dst.trade_flag = src.TradeType;
+        dst.trade_id = static_cast<int64_t>(src.RecID);
+        dst.business_no = static_cast<int64_t>(src.RecID);
+        dst.exchange = type::data::Exchange::SZ;
+    }
+
+    namespace detail
+    {
+        /*!
+         * @brief 逐笔委托/成交解码为 Event, 其余类型不登记
+        */
+        struct EventDecoder
+        {
+            type::data::Event &event;
+
+            void on(const SSEL2_Order &src) noexcept
+            {
+                event.type = type::data::EventType::ORDER;
+                event.order = {};
+                decode(src, event.order);
+            }
+
+            void on(const SSEL2_Transaction &src) noexcept
+            {
+                event.type = type::data::EventType::TRADE;
+                event.trade = {};
+                decode(src, event.trade);
+            }
+
+            void on(const SZSEL2_Order &src) noexcept
+            {
+                event.type = type::data::EventType::ORDER;
+                event.order = {};
+                decode(src, event.order);
+            }
+
+            void on(const SZSEL2_Transaction &src) noexcept
+            {
+                event.type = type::data::EventType::TRADE;
+                event.trade = {};
+                decode(src, event.trade);
+            }
+        };
+    }
+
+    inline bool decode(MsgType msg_type, const void *data, type::data::Event &event) noexcept
+    {
+        detail::EventDecoder decoder{event};
+        return dispatch(decoder, msg_type, data);
+    }
+}
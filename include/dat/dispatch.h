@@ -0,0 +1,197 @@
+//
+// Created by x2h1z on 2021/12/3.
+//
+
+#ifndef ORDERBOOK_DISPATCH_H
+#define ORDERBOOK_DISPATCH_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "mdt/MDTDataType.h"
+#include "mdt/MDTStruct.h"
+
+namespace x2h::dat
+{
+    /*!
+     * @brief MsgType 与 MDT 结构体的编译期映射
+    */
+    template<MsgType T>
+    struct MsgTraits;
+
+#define X2H_MSG_TRAITS(msg, type)               \
+    template<>                                  \
+    struct MsgTraits<msg>                       \
+    {                                           \
+        using Type = type;                      \
+    }
+
+    X2H_MSG_TRAITS(Msg_SSEL1_Static, SSEL1_Static);
+    X2H_MSG_TRAITS(Msg_SSEL1_Quotation, SSEL1_Quotation);
+    X2H_MSG_TRAITS(Msg_SSE_IndexPress, SSE_IndexPress);
+    X2H_MSG_TRAITS(Msg_SSEL2_Static, SSEL2_Static);
+    X2H_MSG_TRAITS(Msg_SSEL2_Quotation, SSEL2_Quotation);
+    X2H_MSG_TRAITS(Msg_SSEL2_Transaction, SSEL2_Transaction);
+    X2H_MSG_TRAITS(Msg_SSEL2_Index, SSEL2_Index);
+    X2H_MSG_TRAITS(Msg_SSEL2_Auction, SSEL2_Auction);
+    X2H_MSG_TRAITS(Msg_SSEL2_Overview, SSEL2_Overview);
+    X2H_MSG_TRAITS(Msg_SSEL2_Order, SSEL2_Order);
+    X2H_MSG_TRAITS(Msg_SSEIOL1_Static, SSEIOL1_Static);
+    X2H_MSG_TRAITS(Msg_SSEIOL1_Quotation, SSEIOL1_Quotation);
+    /* 深交所 L1 结构体在 MDTStruct.h 中未启用, 不登记 */
+    X2H_MSG_TRAITS(Msg_SZSEL2_Static, SZSEL2_Static);
+    X2H_MSG_TRAITS(Msg_SZSEL2_Quotation, SZSEL2_Quotation);
+    X2H_MSG_TRAITS(Msg_SZSEL2_Transaction, SZSEL2_Transaction);
+    X2H_MSG_TRAITS(Msg_SZSEL2_Index, SZSEL2_Index);
+    X2H_MSG_TRAITS(Msg_SZSEL2_Order, SZSEL2_Order);
+    X2H_MSG_TRAITS(Msg_SZSEL2_Status, SZSEL2_Status);
+
+#undef X2H_MSG_TRAITS
+
+    template<MsgType... Ts>
+    struct MsgList
+    {};
+
+    using AllMessages = MsgList<
+            Msg_SSEL1_Static, Msg_SSEL1_Quotation, Msg_SSE_IndexPress,
+            Msg_SSEL2_Static, Msg_SSEL2_Quotation, Msg_SSEL2_Transaction, Msg_SSEL2_Index,
+            Msg_SSEL2_Auction, Msg_SSEL2_Overview, Msg_SSEL2_Order,
+            Msg_SSEIOL1_Static, Msg_SSEIOL1_Quotation,
+            Msg_SZSEL2_Static, Msg_SZSEL2_Quotation, Msg_SZSEL2_Transaction, Msg_SZSEL2_Index,
+            Msg_SZSEL2_Order, Msg_SZSEL2_Status>;
+
+    /*!
+     * @brief MsgType 压缩为 8 位下标: 交易所(bit 20-21) | 级别(bit 12-13) | 序号(bit 0-3)
+    */
+    constexpr uint32_t msg_key(uint32_t type) noexcept
+    {
+        return ((type >> 20) & 0x3) << 6 | ((type >> 12) & 0x3) << 4 | (type & 0xF);
+    }
+
+    inline constexpr size_t MSG_KEYS = 256;
+
+    namespace detail
+    {
+        template<MsgType... Ts>
+        constexpr bool unique_keys(MsgList<Ts...>) noexcept
+        {
+            constexpr uint32_t keys[] = {msg_key(Ts)...};
+            for (size_t i = 0; i < sizeof...(Ts); ++i) {
+                for (size_t j = i + 1; j < sizeof...(Ts); ++j) {
+                    if (keys[i] == keys[j]) return false;
+                }
+            }
+            return true;
+        }
+    }
+
+    static_assert(detail::unique_keys(AllMessages{}), "MsgType 压缩下标冲突");
+
+    namespace detail
+    {
+        struct SymbolField
+        {
+            uint32_t type;
+            uint32_t offset;
+        };
+
+        template<MsgType... Ts>
+        constexpr std::array<SymbolField, MSG_KEYS> symbol_fields(MsgList<Ts...>) noexcept
+        {
+            std::array<SymbolField, MSG_KEYS> table{};
+            ((table[msg_key(Ts)] = {static_cast<uint32_t>(Ts),
+                                    static_cast<uint32_t>(offsetof(typename MsgTraits<Ts>::Type, Symbol))}), ...);
+            return table;
+        }
+
+        inline constexpr auto SYMBOL_FIELDS = symbol_fields(AllMessages{});
+    }
+
+    /*!
+     * @brief 结构体中 Symbol 字段的偏移, 未知类型返回 -1
+    */
+    constexpr int32_t symbol_offset(MsgType type) noexcept
+    {
+        const auto &field = detail::SYMBOL_FIELDS[msg_key(static_cast<uint32_t>(type))];
+        return field.type == static_cast<uint32_t>(type) && type != Msg_Unknown
+               ? static_cast<int32_t>(field.offset) : -1;
+    }
+
+    /*!
+     * @brief 处理器是否处理该消息: 实现了 on(const 结构体 &)
+    */
+    template<typename Handler, MsgType T>
+    concept Handles = requires(Handler &handler, const typename MsgTraits<T>::Type &msg) {
+        handler.on(msg);
+    };
+
+    /*!
+     * @brief 编译期生成的消息分发表
+     *
+     * 处理器只需实现关心的 on(const SSEL2_Order &) 等重载. 分发表只登记这些类型,
+     * 其余类型在转换结构体之前即被丢弃; 分发为一次查表加一次间接调用, 没有 switch.
+    */
+    template<typename Handler, typename List = AllMessages>
+    class Dispatcher
+    {
+    public:
+        using Fn = void (*)(Handler &, const void *);
+
+        struct Entry
+        {
+            /* 登记的类型, 用于排除压缩下标相同的未知类型 */
+            uint32_t type;
+            Fn fn;
+        };
+
+        /*!
+         * @return 消息是否被处理
+        */
+        static bool dispatch(Handler &handler, MsgType type, const void *data)
+        {
+            const auto &entry = TABLE[msg_key(static_cast<uint32_t>(type))];
+            if (entry.type != static_cast<uint32_t>(type) || entry.fn == nullptr) return false;
+            entry.fn(handler, data);
+            return true;
+        }
+
+        static constexpr bool handles(MsgType type) noexcept
+        {
+            const auto &entry = TABLE[msg_key(static_cast<uint32_t>(type))];
+            return entry.type == static_cast<uint32_t>(type) && entry.fn != nullptr;
+        }
+
+    private:
+        template<MsgType T>
+        static void invoke(Handler &handler, const void *data)
+        {
+            handler.on(*static_cast<const typename MsgTraits<T>::Type *>(data));
+        }
+
+        template<MsgType... Ts>
+        static constexpr std::array<Entry, MSG_KEYS> build(MsgList<Ts...>) noexcept
+        {
+            std::array<Entry, MSG_KEYS> table{};
+            (..., [&]() {
+                if constexpr (Handles<Handler, Ts>) {
+                    table[msg_key(Ts)] = {static_cast<uint32_t>(Ts), &invoke<Ts>};
+                }
+            }());
+            return table;
+        }
+
+        static constexpr std::array<Entry, MSG_KEYS> TABLE = build(List{});
+    };
+
+    /*!
+     * @brief 按消息类型分发给处理器
+    */
+    template<typename Handler>
+    inline bool dispatch(Handler &handler, MsgType type, const void *data)
+    {
+        return Dispatcher<Handler>::dispatch(handler, type, data);
+    }
+}
+
+#endif //ORDERBOOK_DISPATCH_H
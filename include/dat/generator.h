@@ -0,0 +1,168 @@
+//
+// Created by x2h1z on 2021/12/9.
+//
+
+#ifndef ORDERBOOK_GENERATOR_H
+#define ORDERBOOK_GENERATOR_H
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace x2h::dat
+{
+    /*!
+     * @brief 合成行情配置, 由 key = value 配置文件加载
+     *
+     *  gen.output           = /data/synthetic.dat
+     *  gen.seed             = 1
+     *  gen.date             = 20210903
+     *  gen.sh_symbols       = 1500
+     *  gen.sz_symbols       = 1500
+     *  gen.channels         = 6
+     *  gen.events           = 10000000
+     *  gen.rate             = 20000
+     *  gen.cancel_ratio     = 0.4
+     *  gen.aggressive_ratio = 0.2
+     *  gen.volatility       = 0.0005
+     *  gen.auction_burst    = 0.05
+     *  gen.out_of_order     = 0.01
+     *  gen.snapshot_ms      = 3000
+     *  gen.max_depth        = 2000
+     *  gen.skew             = 0.8
+    */
+    struct GeneratorConfig
+    {
+        std::string output;
+        /* 相同种子与配置生成逐字节相同的文件 */
+        uint64_t seed{1};
+        /* 交易日 YYYYMMDD */
+        int64_t date{20210903};
+
+        size_t sh_symbols{100};
+        size_t sz_symbols{100};
+        /* 每个交易所的频道数, 股票按序号分配到频道 */
+        int channels{4};
+
+        /* 逐笔委托/撤单总数上限, 0 表示生成到收盘 */
+        uint64_t events{1'000'000};
+        /* 连续竞价阶段全市场每秒的委托/撤单数 */
+        double rate{10'000};
+        /* 撤单数与新委托数之比 */
+        double cancel_ratio{0.4};
+        /* 新委托中可立即成交的比例 */
+        double aggressive_ratio{0.2};
+        /* 每笔委托前中间价对数收益率的标准差 */
+        double volatility{0.0005};
+        /* 开盘集合竞价阶段相对连续竞价的速率倍数, 0 表示跳过集合竞价 */
+        double auction_burst{0.02};
+        /* 主动委托与其成交的写出顺序被交换的比例 */
+        double out_of_order{0.01};
+        /* 十档快照间隔, 0 表示不生成快照 */
+        int64_t snapshot_ms{3'000};
+        /* 单个股票的挂单数上限, 超出后只撤不挂 */
+        size_t max_depth{2'000};
+        /* 股票活跃度服从 Zipf 分布的指数 */
+        double skew{0.8};
+
+        static GeneratorConfig load(const std::string &file_path);
+    };
+
+    struct GeneratorStats
+    {
+        uint64_t records{0};
+        uint64_t orders{0};
+        uint64_t cancels{0};
+        uint64_t trades{0};
+        uint64_t auction_trades{0};
+        uint64_t snapshots{0};
+        uint64_t out_of_order{0};
+    };
+
+    /*!
+     * @brief 生成 Header 封装的沪深 L2 逐笔委托/成交与十档快照
+     *
+     * 每个股票维护一个模型盘口, 撤单与成交总是指向真实存在的挂单, 序号按频道连续,
+     * 上证主动委托先写成交再写剩余委托, 深证先写委托再写成交, 与交易所的实际顺序一致.
+    */
+    class Generator
+    {
+    public:
+        explicit Generator(GeneratorConfig config);
+
+        ~Generator();
+
+        Generator(const Generator &) = delete;
+
+        Generator &operator=(const Generator &) = delete;
+
+        /*!
+         * @brief 生成到 file_path
+         * @return 是否成功写出
+        */
+        bool run(const std::string &file_path);
+
+        const GeneratorStats &stats() const noexcept
+        { return stats_; }
+
+    private:
+        struct Security;
+        struct Channel;
+        struct Record;
+
+        void create_securities();
+
+        size_t pick_security();
+
+        void on_event(Security &security, bool auction);
+
+        void add_order(Security &security, bool auction);
+
+        void cancel_order(Security &security);
+
+        void uncross(Security &security);
+
+        void snapshot(Security &security);
+
+        void emit_order(Security &security, int64_t id, bool buy, int64_t tick, int64_t qty, bool del);
+
+        void emit_trade(Security &security, int64_t bid_id, int64_t ask_id, int64_t tick, int64_t qty, char flag);
+
+        void push(int32_t type, const void *data, uint32_t len);
+
+        void flush_records();
+
+        void emit_snapshots(int64_t until_ns);
+
+        uint64_t mdt_time() noexcept;
+
+        GeneratorConfig config_;
+        GeneratorStats stats_;
+        std::mt19937_64 rng_;
+
+        std::vector<std::unique_ptr<Security>> securities_;
+        std::vector<Channel> channels_;
+        /* 按活跃度累计的权重, 用于抽样股票 */
+        std::vector<double> weights_;
+        /* 上次快照之后有变化的股票 */
+        std::vector<size_t> dirty_;
+
+        /* 当日纳秒时间 */
+        int64_t clock_ns_{0};
+        int64_t next_snapshot_ns_{0};
+        /* 当日零点的 unix 微秒时间 */
+        int64_t epoch_us_{0};
+        uint64_t last_mdt_{0};
+
+        /* 当前事件产生的记录, 写出前可能被重排 */
+        std::vector<Record> pending_;
+        std::vector<char> scratch_;
+        std::vector<char> buffer_;
+        std::FILE *file_{nullptr};
+    };
+}
+
+#endif //ORDERBOOK_GENERATOR_H
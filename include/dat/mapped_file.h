@@ -0,0 +1,69 @@
+//
+// Created by x2h1z on 2021/11/24.
+//
+
+#ifndef ORDERBOOK_MAPPED_FILE_H
+#define ORDERBOOK_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+/*!
+ * @brief 只读内存映射文件
+*/
+class MappedFile
+{
+public:
+    MappedFile() = default;
+
+    explicit MappedFile(const std::string &file_path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    MappedFile(MappedFile &&other) noexcept;
+
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    bool open(const std::string &file_path);
+
+    void close() noexcept;
+
+    /*!
+     * @brief 文件变长后重新映射. 增长未超出已映射范围时只更新 size
+     * @return 新的文件大小
+    */
+    size_t remap();
+
+    /*!
+     * @brief 映射时在文件末尾之后多预留的字节数, 用于追踪仍在写入的文件, 减少重新映射
+    */
+    void set_map_ahead(size_t bytes) noexcept
+    { map_ahead_ = bytes; }
+
+    bool is_open() const noexcept
+    { return fd_ >= 0; }
+
+    const char *data() const noexcept
+    { return data_; }
+
+    size_t size() const noexcept
+    { return size_; }
+
+    const std::string &path() const noexcept
+    { return path_; }
+
+private:
+    std::string path_;
+    int fd_{-1};
+    const char *data_{nullptr};
+    size_t size_{0};
+    /* 实际映射长度, 不小于 size_ */
+    size_t mapped_size_{0};
+    size_t map_ahead_{0};
+};
+
+#endif //ORDERBOOK_MAPPED_FILE_H
@@ -0,0 +1,56 @@
+//
+// Created by x2h1z on 2021/11/25.
+//
+
+#ifndef ORDERBOOK_MERGE_READER_H
+#define ORDERBOOK_MERGE_READER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "dat/mapped_file.h"
+#include "dat/reader.h"
+
+/*!
+ * @brief 多个 .dat 文件按 MDTTime 归并读取
+ *
+ * 各文件内部已按接收时间有序, 以小顶堆做 k 路归并, 输出真实的跨市场到达顺序.
+ * MDTTime 相同时按文件顺序输出, 单个文件内保持原始顺序.
+*/
+class MergeReader
+{
+public:
+    MergeReader(std::vector<std::string> filepaths, DatCallback callback);
+
+    void read();
+
+    /*!
+     * @brief 记录的接收时间, 所有 MDT 结构体的第一个字段均为 MDTTime
+    */
+    static uint64_t record_time(const Header *header) noexcept;
+
+    /* 因 MDTTime 回退而乱序的记录数(单个文件内) */
+    uint64_t out_of_order() const noexcept
+    { return out_of_order_; }
+
+private:
+    struct Source
+    {
+        MappedFile mapping;
+        size_t offset{0};
+        uint64_t time{0};
+    };
+
+    /*!
+     * @brief 定位到下一条完整记录
+     * @return 文件是否还有记录
+    */
+    bool advance(Source &source);
+
+    std::vector<std::string> dat_filepaths_;
+    DatCallback callback_;
+    uint64_t out_of_order_{0};
+};
+
+#endif //ORDERBOOK_MERGE_READER_H
@@ -0,0 +1,88 @@
+//
+// Created by x2h1z on 2021/12/2.
+//
+
+#ifndef ORDERBOOK_PACER_H
+#define ORDERBOOK_PACER_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+/*!
+ * @brief 按 MDTTime 控制记录的释放时刻
+ *
+ * 每条记录的目标时刻 = 首条记录的释放时刻 + (MDTTime - 首条 MDTTime) / speed.
+ * 距目标较远时先 sleep, 剩余 spin_ns 以内忙等, 使抖动保持在微秒级.
+*/
+class Pacer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /* 延迟直方图的桶数, 第 i 个桶为 [2^(i-1), 2^i) 纳秒 */
+    static constexpr int BUCKETS = 48;
+
+    struct Stats
+    {
+        uint64_t count{0};
+        /* 延迟超过 1 微秒的记录数 */
+        uint64_t late{0};
+        int64_t max_ns{0};
+        int64_t total_ns{0};
+        std::array<uint64_t, BUCKETS> buckets{};
+
+        /*!
+         * @brief 分位数的近似值(所在桶的上界)
+        */
+        int64_t percentile(double p) const noexcept;
+    };
+
+    /*!
+     * @param speed 倍速, 不大于 0 时不限速
+     * @param spin_ns 目标时刻前转为忙等的提前量
+    */
+    explicit Pacer(double speed = 1.0, int64_t spin_ns = 200'000) noexcept
+            : speed_(speed), spin_ns_(spin_ns)
+    {}
+
+    bool enabled() const noexcept
+    { return speed_ > 0; }
+
+    /*!
+     * @brief 等待到记录的目标时刻
+     * @param mdt_time 记录的 MDTTime(unix 微秒)
+     * @return 实际释放时刻晚于目标的纳秒数
+    */
+    int64_t wait(uint64_t mdt_time) noexcept;
+
+    /*!
+     * @brief 距记录目标时刻的纳秒数, 不大于 0 表示已到时
+    */
+    int64_t remaining_ns(uint64_t mdt_time) const noexcept;
+
+    void reset() noexcept
+    { started_ = false; }
+
+    const Stats &stats() const noexcept
+    { return stats_; }
+
+    /*!
+     * @brief 输出延迟统计
+    */
+    void report() const;
+
+private:
+    Clock::time_point target_of(uint64_t mdt_time) const noexcept;
+
+    double speed_;
+    int64_t spin_ns_;
+
+    bool started_{false};
+    uint64_t first_time_{0};
+    Clock::time_point first_clock_;
+
+    Stats stats_;
+};
+
+#endif //ORDERBOOK_PACER_H
@@ -5,9 +5,14 @@
 #ifndef ORDERBOOK_READER_H
 #define ORDERBOOK_READER_H
 
+#include <atomic>
+#include <cstring>
 #include <functional>
 #include <memory>
 #include <string>
+#include "dat/pacer.h"
+#include "dat/subscription.h"
+#include "dat/symbol_filter.h"
 #include "mdt/MDTDataType.h"
 #include "types.h"
 
@@ -24,6 +29,8 @@ struct Item
 {
     MsgType DataType;
     void *Data;
+    /* 数据长度, 不含 Header */
+    uint32_t DataLen;
 
     ~Item()
     {
@@ -35,20 +42,151 @@ struct Item
 
 using DatCallback = std::function<void(const std::shared_ptr<Item>)>;
 
+/*!
+ * @brief 订阅变化通知, offset 为第一条尚未交付的记录的偏移
+*/
+using SubscriptionCallback = std::function<void(const Subscription::Reader &, size_t offset)>;
+
+enum class ReadMode : uint8_t
+{
+    /* fread 逐条读取 */
+    STREAM,
+    /* mmap 整个文件 */
+    MMAP,
+    /* mmap 并持续追踪仍在写入的文件 */
+    FOLLOW,
+};
+
 class DatReader
 {
 private:
     std::string dat_filepath_;
     DatCallback callback_;
+    ReadMode mode_{ReadMode::STREAM};
+    /* 起始偏移, 仅 MMAP/FOLLOW 模式 */
+    size_t start_offset_{0};
+    /* 当前记录在文件中的偏移 */
+    size_t record_offset_{0};
+    std::atomic<bool> stopped_{false};
+    /* FOLLOW 模式下文件无增长超过该时长后结束, 0 表示一直等待 */
+    int64_t idle_timeout_ms_{0};
+    /* 按 MDTTime 控制释放节奏, 默认不限速 */
+    Pacer pacer_{0};
+    /* 当前记录的释放延迟 */
+    int64_t lateness_ns_{0};
+    /* 关注的股票, 其余记录不进入回调 */
+    SymbolFilter filter_;
+    /* 运行中可修改的订阅 */
+    Subscription::Reader *subscription_{nullptr};
+    SubscriptionCallback on_subscription_;
+
+    /*!
+     * @brief 切换到最新订阅, 变化时通知
+    */
+    void refresh_subscription(size_t offset)
+    {
+        if (subscription_->refresh() && on_subscription_) on_subscription_(*subscription_, offset);
+    }
+
+    /*!
+     * @brief 记录是否交付给回调, record_offset_ 须已指向该记录
+    */
+    bool accept(MsgType type, const void *data, size_t len)
+    {
+        if (subscription_ != nullptr) {
+            refresh_subscription(record_offset_);
+            if (!subscription_->accept(type, data, len)) return false;
+        }
+        return filter_.accept(type, data, len);
+    }
+
+    /*!
+     * @brief 限速时等待到记录的释放时刻
+    */
+    void pace(const void *data, size_t len) noexcept
+    {
+        if (pacer_.enabled()) lateness_ns_ = pacer_.wait(record_time(data, len));
+    }
 
     void bytes_stream_read();
 
     void memory_map_read();
 
+    void follow_read();
+
 public:
-    DatReader(std::string filepath, DatCallback callback);
+    DatReader(std::string filepath, DatCallback callback, ReadMode mode = ReadMode::STREAM);
 
     void read();
+
+    /*!
+     * @brief 从指定偏移开始读取(须为记录边界), 仅 MMAP/FOLLOW 模式
+    */
+    void seek(size_t offset) noexcept
+    { start_offset_ = offset; }
+
+    void set_idle_timeout(int64_t ms) noexcept
+    { idle_timeout_ms_ = ms; }
+
+    /*!
+     * @brief 按 MDTTime 以 speed 倍速重放, 不大于 0 时不限速
+    */
+    void set_speed(double speed) noexcept
+    { pacer_ = Pacer{speed}; }
+
+    /*!
+     * @brief 只交付关注股票的记录
+    */
+    void set_filter(SymbolFilter filter)
+    { filter_ = std::move(filter); }
+
+    /*!
+     * @brief 按运行中可修改的订阅过滤; 订阅变化在读线程上、两条记录之间通知
+    */
+    void set_subscription(Subscription::Reader *subscription, SubscriptionCallback on_change = {})
+    {
+        subscription_ = subscription;
+        on_subscription_ = std::move(on_change);
+    }
+
+    /*!
+     * @brief 在回调中调用, 当前记录实际释放时刻晚于计划的纳秒数
+    */
+    int64_t lateness_ns() const noexcept
+    { return lateness_ns_; }
+
+    const Pacer &pacer() const noexcept
+    { return pacer_; }
+
+    /*!
+     * @brief 读完当前记录后停止, FOLLOW 模式下也可由其它线程调用; read 开始前调用时 read 立即返回
+    */
+    void stop() noexcept
+    { stopped_.store(true, std::memory_order_relaxed); }
+
+    /*!
+     * @brief 当前回调记录的起始偏移
+    */
+    size_t record_offset() const noexcept
+    { return record_offset_; }
+
+    /*!
+     * @brief 一条记录(Header + 数据)的总长度
+    */
+    static size_t record_size(const Header &header) noexcept
+    { return sizeof(Header) + static_cast<uint16_t>(header.DataLen); }
+
+    /*!
+     * @brief 记录的接收时间, 所有 MDT 结构体的第一个字段均为 MDTTime
+    */
+    static uint64_t record_time(const void *data, size_t len) noexcept
+    {
+        if (len < sizeof(uint64_t)) return 0;
+
+        uint64_t time;
+        std::memcpy(&time, data, sizeof(time));
+        return time;
+    }
 };
 
 #endif //ORDERBOOK_READER_H
@@ -0,0 +1,134 @@
+//
+// Created by x2h1z on 2021/12/5.
+//
+
+#ifndef ORDERBOOK_SUBSCRIPTION_H
+#define ORDERBOOK_SUBSCRIPTION_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "containers/rcu_ptr.h"
+#include "dat/symbol_filter.h"
+
+/*!
+ * @brief 某一版本的订阅列表
+*/
+struct SubscriptionTable
+{
+    uint64_t version{0};
+    /* 已排序去重 */
+    std::vector<std::string> symbols;
+    SymbolFilter filter;
+};
+
+/*!
+ * @brief 运行中可修改的订阅表. 读路径不加锁, 修改以整表替换的方式发布
+ *
+ * 空列表表示不过滤, 与 PipelineConfig::symbols 一致
+*/
+class Subscription
+{
+public:
+    explicit Subscription(std::vector<std::string> symbols = {});
+
+    /*!
+     * @brief 发布新的订阅列表, 与当前相同时忽略; 不支持由指定列表切换为空列表(全部订阅), 同样忽略
+     * @return 是否发布了新版本
+    */
+    bool update(std::vector<std::string> symbols);
+
+    uint64_t version() const noexcept
+    { return version_.load(std::memory_order_acquire); }
+
+    /*!
+     * @brief 读线程持有的句柄, 不可跨线程使用
+    */
+    class Reader
+    {
+    public:
+        explicit Reader(Subscription &subscription);
+
+        ~Reader();
+
+        Reader(const Reader &) = delete;
+
+        Reader &operator=(const Reader &) = delete;
+
+        /*!
+         * @brief 在两条记录之间调用: 宣告静默并切换到最新版本
+         * @return 订阅是否变化, 变化时 added()/removed() 为本次差异
+        */
+        bool refresh();
+
+        bool accept(MsgType type, const void *data, size_t len) const noexcept
+        { return table_->filter.accept(type, data, len); }
+
+        const SubscriptionTable &table() const noexcept
+        { return *table_; }
+
+        const std::vector<std::string> &added() const noexcept
+        { return added_; }
+
+        const std::vector<std::string> &removed() const noexcept
+        { return removed_; }
+
+    private:
+        Subscription &subscription_;
+        int slot_;
+        const SubscriptionTable *table_;
+        /* 本线程上次看到的订阅, 旧表可能已被回收, 不能引用 */
+        std::vector<std::string> symbols_;
+        std::vector<std::string> added_;
+        std::vector<std::string> removed_;
+    };
+
+    /*!
+     * @brief 回收读线程都已不再引用的旧表
+    */
+    void reclaim()
+    { table_.reclaim(); }
+
+private:
+    std::mutex mutex_;
+    std::vector<std::string> current_;
+    std::atomic<uint64_t> version_{1};
+    RcuPtr<SubscriptionTable> table_;
+};
+
+/*!
+ * @brief 监视订阅文件(一行逗号分隔的代码), 文件修改后发布新列表
+*/
+class SubscriptionWatcher
+{
+public:
+    SubscriptionWatcher(Subscription &subscription, std::string file_path, int64_t interval_ms = 200);
+
+    ~SubscriptionWatcher();
+
+    SubscriptionWatcher(const SubscriptionWatcher &) = delete;
+
+    SubscriptionWatcher &operator=(const SubscriptionWatcher &) = delete;
+
+    void stop();
+
+    /*!
+     * @brief 读取订阅文件
+    */
+    static std::vector<std::string> load(const std::string &file_path);
+
+private:
+    void run();
+
+    Subscription &subscription_;
+    std::string file_path_;
+    int64_t interval_ms_;
+    std::atomic<bool> running_{true};
+    std::thread thread_;
+};
+
+#endif //ORDERBOOK_SUBSCRIPTION_H
@@ -0,0 +1,60 @@
+//
+// Created by x2h1z on 2021/12/4.
+//
+
+#ifndef ORDERBOOK_SYMBOL_FILTER_H
+#define ORDERBOOK_SYMBOL_FILTER_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "dat/dispatch.h"
+
+/*!
+ * @brief 读取层的股票过滤
+ *
+ * 代码的前 8 字节(含结尾 '\0')按 uint64 比较, 关注集合按 4 个一组存放,
+ * 支持 AVX2 时一次比较 4 个代码, 否则逐个比较. 超过 7 个字符的代码另行逐字比较.
+*/
+class SymbolFilter
+{
+public:
+    SymbolFilter() = default;
+
+    explicit SymbolFilter(const std::vector<std::string> &symbols);
+
+    /* 空集合表示不过滤 */
+    bool empty() const noexcept
+    { return count_ == 0 && long_.empty(); }
+
+    size_t size() const noexcept
+    { return count_ + long_.size(); }
+
+    bool contains(const char *symbol) const noexcept;
+
+    /*!
+     * @brief 记录是否属于关注集合. 未知类型或长度不足的记录不在此过滤
+    */
+    bool accept(MsgType type, const void *data, size_t len) const noexcept
+    {
+        if (empty()) return true;
+
+        int32_t offset = x2h::dat::symbol_offset(type);
+        if (offset < 0 || len < static_cast<size_t>(offset) + sizeof(uint64_t)) return true;
+        return contains(static_cast<const char *>(data) + offset);
+    }
+
+private:
+    using MatchFn = bool (*)(const uint64_t *values, const uint64_t *masks, size_t n, uint64_t key) noexcept;
+
+    /* 按 4 对齐填充, 填充项的掩码为 0、值为 1, 永不匹配 */
+    std::vector<uint64_t> values_;
+    std::vector<uint64_t> masks_;
+    size_t count_{0};
+    std::vector<std::string> long_;
+    MatchFn match_{nullptr};
+};
+
+#endif //ORDERBOOK_SYMBOL_FILTER_H
@@ -0,0 +1,335 @@
+//
+// Created by x2h1z on 2021/11/15.
+//
+
+#ifndef ORDERBOOK_LOGGER_H
+#define ORDERBOOK_LOGGER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "fmt/format.h"
+#include "utils.h"
+
+namespace x2h::log
+{
+    /*!
+     * @brief 单生产者单消费者的字节环形缓冲区
+     *
+     * 每个写日志的线程独占一个, 热路径只做 memcpy, 格式化由后台线程完成
+    */
+    class Ring
+    {
+    public:
+        /* 记录按 8 字节对齐, 尾部放不下时写入填充记录并回绕 */
+        static constexpr uint32_t ALIGN = 8;
+        static constexpr uint32_t PAD = 0xFFFFFFFFu;
+
+        explicit Ring(size_t capacity);
+
+        ~Ring();
+
+        Ring(const Ring &) = delete;
+
+        Ring &operator=(const Ring &) = delete;
+
+        /*!
+         * @brief 申请一段连续可写空间
+         * @param size 记录字节数(已对齐)
+         * @return 可写地址, 空间不足时返回 nullptr
+        */
+        char *reserve(uint32_t size) noexcept;
+
+        /*!
+         * @brief 提交 reserve 得到的记录
+        */
+        void commit(uint32_t size) noexcept;
+
+        /*!
+         * @brief 读取下一条记录
+         * @return 记录地址, 无数据时返回 nullptr
+        */
+        const char *front() noexcept;
+
+        /*!
+         * @brief 释放 front 得到的记录
+        */
+        void pop(uint32_t size) noexcept;
+
+        bool empty() const noexcept
+        { return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire); }
+
+        /*!
+         * @brief 取出并清零因空间不足而丢弃的记录数
+        */
+        uint64_t take_dropped() noexcept
+        { return dropped_.exchange(0, std::memory_order_relaxed); }
+
+        void on_drop() noexcept
+        { dropped_.fetch_add(1, std::memory_order_relaxed); }
+
+        uint64_t thread_id() const noexcept
+        { return thread_id_; }
+
+        void retire() noexcept
+        { retired_.store(true, std::memory_order_release); }
+
+        bool retired() const noexcept
+        { return retired_.load(std::memory_order_acquire); }
+
+    private:
+        char *buffer_;
+        size_t capacity_;
+        size_t mask_;
+        uint64_t thread_id_;
+
+        /* 生产者 */
+        alignas(64) std::atomic<uint64_t> head_{0};
+        uint64_t tail_cache_{0};
+        /* 消费者 */
+        alignas(64) std::atomic<uint64_t> tail_{0};
+        uint64_t head_cache_{0};
+
+        alignas(64) std::atomic<uint64_t> dropped_{0};
+        std::atomic<bool> retired_{false};
+    };
+
+    using FormatFn = void (*)(fmt::memory_buffer &out, const char *fmt, const char *args);
+
+    /*!
+     * @brief 环形缓冲区中的记录头, 参数以二进制形式紧随其后
+    */
+    struct RecordHeader
+    {
+        uint32_t size;
+        Level level;
+        int64_t timestamp;
+        const char *fmt;
+        FormatFn format;
+    };
+
+    /*!
+     * @brief 后台日志线程, 负责收集各线程的 Ring 并格式化输出
+    */
+    class Logger
+    {
+    public:
+        static Logger &instance();
+
+        ~Logger();
+
+        Logger(const Logger &) = delete;
+
+        Logger &operator=(const Logger &) = delete;
+
+        /*!
+         * @brief 输出到文件, 为空时输出到 stderr
+        */
+        bool open(const std::string &file_path);
+
+        void set_level(Level level) noexcept
+        { level_.store(level, std::memory_order_relaxed); }
+
+        Level level() const noexcept
+        { return level_.load(std::memory_order_relaxed); }
+
+        bool enabled(Level level) const noexcept
+        { return level >= level_.load(std::memory_order_relaxed) && level != OFF; }
+
+        /*!
+         * @brief 当前线程的 Ring, 首次调用时注册
+        */
+        Ring &local_ring();
+
+        /*!
+         * @brief 阻塞直到所有已提交的记录写出
+        */
+        void flush();
+
+        /*!
+         * @brief 写出剩余记录并停止后台线程
+        */
+        void stop();
+
+        size_t ring_capacity() const noexcept
+        { return ring_capacity_; }
+
+        void set_ring_capacity(size_t capacity) noexcept
+        { ring_capacity_ = capacity; }
+
+    private:
+        Logger();
+
+        void run();
+
+        bool drain_once();
+
+        void write_record(const Ring &ring, const RecordHeader &header, const char *args);
+
+        std::mutex mutex_;
+        std::vector<std::shared_ptr<Ring>> rings_;
+        std::thread thread_;
+        std::FILE *file_{stderr};
+        fmt::memory_buffer buffer_;
+
+        std::atomic<Level> level_{INF};
+        std::atomic<bool> running_{true};
+        std::atomic<uint64_t> flush_request_{0};
+        std::atomic<uint64_t> flush_done_{0};
+        size_t ring_capacity_{1 << 20};
+    };
+
+    namespace detail
+    {
+        template<typename T>
+        using Decay = std::remove_cv_t<std::remove_reference_t<T>>;
+
+        template<typename T>
+        inline constexpr bool is_string_v =
+                std::is_same_v<std::decay_t<T>, const char *> || std::is_same_v<std::decay_t<T>, char *> ||
+                std::is_same_v<Decay<T>, std::string> || std::is_same_v<Decay<T>, std::string_view>;
+
+        /*!
+         * @brief 参数在后台线程中被还原的类型
+        */
+        template<typename T>
+        using Stored = std::conditional_t<is_string_v<T>, std::string_view, Decay<T>>;
+
+        template<typename T>
+        inline std::string_view as_view(const T &arg) noexcept
+        {
+            if constexpr (std::is_pointer_v<std::decay_t<T>>) {
+                return arg ? std::string_view{arg} : std::string_view{"(null)"};
+            } else {
+                return std::string_view{arg};
+            }
+        }
+
+        /*!
+         * @brief 定长字符数组(如 Symbol::code)不保证以 0 结尾, 长度不超过 N
+        */
+        template<size_t N>
+        inline std::string_view as_view(const char (&arg)[N]) noexcept
+        {
+            return {arg, strnlen(arg, N)};
+        }
+
+        template<typename T>
+        inline uint32_t arg_size(const T &arg) noexcept
+        {
+            if constexpr (is_string_v<T>) {
+                return static_cast<uint32_t>(sizeof(uint32_t) + as_view(arg).size());
+            } else {
+                static_assert(std::is_trivially_copyable_v<Decay<T>>, "日志参数必须可平凡复制或为字符串");
+                return sizeof(Decay<T>);
+            }
+        }
+
+        template<typename T>
+        inline char *encode(char *dst, const T &arg) noexcept
+        {
+            if constexpr (is_string_v<T>) {
+                auto view = as_view(arg);
+                auto len = static_cast<uint32_t>(view.size());
+                std::memcpy(dst, &len, sizeof(len));
+                std::memcpy(dst + sizeof(len), view.data(), len);
+                return dst + sizeof(len) + len;
+            } else {
+                std::memcpy(dst, &arg, sizeof(Decay<T>));
+                return dst + sizeof(Decay<T>);
+            }
+        }
+
+        template<typename T>
+        inline Stored<T> decode(const char *&src) noexcept
+        {
+            if constexpr (is_string_v<T>) {
+                uint32_t len;
+                std::memcpy(&len, src, sizeof(len));
+                std::string_view view{src + sizeof(len), len};
+                src += sizeof(len) + len;
+                return view;
+            } else {
+                Decay<T> value;
+                std::memcpy(&value, src, sizeof(value));
+                src += sizeof(value);
+                return value;
+            }
+        }
+
+        template<typename... Args>
+        void format_record(fmt::memory_buffer &out, const char *fmt, [[maybe_unused]] const char *args)
+        {
+            //! 花括号初始化保证从左到右求值
+            std::tuple<Stored<Args>...> values{decode<Args>(args)...};
+            std::apply([&](const auto &... v) {
+                fmt::format_to(std::back_inserter(out), fmt::runtime(fmt), v...);
+            }, values);
+        }
+
+        inline int64_t now_ns() noexcept
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+    }
+
+    /*!
+     * @brief 写入一条日志. 热路径只拷贝参数, 不做格式化
+     * @param fmt 格式串, 必须具有静态生存期(字符串字面量)
+    */
+    template<typename... Args>
+    inline void write(Level level, fmt::format_string<const Args &...> fmt, const Args &... args)
+    {
+        auto &logger = Logger::instance();
+        if (!logger.enabled(level)) return;
+
+        uint32_t size = sizeof(RecordHeader);
+        ((size += detail::arg_size(args)), ...);
+        size = (size + Ring::ALIGN - 1) & ~(Ring::ALIGN - 1);
+
+        auto &ring = logger.local_ring();
+        char *dst = ring.reserve(size);
+        if (dst == nullptr) {
+            ring.on_drop();
+            return;
+        }
+
+        RecordHeader header{size, level, detail::now_ns(), static_cast<fmt::string_view>(fmt).data(),
+                            &detail::format_record<Args...>};
+        std::memcpy(dst, &header, sizeof(header));
+        [[maybe_unused]] char *p = dst + sizeof(header);
+        ((p = detail::encode(p, args)), ...);
+
+        ring.commit(size);
+    }
+
+    template<typename... Args>
+    inline void debug(fmt::format_string<const Args &...> fmt, const Args &... args)
+    { write<Args...>(DBG, fmt, args...); }
+
+    template<typename... Args>
+    inline void info(fmt::format_string<const Args &...> fmt, const Args &... args)
+    { write<Args...>(INF, fmt, args...); }
+
+    template<typename... Args>
+    inline void warn(fmt::format_string<const Args &...> fmt, const Args &... args)
+    { write<Args...>(WRN, fmt, args...); }
+
+    template<typename... Args>
+    inline void error(fmt::format_string<const Args &...> fmt, const Args &... args)
+    { write<Args...>(ERR, fmt, args...); }
+}
+
+#endif //ORDERBOOK_LOGGER_H
@@ -0,0 +1,144 @@
+//
+// Created by x2h1z on 2021/12/1.
+//
+
+#ifndef ORDERBOOK_UDP_FEED_H
+#define ORDERBOOK_UDP_FEED_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "dat/reader.h"
+
+namespace x2h::net
+{
+    /*!
+     * @brief UDP 行情源配置
+     *
+     * 每个数据报包含一条或多条完整的 Header + MDT 结构体记录, 格式与 .dat 相同.
+     * 地址为组播地址(224.0.0.0/4)时在 interface 上加入组播组
+    */
+    struct UdpFeedConfig
+    {
+        std::string address{"127.0.0.1"};
+        uint16_t port{30001};
+        /* 本机接口地址, 用于组播 */
+        std::string interface{"127.0.0.1"};
+        /* recvmmsg 单次最多接收的数据报数 */
+        unsigned batch{64};
+        /* 单个数据报缓冲区长度 */
+        size_t datagram_size{1 << 16};
+        /* SO_RCVBUF */
+        int socket_buffer{16 << 20};
+        /* 非阻塞忙轮询, 否则阻塞等待 */
+        bool busy_poll{false};
+        /* 无数据超过该时长后结束, 0 表示一直等待 */
+        int64_t idle_timeout_ms{0};
+    };
+
+    /*!
+     * @brief UDP 行情接收, 交付给与 DatReader 相同的回调
+    */
+    class UdpFeed
+    {
+    public:
+        UdpFeed(UdpFeedConfig config, DatCallback callback);
+
+        ~UdpFeed();
+
+        UdpFeed(const UdpFeed &) = delete;
+
+        UdpFeed &operator=(const UdpFeed &) = delete;
+
+        bool is_open() const noexcept
+        { return fd_ >= 0; }
+
+        /*!
+         * @brief 接收直到 stop() 或空闲超时
+        */
+        void run();
+
+        void stop() noexcept
+        { stopped_.store(true, std::memory_order_relaxed); }
+
+        uint64_t datagrams() const noexcept
+        { return datagrams_; }
+
+        uint64_t records() const noexcept
+        { return records_; }
+
+        /* 数据报末尾不完整的记录数 */
+        uint64_t malformed() const noexcept
+        { return malformed_; }
+
+    private:
+        bool open();
+
+        void dispatch(const char *data, size_t size);
+
+        UdpFeedConfig config_;
+        DatCallback callback_;
+        int fd_{-1};
+        std::atomic<bool> stopped_{false};
+        /* 交付给回调的记录, 每条记录复用, 接收路径不分配 */
+        std::shared_ptr<Item> item_{std::make_shared<Item>()};
+
+        /* 预分配的接收缓冲区, batch 个 datagram_size 连续存放 */
+        std::vector<char> buffer_;
+
+        uint64_t datagrams_{0};
+        uint64_t records_{0};
+        uint64_t malformed_{0};
+    };
+
+    /*!
+     * @brief 通过 UDP 重放 .dat 文件, 用于在单机上测试与压测接收端
+    */
+    struct UdpSenderConfig
+    {
+        std::string address{"127.0.0.1"};
+        uint16_t port{30001};
+        std::string interface{"127.0.0.1"};
+        /* 单个数据报的最大长度, 多条记录合并发送 */
+        size_t datagram_size{1472};
+        /* sendmmsg 单次最多发送的数据报数 */
+        unsigned batch{64};
+        /* 按 MDTTime 的倍速重放, 0 表示不限速 */
+        double speed{1.0};
+    };
+
+    class UdpSender
+    {
+    public:
+        explicit UdpSender(UdpSenderConfig config);
+
+        ~UdpSender();
+
+        UdpSender(const UdpSender &) = delete;
+
+        UdpSender &operator=(const UdpSender &) = delete;
+
+        bool is_open() const noexcept
+        { return fd_ >= 0; }
+
+        /*!
+         * @return 发送的记录数
+        */
+        uint64_t send(const std::string &dat_file);
+
+        uint64_t datagrams() const noexcept
+        { return datagrams_; }
+
+    private:
+        bool open();
+
+        UdpSenderConfig config_;
+        int fd_{-1};
+        uint64_t datagrams_{0};
+    };
+}
+
+#endif //ORDERBOOK_UDP_FEED_H
@@ -0,0 +1,100 @@
+//
+// Created by x2h1z on 2021/12/12.
+//
+
+#ifndef ORDERBOOK_ALLOC_H
+#define ORDERBOOK_ALLOC_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "perf/latency.h"
+
+/*!
+ * 分配统计只在定义 OB_ALLOC 时编译(cmake -DOB_ALLOC=ON): 替换全局 operator new/delete,
+ * 按当前线程所处的阶段/操作与消息类型计数; 关闭时 X2H_ALLOC(...) 展开为空
+*/
+#ifdef OB_ALLOC
+#define X2H_ALLOC(...) __VA_ARGS__
+#else
+#define X2H_ALLOC(...)
+#endif
+
+namespace x2h::perf
+{
+#ifdef OB_ALLOC
+    inline constexpr bool ALLOC_ENABLED = true;
+#else
+    inline constexpr bool ALLOC_ENABLED = false;
+#endif
+
+    /*!
+     * @brief 稳态阶段热路径内发生分配时的处理方式
+    */
+    enum class AllocPolicy : uint8_t
+    {
+        /* 计数, 由调用方在结束时判定失败 */
+        COUNT,
+        /* 立即输出所在阶段并 abort, 便于在 core 中定位调用栈 */
+        ABORT
+    };
+
+    /*!
+     * @brief 标记当前线程进入热路径的一个阶段或操作, 析构时恢复
+     *
+     * 阶段与操作分别记录, 操作内的分配同时计入外层阶段.
+    */
+    class ScopedAlloc
+    {
+    public:
+        ScopedAlloc(Msg msg, Stage stage) noexcept;
+
+        ScopedAlloc(Msg msg, Op op) noexcept;
+
+        ~ScopedAlloc();
+
+        ScopedAlloc(const ScopedAlloc &) = delete;
+
+        ScopedAlloc &operator=(const ScopedAlloc &) = delete;
+
+        /*!
+         * @brief 操作类型在进入后才能确定时改写, 只对以 Op 构造的作用域有效
+        */
+        void set_op(Op op) noexcept;
+
+    private:
+        bool is_op_;
+        int16_t previous_;
+    };
+
+    /*!
+     * @brief 进入/退出稳态; 稳态下热路径作用域内的每次分配都计为违规
+    */
+    void set_alloc_steady(bool steady, AllocPolicy policy = AllocPolicy::COUNT) noexcept;
+
+    /*!
+     * @brief 稳态下热路径内的分配次数(全部线程)
+    */
+    uint64_t alloc_violations() noexcept;
+
+    /*!
+     * @brief 结束时输出全部线程合并后的分配统计
+     *
+     * 未定义 OB_ALLOC 时为空操作
+    */
+    class AllocReporter
+    {
+    public:
+        AllocReporter() = default;
+
+        ~AllocReporter();
+
+        AllocReporter(const AllocReporter &) = delete;
+
+        AllocReporter &operator=(const AllocReporter &) = delete;
+
+        void report() const;
+    };
+}
+
+#endif //ORDERBOOK_ALLOC_H
@@ -0,0 +1,172 @@
+//
+// Created by x2h1z on 2021/12/11.
+//
+
+#ifndef ORDERBOOK_COUNTERS_H
+#define ORDERBOOK_COUNTERS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "perf/latency.h"
+
+/*!
+ * 硬件计数器只在定义 OB_COUNTERS 时编译进热路径(cmake -DOB_COUNTERS=ON),
+ * 每次采样是两次 read 系统调用, 只用于定位慢的原因, 不用于测量绝对延迟
+*/
+#ifdef OB_COUNTERS
+#define X2H_COUNTERS(...) __VA_ARGS__
+#else
+#define X2H_COUNTERS(...)
+#endif
+
+namespace x2h::perf
+{
+#ifdef OB_COUNTERS
+    inline constexpr bool COUNTERS_ENABLED = true;
+#else
+    inline constexpr bool COUNTERS_ENABLED = false;
+#endif
+
+    enum class Counter : uint8_t
+    {
+        CYCLES,
+        INSTRUCTIONS,
+        L1D_MISSES,
+        LLC_MISSES,
+        BRANCH_MISSES,
+        COUNT
+    };
+
+    inline constexpr size_t COUNTER_COUNT = static_cast<size_t>(Counter::COUNT);
+
+    using CounterValues = std::array<uint64_t, COUNTER_COUNT>;
+
+    const char *counter_name(Counter counter) noexcept;
+
+    /*!
+     * @brief 当前线程的一组 perf_event 计数器
+     *
+     * 以 cycles 为组长打开, 一次 read 取回全部计数. 单个计数器不可用时只缺该项;
+     * 组长打不开(非 Linux, 容器内 perf_event_paranoid 限制等)时整组不可用, read 返回 false.
+    */
+    class CounterGroup
+    {
+    public:
+        CounterGroup();
+
+        ~CounterGroup();
+
+        CounterGroup(const CounterGroup &) = delete;
+
+        CounterGroup &operator=(const CounterGroup &) = delete;
+
+        bool available() const noexcept
+        { return leader_ >= 0; }
+
+        bool has(Counter counter) const noexcept
+        { return slots_[static_cast<size_t>(counter)] >= 0; }
+
+        /*!
+         * @brief 读取全部计数, 不可用的计数器为 0
+        */
+        bool read(CounterValues &values) const noexcept;
+
+    private:
+        int leader_{-1};
+        std::array<int, COUNTER_COUNT> fds_{};
+        /* 计数器在组读取结果中的下标, -1 表示不可用 */
+        std::array<int, COUNTER_COUNT> slots_{};
+        int opened_{0};
+    };
+
+    /*!
+     * @brief 单个线程按消息类型与阶段/操作累计的计数
+    */
+    class CounterRecorder
+    {
+    public:
+        struct Totals
+        {
+            std::atomic<uint64_t> samples{0};
+            std::array<std::atomic<uint64_t>, COUNTER_COUNT> values{};
+        };
+
+        const CounterGroup &group() const noexcept
+        { return group_; }
+
+        /*!
+         * @brief 累计一次采样 end - begin, 只由所属线程调用
+        */
+        void add(Msg msg, size_t kind, const CounterValues &begin, const CounterValues &end) noexcept;
+
+        const Totals &totals(Msg msg, size_t kind) const noexcept
+        { return totals_[static_cast<size_t>(msg)][kind]; }
+
+    private:
+        CounterGroup group_;
+        std::array<std::array<Totals, KIND_COUNT>, MSG_COUNT> totals_{};
+    };
+
+    /*!
+     * @brief 当前线程的 CounterRecorder, 首次调用时打开计数器并注册
+    */
+    CounterRecorder &local_counters();
+
+    /*!
+     * @brief 析构时累计作用域内的计数
+    */
+    class ScopedCounters
+    {
+    public:
+        template<typename Kind>
+        ScopedCounters(Msg msg, Kind kind) noexcept
+                : recorder_(local_counters()), msg_(msg), kind_(kind_of(kind))
+        {
+            active_ = recorder_.group().read(begin_);
+        }
+
+        ~ScopedCounters()
+        {
+            CounterValues end;
+            if (active_ && recorder_.group().read(end)) recorder_.add(msg_, kind_, begin_, end);
+        }
+
+        ScopedCounters(const ScopedCounters &) = delete;
+
+        ScopedCounters &operator=(const ScopedCounters &) = delete;
+
+        void set_op(Op op) noexcept
+        { kind_ = kind_of(op); }
+
+    private:
+        CounterRecorder &recorder_;
+        Msg msg_;
+        size_t kind_;
+        bool active_{false};
+        CounterValues begin_{};
+    };
+
+    /*!
+     * @brief 结束时输出全部线程合并后的每条消息计数与 IPC
+     *
+     * 未定义 OB_COUNTERS 时为空操作
+    */
+    class CounterReporter
+    {
+    public:
+        CounterReporter() = default;
+
+        ~CounterReporter();
+
+        CounterReporter(const CounterReporter &) = delete;
+
+        CounterReporter &operator=(const CounterReporter &) = delete;
+
+        void report() const;
+    };
+}
+
+#endif //ORDERBOOK_COUNTERS_H
@@ -0,0 +1,331 @@
+//
+// Created by x2h1z on 2021/12/10.
+//
+
+#ifndef ORDERBOOK_LATENCY_H
+#define ORDERBOOK_LATENCY_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+#include "mdt/MDTDataType.h"
+#include "types.h"
+
+/*!
+ * 延迟统计只在定义 OB_LATENCY 时编译进热路径(cmake -DOB_LATENCY=ON),
+ * 关闭时 X2H_LATENCY(...) 展开为空, 不产生任何开销
+*/
+#ifdef OB_LATENCY
+#define X2H_LATENCY(...) __VA_ARGS__
+#else
+#define X2H_LATENCY(...)
+#endif
+
+namespace x2h::perf
+{
+#ifdef OB_LATENCY
+    inline constexpr bool LATENCY_ENABLED = true;
+#else
+    inline constexpr bool LATENCY_ENABLED = false;
+#endif
+
+    /*!
+     * @brief 逐笔消息类型
+    */
+    enum class Msg : uint8_t
+    {
+        SH_ORDER,
+        SH_TRADE,
+        SZ_ORDER,
+        SZ_TRADE,
+        OTHER,
+        COUNT
+    };
+
+    /*!
+     * @brief 流水线各边界之间的耗时
+    */
+    enum class Stage : uint8_t
+    {
+        /* 读取 -> 解码完成, 含读取队列的等待 */
+        DECODE,
+        /* OrderBook 更新本身 */
+        APPLY,
+        /* 更新完成 -> 输出完成, 含输出队列的等待 */
+        PUBLISH,
+        /* MDTTime -> 输出完成, 墙上时间, 只在实时行情下有意义 */
+        END_TO_END,
+        COUNT
+    };
+
+    /*!
+     * @brief OrderBook 内部的操作, ADD 为 on_order 全程(含 MATCH)
+    */
+    enum class Op : uint8_t
+    {
+        ADD,
+        CANCEL,
+        FILL,
+        MATCH,
+        COUNT
+    };
+
+    inline constexpr size_t MSG_COUNT = static_cast<size_t>(Msg::COUNT);
+    inline constexpr size_t STAGE_COUNT = static_cast<size_t>(Stage::COUNT);
+    inline constexpr size_t OP_COUNT = static_cast<size_t>(Op::COUNT);
+
+    const char *msg_name(Msg msg) noexcept;
+
+    const char *stage_name(Stage stage) noexcept;
+
+    const char *op_name(Op op) noexcept;
+
+    /* 阶段与操作合并编号, 操作排在阶段之后, 用于按两者统一统计的表 */
+    inline constexpr size_t KIND_COUNT = STAGE_COUNT + OP_COUNT;
+
+    constexpr size_t kind_of(Stage stage) noexcept
+    { return static_cast<size_t>(stage); }
+
+    constexpr size_t kind_of(Op op) noexcept
+    { return STAGE_COUNT + static_cast<size_t>(op); }
+
+    const char *kind_name(size_t kind) noexcept;
+
+    inline Msg msg_of(MsgType type) noexcept
+    {
+        switch (type) {
+            case Msg_SSEL2_Order:
+                return Msg::SH_ORDER;
+            case Msg_SSEL2_Transaction:
+                return Msg::SH_TRADE;
+            case Msg_SZSEL2_Order:
+                return Msg::SZ_ORDER;
+            case Msg_SZSEL2_Transaction:
+                return Msg::SZ_TRADE;
+            default:
+                return Msg::OTHER;
+        }
+    }
+
+    inline Msg msg_of(type::data::Exchange exchange, bool trade) noexcept
+    {
+        if (exchange == type::data::Exchange::SH) return trade ? Msg::SH_TRADE : Msg::SH_ORDER;
+        return trade ? Msg::SZ_TRADE : Msg::SZ_ORDER;
+    }
+
+    inline Msg msg_of(const type::data::Event &event) noexcept
+    {
+        return msg_of(event.exchange(), event.type == type::data::EventType::TRADE);
+    }
+
+    /*!
+     * @brief 读取时间戳计数器, 非 x86 平台退化为 steady_clock 纳秒
+    */
+    inline uint64_t rdtsc() noexcept
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    /*!
+     * @brief 每纳秒的 TSC 周期数, 首次调用时对照 steady_clock 标定(约 20ms)
+    */
+    double tsc_per_ns() noexcept;
+
+    inline uint64_t tsc_to_ns(uint64_t cycles) noexcept
+    {
+        return static_cast<uint64_t>(static_cast<double>(cycles) / tsc_per_ns());
+    }
+
+    /*!
+     * @brief 从 start 到现在经过的纳秒数
+    */
+    inline uint64_t elapsed_ns(uint64_t start) noexcept
+    {
+        uint64_t now = rdtsc();
+        return now > start ? tsc_to_ns(now - start) : 0;
+    }
+
+    /*!
+     * @brief 对数线性(HDR 风格)直方图, 单位纳秒
+     *
+     * 小于 2^SUB_BITS 的值精确记录, 更大的值每个 2 的幂区间分 2^(SUB_BITS-1) 个桶,
+     * 相对误差不超过 2^-(SUB_BITS-1). 超过 2^MAX_BITS 的值记入最后一个桶.
+     * 只允许所属线程 record, 其他线程可随时读取.
+    */
+    class Histogram
+    {
+    public:
+        static constexpr int SUB_BITS = 6;
+        static constexpr int MAX_BITS = 40;
+        static constexpr size_t BUCKETS = static_cast<size_t>(MAX_BITS - SUB_BITS + 2) << (SUB_BITS - 1);
+
+        using Counts = std::array<uint64_t, BUCKETS>;
+
+        static size_t index_of(uint64_t value) noexcept
+        {
+            value = std::min(value, (uint64_t{1} << MAX_BITS) - 1);
+            if (value < (uint64_t{1} << SUB_BITS)) return static_cast<size_t>(value);
+
+            int shift = 63 - __builtin_clzll(value) - SUB_BITS + 1;
+            return (static_cast<size_t>(shift) << (SUB_BITS - 1)) + static_cast<size_t>(value >> shift);
+        }
+
+        /*!
+         * @brief 桶的下界
+        */
+        static uint64_t value_of(size_t index) noexcept
+        {
+            if (index < (size_t{1} << SUB_BITS)) return index;
+
+            size_t shift = (index >> (SUB_BITS - 1)) - 1;
+            return static_cast<uint64_t>(index - (shift << (SUB_BITS - 1))) << shift;
+        }
+
+        void record(uint64_t value) noexcept
+        {
+            auto &count = counts_[index_of(value)];
+            //! 单写者, 不需要原子的读-改-写
+            count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        void add_to(Counts &out) const noexcept
+        {
+            for (size_t i = 0; i < BUCKETS; ++i) out[i] += counts_[i].load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::array<std::atomic<uint64_t>, BUCKETS> counts_{};
+    };
+
+    /*!
+     * @brief 直方图的分位数摘要
+    */
+    struct LatencySummary
+    {
+        uint64_t count{0};
+        uint64_t p50{0};
+        uint64_t p90{0};
+        uint64_t p99{0};
+        uint64_t p999{0};
+        uint64_t max{0};
+    };
+
+    LatencySummary summarize(const Histogram::Counts &counts) noexcept;
+
+    /*!
+     * @brief 单个线程的全部直方图, 按消息类型与阶段/操作划分
+    */
+    class LatencyRecorder
+    {
+    public:
+        void stage(Msg msg, Stage stage, uint64_t ns) noexcept
+        { stages_[static_cast<size_t>(msg)][static_cast<size_t>(stage)].record(ns); }
+
+        void op(Msg msg, Op op, uint64_t ns) noexcept
+        { ops_[static_cast<size_t>(msg)][static_cast<size_t>(op)].record(ns); }
+
+        /*!
+         * @brief 记录 MDTTime(unix 微秒) 到现在的墙上时间, 超过 1 小时视为回放历史数据, 不记录
+        */
+        void end_to_end(Msg msg, int64_t rec_time_us) noexcept;
+
+        const Histogram &stage_histogram(Msg msg, Stage stage) const noexcept
+        { return stages_[static_cast<size_t>(msg)][static_cast<size_t>(stage)]; }
+
+        const Histogram &op_histogram(Msg msg, Op op) const noexcept
+        { return ops_[static_cast<size_t>(msg)][static_cast<size_t>(op)]; }
+
+    private:
+        std::array<std::array<Histogram, STAGE_COUNT>, MSG_COUNT> stages_{};
+        std::array<std::array<Histogram, OP_COUNT>, MSG_COUNT> ops_{};
+    };
+
+    /*!
+     * @brief 当前线程的 LatencyRecorder, 首次调用时注册, 线程退出后数据仍保留
+    */
+    LatencyRecorder &local_recorder();
+
+    /*!
+     * @brief 析构时记录一次操作耗时
+    */
+    class ScopedOp
+    {
+    public:
+        ScopedOp(Msg msg, Op op) noexcept
+                : msg_(msg), op_(op), start_(rdtsc())
+        {}
+
+        ~ScopedOp()
+        { local_recorder().op(msg_, op_, elapsed_ns(start_)); }
+
+        ScopedOp(const ScopedOp &) = delete;
+
+        ScopedOp &operator=(const ScopedOp &) = delete;
+
+        void set_op(Op op) noexcept
+        { op_ = op; }
+
+    private:
+        Msg msg_;
+        Op op_;
+        uint64_t start_;
+    };
+
+    /*!
+     * @brief 周期性输出全部线程合并后的直方图
+     *
+     * 每个周期输出该周期内的增量, 便于观察开盘等时段的尾延迟; 析构时输出全程累计.
+     * 未定义 OB_LATENCY 时不启动线程.
+    */
+    class LatencyReporter
+    {
+    public:
+        /*!
+         * @param interval_ms 输出周期, 0 表示只在结束时输出
+        */
+        explicit LatencyReporter(int64_t interval_ms = 10'000);
+
+        ~LatencyReporter();
+
+        LatencyReporter(const LatencyReporter &) = delete;
+
+        LatencyReporter &operator=(const LatencyReporter &) = delete;
+
+        /*!
+         * @brief 停止周期输出并输出全程累计
+        */
+        void stop();
+
+    private:
+        struct Snapshot;
+
+        void run();
+
+        void dump(const Snapshot &current, const Snapshot *previous, const char *title) const;
+
+        int64_t interval_ms_;
+        std::thread thread_;
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        bool stopped_{false};
+        std::unique_ptr<Snapshot> previous_;
+    };
+}
+
+#endif //ORDERBOOK_LATENCY_H
@@ -0,0 +1,69 @@
+//
+// Created by x2h1z on 2021/11/18.
+//
+
+#ifndef ORDERBOOK_PIPELINE_CONFIG_H
+#define ORDERBOOK_PIPELINE_CONFIG_H
+
+#include <string>
+#include <vector>
+
+#include "pipeline/wait_strategy.h"
+
+namespace x2h::pipeline
+{
+    /*!
+     * @brief 单个线程的绑核与等待方式
+    */
+    struct StageConfig
+    {
+        /* 绑定的 CPU, -1 表示不绑定 */
+        int cpu{-1};
+        WaitStrategy wait{WaitStrategy::SPIN_YIELD};
+    };
+
+    /*!
+     * @brief 流水线配置, 由 key = value 配置文件加载
+     *
+     *  reader.file     = /data/202109030705.dat
+     *  reader.cpu      = 1
+     *  reader.wait     = busy_spin | spin_yield | blocking
+     *  decoder.cpu     = 2
+     *  decoder.wait    = busy_spin
+     *  book.threads    = 2
+     *  book.cpus       = 3,4
+     *  book.wait       = busy_spin
+     *  book.max_books  = 0
+     *  book.compact_idle_ms = 0
+     *  sink.threads    = 1
+     *  sink.cpus       = 5
+     *  sink.wait       = blocking
+     *  sink.output     = - | none | /path/to/output
+     *  sink.levels     = 5
+     *  queue.capacity  = 65536
+     *  symbols         = 600111,000001
+    */
+    struct PipelineConfig
+    {
+        std::string dat_file;
+        /* 关注的股票, 为空表示全部 */
+        std::vector<std::string> symbols;
+        size_t queue_capacity{1 << 16};
+
+        StageConfig reader;
+        StageConfig decoder;
+        std::vector<StageConfig> books{StageConfig{}};
+        std::vector<StageConfig> sinks{StageConfig{}};
+
+        size_t max_books{0};
+        /* 超过该时长(行情时间)没有消息的 OrderBook 转为紧凑表示, 0 表示不压缩 */
+        int64_t compact_idle_ms{0};
+        /* "-" 输出到 stdout, "none" 不输出 */
+        std::string sink_output{"-"};
+        int sink_levels{5};
+
+        static PipelineConfig load(const std::string &file_path);
+    };
+}
+
+#endif //ORDERBOOK_PIPELINE_CONFIG_H
@@ -0,0 +1,159 @@
+//
+// Created by x2h1z on 2021/11/18.
+//
+
+#ifndef ORDERBOOK_PIPELINE_H
+#define ORDERBOOK_PIPELINE_H
+
+#include <atomic>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "containers/spsc_queue.h"
+#include "mdt/MDTDataType.h"
+#include "perf/latency.h"
+#include "pipeline/config.h"
+#include "pipeline/wait_strategy.h"
+#include "types.h"
+
+namespace x2h::pipeline
+{
+    /* 读取阶段转发的原始记录上限, 只转发逐笔委托/成交 */
+    inline constexpr size_t MAX_RECORD_LEN = 240;
+    inline constexpr int MAX_LEVELS = 10;
+
+    /*!
+     * @brief 读取线程 -> 解码线程: 原始 MDT 结构体
+    */
+    struct RawRecord
+    {
+        MsgType type;
+        uint32_t len;
+        /* 读取时刻的 TSC, 只在 OB_LATENCY 下写入 */
+        uint64_t tsc;
+        alignas(8) char data[MAX_RECORD_LEN];
+    };
+
+    /*!
+     * @brief OrderBook 线程 -> 输出线程: 更新后的盘口
+    */
+    struct BookUpdate
+    {
+        char ticker[20];
+        int64_t time_ns;
+        int64_t rec_time;
+        /* 更新完成时刻的 TSC, 只在 OB_LATENCY 下写入 */
+        uint64_t tsc;
+        /* 触发更新的逐笔类型 */
+        perf::Msg msg;
+        int32_t bid_count;
+        int32_t ask_count;
+        type::data::PriceLevel bids[MAX_LEVELS];
+        type::data::PriceLevel asks[MAX_LEVELS];
+    };
+
+    /*!
+     * @brief 输出端, 每个输出线程持有一个
+    */
+    class Sink
+    {
+    public:
+        virtual ~Sink() = default;
+
+        virtual void on_update(const BookUpdate &update) = 0;
+
+        virtual void flush()
+        {}
+    };
+
+    /*!
+     * @brief 以文本行输出盘口
+    */
+    class FileSink : public Sink
+    {
+    public:
+        explicit FileSink(const std::string &file_path);
+
+        ~FileSink() override;
+
+        void on_update(const BookUpdate &update) override;
+
+        void flush() override;
+
+    private:
+        std::FILE *file_;
+        bool owned_;
+    };
+
+    using SinkFactory = std::function<std::unique_ptr<Sink>(size_t index)>;
+
+    struct PipelineStats
+    {
+        std::atomic<uint64_t> records{0};
+        std::atomic<uint64_t> events{0};
+        std::atomic<uint64_t> applied{0};
+        std::atomic<uint64_t> published{0};
+    };
+
+    /*!
+     * @brief 读取 -> 解码 -> OrderBook -> 输出 多线程流水线
+     *
+     * 各阶段独立线程, 按配置绑核, 阶段间以 SpscQueue 连接.
+     * 解码线程按股票代码把事件分发到固定的 OrderBook 线程, 保证单个 OrderBook 内的顺序.
+    */
+    class Pipeline
+    {
+    public:
+        explicit Pipeline(PipelineConfig config);
+
+        ~Pipeline();
+
+        Pipeline(const Pipeline &) = delete;
+
+        Pipeline &operator=(const Pipeline &) = delete;
+
+        /*!
+         * @brief 自定义输出端, 默认为 FileSink
+        */
+        void set_sink_factory(SinkFactory factory)
+        { sink_factory_ = std::move(factory); }
+
+        /*!
+         * @brief 运行到文件读取完毕且所有阶段排空
+        */
+        void run();
+
+        const PipelineStats &stats() const noexcept
+        { return stats_; }
+
+    private:
+        void read_stage();
+
+        void decode_stage();
+
+        void book_stage(size_t index);
+
+        void sink_stage(size_t index);
+
+        std::thread spawn(const char *name, const StageConfig &stage, std::function<void()> fn);
+
+        PipelineConfig config_;
+        SinkFactory sink_factory_;
+        PipelineStats stats_;
+
+        SpscQueue<RawRecord> raw_queue_;
+        Waiter decoder_waiter_;
+
+        std::vector<std::unique_ptr<SpscQueue<type::data::Event>>> event_queues_;
+        std::vector<std::unique_ptr<Waiter>> book_waiters_;
+
+        /* 每个 OrderBook 线程一个输出队列 */
+        std::vector<std::unique_ptr<SpscQueue<BookUpdate>>> update_queues_;
+        std::vector<std::unique_ptr<Waiter>> sink_waiters_;
+    };
+}
+
+#endif //ORDERBOOK_PIPELINE_H
@@ -0,0 +1,123 @@
+//
+// Created by x2h1z on 2021/11/18.
+//
+
+#ifndef ORDERBOOK_WAIT_STRATEGY_H
+#define ORDERBOOK_WAIT_STRATEGY_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace x2h::pipeline
+{
+    enum class WaitStrategy : uint8_t
+    {
+        /* 忙等, 延迟最低, 独占一个核 */
+        BUSY_SPIN,
+        /* 自旋一段时间后让出 CPU */
+        SPIN_YIELD,
+        /* 自旋后阻塞, 由生产者唤醒 */
+        BLOCKING,
+    };
+
+    inline void cpu_relax() noexcept
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#else
+        std::this_thread::yield();
+#endif
+    }
+
+    inline WaitStrategy parse_wait_strategy(const std::string &name, WaitStrategy def = WaitStrategy::SPIN_YIELD)
+    {
+        if (name == "busy_spin") return WaitStrategy::BUSY_SPIN;
+        if (name == "spin_yield") return WaitStrategy::SPIN_YIELD;
+        if (name == "blocking") return WaitStrategy::BLOCKING;
+        return def;
+    }
+
+    inline const char *wait_strategy_name(WaitStrategy strategy) noexcept
+    {
+        switch (strategy) {
+            case WaitStrategy::BUSY_SPIN:
+                return "busy_spin";
+            case WaitStrategy::SPIN_YIELD:
+                return "spin_yield";
+            default:
+                return "blocking";
+        }
+    }
+
+    /*!
+     * @brief 消费者一侧的等待器, 同一个消费者的所有上游队列共享一个
+    */
+    class Waiter
+    {
+    public:
+        static constexpr int SPIN_LIMIT = 1 << 10;
+
+        explicit Waiter(WaitStrategy strategy = WaitStrategy::SPIN_YIELD) noexcept
+                : strategy_(strategy)
+        {}
+
+        WaitStrategy strategy() const noexcept
+        { return strategy_; }
+
+        /*!
+         * @brief 等待直到 ready() 为真
+        */
+        template<typename Ready>
+        void wait(Ready &&ready) noexcept
+        {
+            for (int i = 0; !ready(); ++i) {
+                if (strategy_ == WaitStrategy::BUSY_SPIN || i < SPIN_LIMIT) {
+                    cpu_relax();
+                } else if (strategy_ == WaitStrategy::SPIN_YIELD) {
+                    std::this_thread::yield();
+                } else {
+                    //! 先置位再读序号, 与 notify 的先改序号再读标记配对, 不会丢失唤醒
+                    sleeping_.store(true, std::memory_order_seq_cst);
+                    uint32_t seq = seq_.load(std::memory_order_seq_cst);
+                    if (!ready()) seq_.wait(seq, std::memory_order_seq_cst);
+                    sleeping_.store(false, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /*!
+         * @brief 生产者写入数据后调用
+        */
+        void notify() noexcept
+        {
+            if (strategy_ != WaitStrategy::BLOCKING) return;
+            seq_.fetch_add(1, std::memory_order_seq_cst);
+            if (sleeping_.load(std::memory_order_seq_cst)) seq_.notify_all();
+        }
+
+    private:
+        WaitStrategy strategy_;
+        alignas(64) std::atomic<uint32_t> seq_{0};
+        std::atomic<bool> sleeping_{false};
+    };
+
+    /*!
+     * @brief 生产者在下游队列满时的退避
+    */
+    inline void backoff(WaitStrategy strategy, int &spins) noexcept
+    {
+        if (strategy == WaitStrategy::BUSY_SPIN || ++spins < Waiter::SPIN_LIMIT) {
+            cpu_relax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+#endif //ORDERBOOK_WAIT_STRATEGY_H
@@ -0,0 +1,79 @@
+//
+// Created by x2h1z on 2021/11/24.
+//
+
+#ifndef ORDERBOOK_BATCH_RUNNER_H
+#define ORDERBOOK_BATCH_RUNNER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace x2h::replay
+{
+    /*!
+     * @brief 多日回测配置, 由 key = value 配置文件加载
+     *
+     *  batch.dir           = /data/dat
+     *  batch.from          = 20210901
+     *  batch.to            = 20210930
+     *  batch.threads       = 16
+     *  batch.cpus          = 0,1,2
+     *  batch.max_mappings  = 8
+     *  batch.max_books     = 5000
+     *  batch.output        = /data/result
+     *  symbols             = 600111,000001
+    */
+    struct BatchConfig
+    {
+        std::string dir;
+        /* 日期范围 YYYYMMDD, 0 表示不限 */
+        int64_t from_date{0};
+        int64_t to_date{0};
+
+        size_t threads{1};
+        std::vector<int> cpus;
+        /* 同时映射的文件数上限 */
+        size_t max_mappings{4};
+        /* 每天最多维护的 OrderBook 数, 0 表示不限 */
+        size_t max_books{0};
+        /* 每天一个结果文件 */
+        std::string output_dir{"."};
+        int levels{5};
+        std::vector<std::string> symbols;
+
+        static BatchConfig load(const std::string &file_path);
+    };
+
+    struct DayFile
+    {
+        int64_t date;
+        std::string path;
+    };
+
+    /*!
+     * @brief 并行处理目录下多天的 .dat 文件, 每天独立重建 OrderBook 并输出到单独的文件
+    */
+    class BatchRunner
+    {
+    public:
+        explicit BatchRunner(BatchConfig config);
+
+        /*!
+         * @brief 按文件名中的日期(YYYYMMDD 开头)筛选并排序
+        */
+        std::vector<DayFile> list_files() const;
+
+        /*!
+         * @return 成功处理的文件数
+        */
+        size_t run();
+
+    private:
+        bool run_day(const DayFile &file) const;
+
+        BatchConfig config_;
+    };
+}
+
+#endif //ORDERBOOK_BATCH_RUNNER_H
@@ -0,0 +1,91 @@
+//
+// Created by x2h1z on 2021/11/26.
+//
+
+#ifndef ORDERBOOK_CHECKPOINT_H
+#define ORDERBOOK_CHECKPOINT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "book/book_set.h"
+
+namespace x2h::replay
+{
+    /*!
+     * @brief 存档文件头
+    */
+    struct CheckpointHeader
+    {
+        char magic[4];
+        uint32_t version;
+        /* 存档之后第一条未处理记录在 .dat 中的偏移 */
+        uint64_t offset;
+        /* 存档对应的市场时间, 当日纳秒数 */
+        int64_t time_ns;
+        /* 已处理的记录数 */
+        uint64_t records;
+    };
+
+    struct CheckpointInfo
+    {
+        std::string path;
+        int64_t time_ns;
+        uint64_t offset;
+    };
+
+    /*!
+     * @brief 周期性保存全部 OrderBook 状态, 并支持从最近的存档重放到任意时刻
+     *
+     * 存档文件名为 <dir>/<dat 文件名>.<HHMMSSmmm>.ckpt
+    */
+    class Checkpointer
+    {
+    public:
+        /*!
+         * @param interval_ns 存档间隔(市场时间)
+        */
+        Checkpointer(std::string dat_file, std::string dir, int64_t interval_ns);
+
+        /*!
+         * @brief 完整重放 .dat 并按间隔写出存档
+         * @return 写出的存档数
+        */
+        size_t run();
+
+        /*!
+         * @brief 列出该 .dat 的所有存档, 按时间升序
+        */
+        std::vector<CheckpointInfo> list() const;
+
+        /*!
+         * @brief 载入 time_ns 之前最近的存档, 只重放其后的部分, 在第一条晚于 time_ns 的事件前停止
+         * @return 是否找到存档; 未找到时从头重放
+        */
+        bool seek(int64_t time_ns, book::BookSet &books) const;
+
+        /*!
+         * @brief 为新订阅的股票重建 OrderBook
+         *
+         * 载入 end_offset 之前最近的存档, 取出这些股票的 OrderBook, 再只重放它们在存档之后、
+         * end_offset 之前的记录. 没有可用存档时从文件开头重放.
+         * @param end_offset 第一条尚未处理的记录的偏移
+         * @return 是否使用了存档
+        */
+        bool bootstrap(const std::vector<std::string> &symbols, size_t end_offset, book::BookSet &books) const;
+
+        static bool write(const std::string &path, const book::BookSet &books, const CheckpointHeader &header);
+
+        static bool read(const std::string &path, book::BookSet &books, CheckpointHeader &header);
+
+    private:
+        std::string checkpoint_path(int64_t time_ns) const;
+
+        std::string dat_file_;
+        std::string dir_;
+        int64_t interval_ns_;
+    };
+}
+
+#endif //ORDERBOOK_CHECKPOINT_H
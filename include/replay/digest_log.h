@@ -0,0 +1,92 @@
+//
+// Created by x2h1z on 2021/12/14.
+//
+
+#ifndef ORDERBOOK_DIGEST_LOG_H
+#define ORDERBOOK_DIGEST_LOG_H
+
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <string>
+
+#include "book/book_set.h"
+
+namespace x2h::replay
+{
+    /*!
+     * @brief 摘要文件头, 之后是连续的 DigestRecord
+    */
+    struct DigestHeader
+    {
+        char magic[4];
+        uint32_t version;
+        /* 每 every_events 个事件写一条, 0 表示不按事件数 */
+        uint64_t every_events;
+        /* 市场时间每跨过 every_ns 写一条, 0 表示不按时间 */
+        int64_t every_ns;
+        /* 只记录序号在 [begin, end) 内的事件 */
+        uint64_t begin;
+        uint64_t end;
+    };
+
+    struct DigestRecord
+    {
+        /* 事件序号, 从 1 开始 */
+        uint64_t event;
+        /* 该事件的市场时间, 当日纳秒数 */
+        int64_t time_ns;
+        uint64_t digest;
+    };
+
+    /*!
+     * @brief 按事件数或市场时间周期性写出全部 OrderBook 的摘要
+     *
+     * 每个事件之后调用 on_event, 到达间隔时才合并摘要; 结束时调用 finish 补写最后一个事件.
+    */
+    class DigestWriter
+    {
+    public:
+        DigestWriter(const std::string &path, uint64_t every_events, int64_t every_ns,
+                     uint64_t begin = 0, uint64_t end = std::numeric_limits<uint64_t>::max());
+
+        ~DigestWriter();
+
+        DigestWriter(const DigestWriter &) = delete;
+
+        DigestWriter &operator=(const DigestWriter &) = delete;
+
+        explicit operator bool() const noexcept
+        { return file_ != nullptr; }
+
+        void on_event(int64_t time_ns, const book::BookSet &books);
+
+        void finish(const book::BookSet &books);
+
+        uint64_t records() const noexcept
+        { return records_; }
+
+    private:
+        void write(int64_t time_ns, const book::BookSet &books);
+
+        std::FILE *file_{nullptr};
+        DigestHeader header_{};
+        uint64_t events_{0};
+        uint64_t records_{0};
+        int64_t next_ns_{0};
+        /* 最后一个事件是否已写出 */
+        bool written_{true};
+        int64_t last_time_ns_{0};
+    };
+
+    /*!
+     * @brief 比较两个摘要文件, 二分查找第一条不一致的记录
+     *
+     * 假定盘口一旦分歧就不会再回到相同状态; 两个文件的间隔配置必须相同.
+     * 通过内存映射读取, 只访问二分路径上的记录.
+     * @return 0 一致, 1 不一致, -1 文件错误
+    */
+    int compare_digests(const std::string &a, const std::string &b);
+}
+
+#endif //ORDERBOOK_DIGEST_LOG_H
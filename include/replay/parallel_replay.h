@@ -0,0 +1,104 @@
+//
+// Created by x2h1z on 2021/11/22.
+//
+
+#ifndef ORDERBOOK_PARALLEL_REPLAY_H
+#define ORDERBOOK_PARALLEL_REPLAY_H
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "book/order_book.h"
+#include "containers/fast_hash.h"
+#include "replay/work_stealing_pool.h"
+#include "types.h"
+
+namespace x2h::replay
+{
+    struct ParallelReplayConfig
+    {
+        size_t threads{std::thread::hardware_concurrency()};
+        std::vector<int> cpus;
+        /* 每个批次的事件数 */
+        size_t batch_size{1024};
+        /* 已拆分但未处理的事件上限, 超出时读取线程等待 */
+        size_t max_buffered{1 << 22};
+        /* 单个任务最多连续处理的批次数, 之后重新入队让出 worker */
+        size_t batches_per_task{16};
+    };
+
+    /*!
+     * @brief 全市场并行重放
+     *
+     * 读取线程把 .dat 按股票拆分为事件批次, 每个股票同一时刻只有一个任务在工作窃取线程池中运行,
+     * 保证单个 OrderBook 的事件顺序, 同时让活跃股票与冷门股票在各核之间自动均衡.
+    */
+    class ParallelReplay
+    {
+    public:
+        explicit ParallelReplay(ParallelReplayConfig config = {});
+
+        ~ParallelReplay();
+
+        /*!
+         * @brief 重放一个 .dat 文件, 返回时所有事件已应用
+        */
+        void run(const std::string &dat_file);
+
+        /*!
+         * @brief 由调用方逐条喂入事件(读取线程), 最后调用 finish
+        */
+        void feed(const type::data::Event &event);
+
+        void finish();
+
+        size_t book_count() const noexcept
+        { return streams_.size(); }
+
+        const book::OrderBook *find(const char *ticker) const noexcept;
+
+        template<typename Fn>
+        void for_each_book(Fn &&fn) const
+        {
+            for (const auto &[key, stream]: streams_) fn(*stream->book);
+        }
+
+        uint64_t events() const noexcept
+        { return events_; }
+
+        const WorkStealingPool &pool() const noexcept
+        { return pool_; }
+
+    private:
+        struct SymbolStream
+        {
+            std::unique_ptr<book::OrderBook> book;
+            ParallelReplay *owner;
+
+            /* 仅读取线程访问 */
+            std::vector<type::data::Event> pending;
+
+            std::mutex mutex;
+            std::deque<std::vector<type::data::Event>> batches;
+            bool scheduled{false};
+        };
+
+        static void run_stream(void *arg);
+
+        void flush(SymbolStream &stream);
+
+        ParallelReplayConfig config_;
+        WorkStealingPool pool_;
+        std::unordered_map<uint64_t, std::unique_ptr<SymbolStream>, FastHash> streams_;
+        std::atomic<size_t> buffered_{0};
+        uint64_t events_{0};
+        int next_id_{1};
+    };
+}
+
+#endif //ORDERBOOK_PARALLEL_REPLAY_H
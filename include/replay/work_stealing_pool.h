@@ -0,0 +1,101 @@
+//
+// Created by x2h1z on 2021/11/22.
+//
+
+#ifndef ORDERBOOK_WORK_STEALING_POOL_H
+#define ORDERBOOK_WORK_STEALING_POOL_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace x2h::replay
+{
+    /*!
+     * @brief 任务: 函数指针 + 参数, 避免 std::function 的分配
+    */
+    struct Task
+    {
+        void (*fn)(void *arg);
+        void *arg;
+    };
+
+    struct WorkerStats
+    {
+        uint64_t executed{0};
+        uint64_t stolen{0};
+    };
+
+    /*!
+     * @brief 工作窃取线程池
+     *
+     * 每个 worker 持有一个双端队列, 自己从尾部取(LIFO, 缓存友好), 空闲时从其它 worker 的头部窃取.
+     * 外部线程提交的任务轮流放入各 worker 的队列.
+    */
+    class WorkStealingPool
+    {
+    public:
+        /*!
+         * @param threads worker 数量
+         * @param cpus worker 绑定的 CPU, 不足的部分不绑定
+        */
+        explicit WorkStealingPool(size_t threads, const std::vector<int> &cpus = {});
+
+        ~WorkStealingPool();
+
+        WorkStealingPool(const WorkStealingPool &) = delete;
+
+        WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+        /*!
+         * @brief 提交任务. 在 worker 线程内调用时放入本地队列
+        */
+        void submit(Task task);
+
+        /*!
+         * @brief 让出: 放入队列头部, 本 worker 先执行队列中已有的任务再轮到它; 同时也是最先被窃取的位置
+        */
+        void yield(Task task);
+
+        /*!
+         * @brief 阻塞直到所有已提交任务执行完毕
+        */
+        void wait_idle();
+
+        size_t size() const noexcept
+        { return workers_.size(); }
+
+        std::vector<WorkerStats> stats() const;
+
+    private:
+        struct Worker
+        {
+            alignas(64) std::atomic_flag lock = ATOMIC_FLAG_INIT;
+            std::deque<Task> tasks;
+            WorkerStats stats;
+        };
+
+        void push(Task task, bool front);
+
+        void run(size_t index);
+
+        bool pop_local(Worker &worker, Task &task);
+
+        bool steal(size_t thief, Task &task);
+
+        std::vector<std::unique_ptr<Worker>> workers_;
+        std::vector<std::thread> threads_;
+
+        std::atomic<bool> running_{true};
+        std::atomic<uint64_t> pending_{0};
+        std::atomic<uint64_t> next_{0};
+        /* 空闲 worker 在 epoch_ 上阻塞 */
+        std::atomic<uint32_t> epoch_{0};
+        std::atomic<uint32_t> sleepers_{0};
+    };
+}
+
+#endif //ORDERBOOK_WORK_STEALING_POOL_H
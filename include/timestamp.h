@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstdint>
+
+namespace x2h::util
+{
+    /* 一天的纳秒数 */
+    inline constexpr int64_t DAY_NS = 86'400'000'000'000;
+
+    /* 北京时间相对 UTC 的偏移 */
+    inline constexpr int64_t CST_OFFSET_NS = 8 * 3'600'000'000'000;
+
+    namespace detail
+    {
+        /*!
+         * @brief 十进制时间编码中的一个字段: (t / divisor % modulus) * unit_ns, 取值范围 [0, range)
+        */
+        struct TimeField
+        {
+            int64_t divisor;
+            int64_t modulus;
+            int64_t unit_ns;
+            int64_t range;
+        };
+
+        /* HHMMSSmmm: 时, 分, 秒, 毫秒 */
+        inline constexpr TimeField HHMMSSMMM_FIELDS[] = {
+                {10'000'000, 100,   3'600'000'000'000, 24},
+                {100'000,    100,   60'000'000'000,    60},
+                {1'000,      100,   1'000'000'000,     60},
+                {1,          1'000, 1'000'000,         1'000},
+        };
+
+        /* YYYYMMDD: 年, 月, 日 */
+        inline constexpr TimeField YYYYMMDD_FIELDS[] = {
+                {10'000, 10'000, 1, 10'000},
+                {100,    100,    1, 13},
+                {1,      100,    1, 32},
+        };
+
+        /*!
+         * @brief Howard Hinnant 的 days_from_civil, 返回距 1970-01-01 的天数
+        */
+        constexpr int64_t days_from_civil(int64_t y, int64_t m, int64_t d) noexcept
+        {
+            y -= m <= 2;
+            const int64_t era = (y >= 0 ? y : y - 399) / 400;
+            const int64_t yoe = y - era * 400;
+            const int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+            const int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+            return era * 146097 + doe - 719468;
+        }
+    }
+
+    /*!
+     * @brief 上证 HHMMSSmmm 格式时间转换为当日纳秒数
+     * @param t 如 143025001 表示 14:30:25.001
+     * @return 距当日零点的纳秒数
+    */
+    constexpr int64_t hhmmssmmm_to_ns(int64_t t) noexcept
+    {
+        int64_t ns = 0;
+        for (const auto &field: detail::HHMMSSMMM_FIELDS) {
+            ns += t / field.divisor % field.modulus * field.unit_ns;
+        }
+        return ns;
+    }
+
+    /*!
+     * @brief 深证 YYYYMMDDHHMMSSmmm 格式时间转换为当日纳秒数
+     * @return 距当日零点的纳秒数
+    */
+    constexpr int64_t yyyymmddhhmmssmmm_to_ns(int64_t t) noexcept
+    {
+        return hhmmssmmm_to_ns(t % 1'000'000'000);
+    }
+
+    /*!
+     * @brief 深证 YYYYMMDDHHMMSSmmm 格式时间转换为 unix 纳秒时间
+     * @param t 交易所本地时间
+     * @param utc_offset_ns 交易所时区偏移, 默认北京时间
+    */
+    constexpr int64_t yyyymmddhhmmssmmm_to_epoch_ns(int64_t t, int64_t utc_offset_ns = CST_OFFSET_NS) noexcept
+    {
+        const int64_t date = t / 1'000'000'000;
+        int64_t ymd[3]{};
+        for (int i = 0; i < 3; ++i) {
+            const auto &field = detail::YYYYMMDD_FIELDS[i];
+            ymd[i] = date / field.divisor % field.modulus;
+        }
+        return detail::days_from_civil(ymd[0], ymd[1], ymd[2]) * DAY_NS + yyyymmddhhmmssmmm_to_ns(t) - utc_offset_ns;
+    }
+
+    /*!
+     * @brief MDTTime(unix 微秒) 转换为交易所本地当日纳秒数
+    */
+    constexpr int64_t mdt_time_to_ns(uint64_t mdt_time, int64_t utc_offset_ns = CST_OFFSET_NS) noexcept
+    {
+        return (static_cast<int64_t>(mdt_time) * 1'000 + utc_offset_ns) % DAY_NS;
+    }
+
+    /*!
+     * @brief 当日纳秒数转换回 HHMMSSmmm
+    */
+    constexpr int64_t ns_to_hhmmssmmm(int64_t ns) noexcept
+    {
+        int64_t t = 0;
+        for (const auto &field: detail::HHMMSSMMM_FIELDS) {
+            t += ns / field.unit_ns % field.range * field.divisor;
+        }
+        return t;
+    }
+
+    /* 连续竞价开始时间 09:30:00.000 */
+    inline constexpr int64_t CONTINUOUS_TRADING_NS = hhmmssmmm_to_ns(9'30'00'000);
+
+    static_assert(hhmmssmmm_to_ns(14'30'25'001) == ((14 * 60 + 30) * 60 + 25) * 1'000'000'000LL + 1'000'000);
+    static_assert(yyyymmddhhmmssmmm_to_ns(20210903'09'30'00'000) == CONTINUOUS_TRADING_NS);
+    static_assert(ns_to_hhmmssmmm(hhmmssmmm_to_ns(14'30'25'001)) == 14'30'25'001);
+    static_assert(yyyymmddhhmmssmmm_to_epoch_ns(19700101'08'00'00'000) == 0);
+    static_assert(yyyymmddhhmmssmmm_to_epoch_ns(20210903'09'30'00'000) == 1'630'632'600'000'000'000);
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <list>
 
 namespace x2h::type::data
@@ -18,6 +19,8 @@ namespace x2h::type::data
         int64_t rec_time;
         /* 下单时间 */
         int64_t time;
+        /* 下单时间, 当日纳秒数(解码时由 time 归一化) */
+        int64_t time_ns;
         /* 频道代码 */
         int32_t channel_no;
         /* 委托序号 */
@@ -70,6 +73,8 @@ namespace x2h::type::data
         int64_t rec_time;
         /* 成交时间 */
         int64_t time;
+        /* 成交时间, 当日纳秒数(解码时由 time 归一化) */
+        int64_t time_ns;
         /* 频道代码 */
         int32_t channel_id;
         /* 委托序号 */
@@ -101,6 +106,57 @@ namespace x2h::type::data
         }
     };
 
+    /*!
+     * @brief 一档价位的聚合量
+    */
+    struct PriceLevel
+    {
+        double price;
+        int64_t qty;
+    };
+
+    enum class EventType : uint8_t
+    {
+        ORDER,
+        TRADE
+    };
+
+    /*!
+     * @brief 解码后的逐笔事件
+    */
+    struct Event
+    {
+        EventType type;
+        union
+        {
+            Order order;
+            Trade trade;
+        };
+
+        /* 股票代码 */
+        [[nodiscard]] const char *ticker() const noexcept
+        {
+            return type == EventType::ORDER ? order.ticker : trade.ticker;
+        }
+
+        [[nodiscard]] Exchange exchange() const noexcept
+        {
+            return type == EventType::ORDER ? order.exchange : trade.exchange;
+        }
+
+        /* 当日纳秒时间 */
+        [[nodiscard]] int64_t time_ns() const noexcept
+        {
+            return type == EventType::ORDER ? order.time_ns : trade.time_ns;
+        }
+
+        /* 消息接收时间(MDTTime) */
+        [[nodiscard]] int64_t rec_time() const noexcept
+        {
+            return type == EventType::ORDER ? order.rec_time : trade.rec_time;
+        }
+    };
+
     namespace sh
     {
         enum class OrderSide : char
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <ctime>
+#include <cstdio>
 #include <string>
 #include <random>
 #include <climits>
@@ -12,15 +13,6 @@
 
 #include "fmt/format.h"
 
-#ifdef __APPLE__
-#include "spdlog/spdlog.h"
-#include "spdlog/async.h"
-#include "spdlog/sinks/stdout_color_sinks.h"
-#include "spdlog/sinks/rotating_file_sink.h"
-#else
-
-#endif
-
 #define MILLISECONDS 1'00'00'00'000
 #define MICROSECONDS 1'00'00'00'000'000
 #define NANOSECONDS 1'00'00'00'000'000'000
@@ -31,7 +23,7 @@ namespace x2h
 {
     namespace log
     {
-
+        /* 日志输出见 log/logger.h */
         enum Level : uint8_t
         {
             DBG = 0,
@@ -108,6 +100,65 @@ namespace x2h
             return list_;
         }
 
+        inline std::string trim(const std::string &str)
+        {
+            auto start = str.find_first_not_of(" \t\r\n");
+            if (start == std::string::npos) return {};
+            auto end = str.find_last_not_of(" \t\r\n");
+            return str.substr(start, end - start + 1);
+        }
+
+        /*!
+         * @brief 读取 key = value 格式的配置文件, '#' 之后为注释
+         * @param fp 配置文件路径
+         * @return key -> value
+        */
+        inline std::unordered_map<std::string, std::string>
+        read_config(const std::string &fp)
+        {
+            std::unordered_map<std::string, std::string> config{};
+            std::ifstream is(fp);
+
+            if (!is.is_open()) {
+                auto msg = fmt::format("文件 {} 打开失败", fp);
+                fmt::print("{}\n", msg);
+                return config;
+            }
+
+            std::string line;
+            while (std::getline(is, line)) {
+                auto comment = line.find('#');
+                if (comment != std::string::npos) line.erase(comment);
+
+                auto eq = line.find('=');
+                if (eq == std::string::npos) continue;
+
+                auto key = trim(line.substr(0, eq));
+                if (!key.empty()) {
+                    config[key] = trim(line.substr(eq + 1));
+                }
+            }
+
+            return config;
+        }
+
+        /*!
+         * @brief 解析逗号分隔的列表
+        */
+        inline std::vector<std::string> split(const std::string &str, const char delim = ',')
+        {
+            std::vector<std::string> out;
+            size_t start = 0;
+            while (start <= str.size()) {
+                auto end = str.find(delim, start);
+                if (end == std::string::npos) end = str.size();
+                auto item = trim(str.substr(start, end - start));
+                if (!item.empty()) out.push_back(std::move(item));
+                start = end + 1;
+            }
+            return out;
+        }
+
         template<typename T>
         inline int64_t file_last_write_time(const std::string &file_path)
         {
@@ -412,5 +463,22 @@ namespace x2h
             return status;
         }
 
+        /*!
+         * @brief 以二进制形式写入可平凡复制的对象
+        */
+        template<typename T>
+        inline bool write_pod(std::FILE *file, const T &value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            return std::fwrite(&value, sizeof(T), 1, file) == 1;
+        }
+
+        template<typename T>
+        inline bool read_pod(std::FILE *file, T &value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            return std::fread(&value, sizeof(T), 1, file) == 1;
+        }
+
     }
 }
@@ -1,10 +1,31 @@
+#include <chrono>
 #include <iostream>
 #include <memory>
 #include <ranges>
 
+#include "analytics/flow.h"
+#include "archive/archive.h"
+#include "book/book_set.h"
+#include "book/diff.h"
+#include "book/level_book.h"
 #include "book/order_book.h"
+#include "book/resync.h"
+#include "book/verifier.h"
+#include "dat/decode.h"
+#include "dat/generator.h"
+#include "dat/merge_reader.h"
 #include "dat/reader.h"
 #include "mdt/MDTStruct.h"
+#include "net/udp_feed.h"
+#include "perf/alloc.h"
+#include "perf/counters.h"
+#include "perf/latency.h"
+#include "log/logger.h"
+#include "pipeline/pipeline.h"
+#include "replay/batch_runner.h"
+#include "replay/checkpoint.h"
+#include "replay/digest_log.h"
+#include "replay/parallel_replay.h"
 #include "fmt/format.h"
 #include "types.h"
 #include "utils.h"
@@ -18,17 +39,21 @@ public:
 
     void process(const std::shared_ptr<Item> &item);
 
+    void on(const SSEL2_Order &src);
+
+    void on(const SSEL2_Transaction &src);
+
+    void on(const SSEL2_Quotation &snapshot);
+
 private:
     std::shared_ptr<x2h::book::OrderBook> book_ptr_;
     int64_t last_msg_time_{};
 
-    void process_sse_order(SSEL2_Order *order_ptr);
-
-    void process_sse_trade(SSEL2_Transaction *trade_ptr);
-
     void print_order_book() const;
 };
 
+static void print_order_book(const x2h::book::OrderBook &book, int64_t last_msg_time);
+
 A::A()
 {
     Symbol symbol{1, TARGET.c_str(), x2h::type::data::Exchange::SH};
@@ -36,11 +61,16 @@ A::A()
 }
 
 inline void A::print_order_book() const
+{
+    ::print_order_book(*book_ptr_, last_msg_time_);
+}
+
+static void print_order_book(const x2h::book::OrderBook &book, int64_t last_msg_time)
 {
     std::string msg;
 
-    auto ask = book_ptr_->get_ask_book();
-    auto bid = book_ptr_->get_bid_book();
+    auto ask = book.get_ask_book();
+    auto bid = book.get_bid_book();
 
     fmt::print("bid1:{}, asks:{}\n", bid.size(), ask.size());
     std::vector<std::string> ask_msgs;
@@ -60,7 +90,7 @@ inline void A::print_order_book() const
     }
 
     i = 0;
-    msg += fmt::format("-------{}--------\n", last_msg_time_);
+    msg += fmt::format("-------{}--------\n", last_msg_time);
 
     for (const auto &item: bid) {
         if (i >= 10) break;
@@ -74,180 +104,616 @@ inline void A::print_order_book() const
     fmt::print("{}\n", msg);
 }
 
-inline void A::process_sse_order(SSEL2_Order *order_ptr)
+inline void A::on(const SSEL2_Order &src)
 {
-    std::string symbol(order_ptr->Symbol);
-    if (symbol != TARGET) return;
-
 #if 0
     auto msg = fmt::format(
             FMT_STRING("[Order] Symbol:{0}, Time:{1}, RecTime:{2}, Side:{3}, Type:{4}, OrderID:{5:^8}, RecNo:{6:^8}, Price:{7:^7}, Quantity:{8:^7}"),
-            order_ptr->Symbol, order_ptr->Time,
-            x2h::util::convert_ts_to_time((int64_t)order_ptr->MDTTime, x2h::util::Microseconds()),
-            order_ptr->OrderCode, order_ptr->OrderType, order_ptr->RecID,
-            order_ptr->RecNO, order_ptr->OrderPrice, order_ptr->Balance);
+            src.Symbol, src.Time,
+            x2h::util::convert_ts_to_time((int64_t)src.MDTTime, x2h::util::Microseconds()),
+            src.OrderCode, src.OrderType, src.RecID,
+            src.RecNO, src.OrderPrice, src.Balance);
     fmt::print("{}\n", msg);
 #endif
 
+    X2H_LATENCY(uint64_t start = x2h::perf::rdtsc();)
     x2h::type::data::Order order{};
-    strcpy(order.ticker, order_ptr->Symbol);
-    order.rec_time = static_cast<int64_t>(order_ptr->MDTTime);
-    order.time = order_ptr->Time;
-    order.channel_no = order_ptr->SetID;
-    order.order_id = order_ptr->RecID;
-    order.origin_order_id = order_ptr->OrderID;
-    order.price = order_ptr->OrderPrice;
-    order.qty = static_cast<int64_t>(order_ptr->Balance);
-    order.side = *order_ptr->OrderCode;
-    order.ord_type = order_ptr->OrderType;
-    order.business_no = order_ptr->RecNO;
+    x2h::dat::decode(src, order);
+    X2H_LATENCY(auto &recorder = x2h::perf::local_recorder();
+                recorder.stage(x2h::perf::Msg::SH_ORDER, x2h::perf::Stage::DECODE, x2h::perf::elapsed_ns(start));
+                start = x2h::perf::rdtsc();)
 
     last_msg_time_ = order.time;
     book_ptr_->on_order(order);
+    X2H_LATENCY(recorder.stage(x2h::perf::Msg::SH_ORDER, x2h::perf::Stage::APPLY, x2h::perf::elapsed_ns(start));)
 
-    if (order.time % MILLISECONDS >= 9'30'00'000) {
+    if (order.time_ns >= x2h::util::CONTINUOUS_TRADING_NS) {
 //        print_order_book();
     }
 #if 0
     auto msg = fmt::format(FMT_STRING("[Order] Time:{},Symbol:{},OrderID:{},Side:{},Price:{},Qty:{}"),
-                           order_ptr->Time, order_ptr->Symbol, order_ptr->OrderID, order_ptr->OrderType,
-                           order_ptr->OrderPrice, order_ptr->Balance);
+                           src.Time, src.Symbol, src.OrderID, src.OrderType,
+                           src.OrderPrice, src.Balance);
     fmt::print("{}\n", msg);
 #endif
 }
 
-inline void A::process_sse_trade(SSEL2_Transaction *trade_ptr)
+inline void A::on(const SSEL2_Transaction &src)
 {
-    std::string symbol(trade_ptr->Symbol);
-    if (symbol != TARGET) return;
-
 #if 0
     auto msg = fmt::format(FMT_STRING(
                                    "[Trade] Symbol:{0}, Time:{1}, RecTime:{2}, BuySell:{3}, BuyOrderID:{4:^10}, "
                                    "SellOrderID:{5:^10}, Price:{6:^5}, Quantity:{7:^8}, Amount:{8:^10}, RecID:{9:^7}, "
                                    "RecNo:{10:^7}"),
-                           trade_ptr->Symbol, trade_ptr->TradeTime,
-                           x2h::util::convert_ts_to_time((int64_t)trade_ptr->MDTTime, x2h::util::Microseconds()),
-                           trade_ptr->BuySellFlag, trade_ptr->BuyRecID,
-                           trade_ptr->SellRecID, trade_ptr->TradePrice, trade_ptr->TradeVolume, trade_ptr->TradeAmount,
-                           trade_ptr->RecID, trade_ptr->RecNO);
+                           src.Symbol, src.TradeTime,
+                           x2h::util::convert_ts_to_time((int64_t)src.MDTTime, x2h::util::Microseconds()),
+                           src.BuySellFlag, src.BuyRecID,
+                           src.SellRecID, src.TradePrice, src.TradeVolume, src.TradeAmount,
+                           src.RecID, src.RecNO);
     fmt::print("{}\n", msg);
 #endif
 
+    X2H_LATENCY(uint64_t start = x2h::perf::rdtsc();)
     x2h::type::data::Trade trade{};
-    strcpy(trade.ticker, trade_ptr->Symbol);
-    trade.rec_time = static_cast<int64_t>(trade_ptr->MDTTime);
-    trade.time = trade_ptr->TradeTime;
-    trade.channel_id = trade_ptr->TradeChannel;
-    trade.ask_id = trade_ptr->SellRecID;
-    trade.bid_id = trade_ptr->BuyRecID;
-    trade.memory = trade_ptr->TradeAmount;
-    trade.price = trade_ptr->TradePrice;
-    trade.qty = static_cast<int64_t>(trade_ptr->TradeVolume);
-    trade.trade_flag = trade_ptr->BuySellFlag;
-    trade.trade_id = trade_ptr->RecID;
-    trade.business_no = trade_ptr->RecNO;
+    x2h::dat::decode(src, trade);
+    X2H_LATENCY(auto &recorder = x2h::perf::local_recorder();
+                recorder.stage(x2h::perf::Msg::SH_TRADE, x2h::perf::Stage::DECODE, x2h::perf::elapsed_ns(start));
+                start = x2h::perf::rdtsc();)
 
     last_msg_time_ = trade.time;
     book_ptr_->on_trade(trade);
+    X2H_LATENCY(recorder.stage(x2h::perf::Msg::SH_TRADE, x2h::perf::Stage::APPLY, x2h::perf::elapsed_ns(start));)
 
-    if (trade.time % MILLISECONDS >= 9'30'00'000) {
+    if (trade.time_ns >= x2h::util::CONTINUOUS_TRADING_NS) {
          print_order_book();
     }
 #if 0
     auto msg = fmt::format(FMT_STRING("[Trader] Time:{},Symbol:{},TradeID:{},AskNo:{},BidNo:{},Price:{},Qty:{}"),
-                           trade_ptr->TradeTime, trade_ptr->Symbol, trade_ptr->RecID, trade_ptr->SellRecID,
-                           trade_ptr->BuyRecID, trade_ptr->TradePrice, trade_ptr->TradeVolume);
+                           src.TradeTime, src.Symbol, src.RecID, src.SellRecID,
+                           src.BuyRecID, src.TradePrice, src.TradeVolume);
     fmt::print("{}\n", msg);
 #endif
 }
 
+inline void A::on(const SSEL2_Quotation &snapshot)
+{
+    std::string symbol_code{snapshot.Symbol};
+    if (x2h::util::hhmmssmmm_to_ns(snapshot.Time) < x2h::util::CONTINUOUS_TRADING_NS) return;
+    if (snapshot.SellLevelNo == 0 && snapshot.BuyLevelNo == 0) {
+        return;
+    }
+    std::string msg;
+    if (snapshot.SellLevelNo > 0) {
+        for (const auto &elem: std::ranges::reverse_view(snapshot.SellLevel)) {
+            msg += fmt::format("{0:^} | ask | {1:^7} | {2}\n", symbol_code, elem.Price, elem.Volume);
+        }
+    }
+
+    msg += fmt::format("------------------{}----------------\n", snapshot.Time);
+
+    if (snapshot.BuyLevelNo > 0) {
+        for (const auto &elem: snapshot.BuyLevel) {
+            msg += fmt::format("{0:^} | bid | {1:^7} | {2}\n", symbol_code, elem.Price, elem.Volume);
+        }
+    }
+    fmt::print(">>>>>>>>>>>>>>>>>>\n{}<<<<<<<<<<<<<<<<<<<<\n\n", msg);
+}
+
 void A::process(const std::shared_ptr<Item> &item)
 {
-    switch (item->DataType) {
-        default:
-        case Msg_Unknown:
-            break;
-        case Msg_SSEL1_Static:
-            break;
-        case Msg_SSEL1_Quotation:
-            break;
-        case Msg_SSE_IndexPress:
-            break;
-        case Msg_SSEL2_Static:
-            break;
-        case Msg_SSEL2_Quotation: {
-            auto *sse_snapshot = reinterpret_cast<SSEL2_Quotation *>(item->Data);
-            std::string symbol_code{sse_snapshot->Symbol};
-            if (sse_snapshot->Time % MILLISECONDS < 9'30'00'000 || symbol_code !=  TARGET) break;
-            if (sse_snapshot->SellLevelNo == 0 && sse_snapshot->BuyLevelNo == 0) {
-                break;
+    //! 只登记了 on() 重载的三种消息, 其余类型查表后直接丢弃
+    x2h::dat::dispatch(*this, item->DataType, item->Data);
+}
+
+/*!
+ * @brief 逐笔重建全部股票的盘口, 收到十档快照时交给 Verifier 校验
+*/
+class Checker
+{
+public:
+    explicit Checker(x2h::book::Verifier &verifier)
+            : verifier_(verifier)
+    {}
+
+    void process(const std::shared_ptr<Item> &item);
+
+    void on(const SSEL2_Quotation &snapshot)
+    { check(snapshot, x2h::util::hhmmssmmm_to_ns(snapshot.Time)); }
+
+    void on(const SZSEL2_Quotation &snapshot)
+    { check(snapshot, x2h::util::yyyymmddhhmmssmmm_to_ns(snapshot.Time)); }
+
+    /*!
+     * @brief 收到快照时先校验再校正, 校验结果反映上一个快照间隔内的偏离
+    */
+    void set_resync(bool late_start, bool gap_detection)
+    {
+        resync_ = std::make_unique<x2h::book::Resync>(books_, late_start);
+        resync_->set_gap_detection(gap_detection);
+    }
+
+    const x2h::book::Resync *resync() const noexcept
+    { return resync_.get(); }
+
+    const x2h::book::BookSet &books() const noexcept
+    { return books_; }
+
+    uint64_t events() const noexcept
+    { return events_; }
+
+private:
+    template<typename Quotation>
+    void check(const Quotation &snapshot, int64_t time_ns);
+
+    x2h::book::Verifier &verifier_;
+    x2h::book::BookSet books_{};
+    std::unique_ptr<x2h::book::Resync> resync_;
+    uint64_t events_{0};
+};
+
+void Checker::process(const std::shared_ptr<Item> &item)
+{
+    x2h::type::data::Event event;
+    if (x2h::dat::decode(item->DataType, item->Data, event)) {
+        if (resync_) {
+            resync_->apply(event);
+        } else {
+            books_.apply(event);
+        }
+        ++events_;
+        return;
+    }
+    x2h::dat::dispatch(*this, item->DataType, item->Data);
+}
+
+template<typename Quotation>
+void Checker::check(const Quotation &snapshot, int64_t time_ns)
+{
+    //! 集合竞价阶段的快照是虚拟撮合结果, 与逐笔重建的盘口不可比
+    if (time_ns < x2h::util::CONTINUOUS_TRADING_NS) return;
+    if (snapshot.SellLevelNo == 0 && snapshot.BuyLevelNo == 0) return;
+
+    if (auto *book = books_.find(snapshot.Symbol)) {
+        verifier_.submit(*book, snapshot);
+    }
+    if (resync_) resync_->on_snapshot(snapshot);
+}
+
+int main(int argc, char **argv)
+{
+    //! 未定义 OB_LATENCY 时为空操作, 否则周期性输出延迟直方图并在退出时输出累计
+    x2h::perf::LatencyReporter latency{};
+    //! 未定义 OB_COUNTERS 时为空操作, 否则在退出时输出每条消息的硬件计数
+    x2h::perf::CounterReporter counters{};
+    //! 未定义 OB_ALLOC 时为空操作, 否则在退出时输出热路径内的分配统计
+    x2h::perf::AllocReporter allocs{};
+
+    if (argc >= 3 && std::string_view(argv[1]) == "pipeline") {
+        x2h::pipeline::Pipeline pipeline{x2h::pipeline::PipelineConfig::load(argv[2])};
+        pipeline.run();
+        return 0;
+    }
+
+    if (argc >= 3 && std::string_view(argv[1]) == "batch") {
+        x2h::replay::BatchRunner runner{x2h::replay::BatchConfig::load(argv[2])};
+        runner.run();
+        return 0;
+    }
+
+    if (argc >= 3 && std::string_view(argv[1]) == "merge") {
+        x2h::book::BookSet books{};
+        uint64_t events = 0;
+        MergeReader reader{{argv + 2, argv + argc}, [&](const std::shared_ptr<Item> &item) {
+            x2h::type::data::Event event;
+            if (x2h::dat::decode(item->DataType, item->Data, event)) {
+                books.apply(event);
+                ++events;
             }
-            std::string msg;
-            if (sse_snapshot->SellLevelNo > 0) {
-                for (const auto &elem: std::ranges::reverse_view(sse_snapshot->SellLevel)) {
-                    msg += fmt::format("{0:^} | ask | {1:^7} | {2}\n", symbol_code, elem.Price, elem.Volume);
-                }
+        }};
+        reader.read();
+        x2h::log::info("归并重放完成, books: {}, events: {}", books.size(), events);
+        return 0;
+    }
+
+    if (argc >= 3 && std::string_view(argv[1]) == "pace") {
+        x2h::book::BookSet books{};
+        uint64_t events = 0;
+        DatReader reader{argv[2], [&](const std::shared_ptr<Item> &item) {
+            x2h::type::data::Event event;
+            if (x2h::dat::decode(item->DataType, item->Data, event)) {
+                books.apply(event);
+                ++events;
             }
+        }, ReadMode::MMAP};
+        reader.set_speed(argc >= 4 ? std::stod(argv[3]) : 1.0);
+        reader.read();
+        x2h::log::info("限速重放完成, books: {}, events: {}", books.size(), events);
+        return 0;
+    }
 
-            msg += fmt::format("------------------{}----------------\n", sse_snapshot->Time);
+    if (argc >= 3 && std::string_view(argv[1]) == "follow") {
+        x2h::book::BookSet books{};
+        uint64_t events = 0;
+        DatReader reader{argv[2], [&](const std::shared_ptr<Item> &item) {
+            x2h::type::data::Event event;
+            if (x2h::dat::decode(item->DataType, item->Data, event)) {
+                books.apply(event);
+                ++events;
+            }
+        }, ReadMode::FOLLOW};
+        if (argc >= 4) reader.set_idle_timeout(std::stoll(argv[3]) * 1000);
+        if (argc >= 5) reader.set_filter(SymbolFilter{{argv[4]}});
+        reader.read();
+
+        if (argc >= 5) {
+            TARGET = argv[4];
+            char ticker[20]{};
+            std::strncpy(ticker, TARGET.c_str(), sizeof(ticker) - 1);
+            if (auto *book = books.find(ticker)) {
+                print_order_book(*book, book->last_msg_time());
+            }
+        }
+        x2h::log::info("追踪结束, books: {}, events: {}", books.size(), events);
+        return 0;
+    }
 
-            if (sse_snapshot->BuyLevelNo > 0) {
-                for (const auto &elem: sse_snapshot->BuyLevel) {
-                    msg += fmt::format("{0:^} | bid | {1:^7} | {2}\n", symbol_code, elem.Price, elem.Volume);
+    if (argc >= 4 && std::string_view(argv[1]) == "subscribe") {
+        Subscription subscription{SubscriptionWatcher::load(argv[3])};
+        SubscriptionWatcher watcher{subscription, argv[3]};
+        Subscription::Reader subscriber{subscription};
+        x2h::replay::Checkpointer checkpointer{argv[2], argc >= 5 ? argv[4] : "", 0};
+
+        x2h::book::BookSet books{};
+        uint64_t events = 0;
+        DatReader reader{argv[2], [&](const std::shared_ptr<Item> &item) {
+            x2h::type::data::Event event;
+            if (x2h::dat::decode(item->DataType, item->Data, event)) {
+                books.apply(event);
+                ++events;
+            }
+        }, ReadMode::FOLLOW};
+        if (argc >= 6) reader.set_idle_timeout(std::stoll(argv[5]) * 1000);
+
+        reader.set_subscription(&subscriber, [&](const Subscription::Reader &sub, size_t offset) {
+            //! 退订的股票直接丢弃, 新订阅的从存档重建并追到当前位置
+            const auto &table = sub.table();
+            if (!table.symbols.empty()) {
+                std::vector<uint64_t> stale;
+                for (const auto &[key, book]: books) {
+                    if (!table.filter.contains(book->symbol().code)) stale.push_back(key);
                 }
+                for (auto key: stale) books.erase(key);
+            }
+            checkpointer.bootstrap(sub.added(), offset, books);
+        });
+        reader.read();
+        watcher.stop();
+
+        for (const auto &symbol: subscriber.table().symbols) {
+            TARGET = symbol;
+            char ticker[20]{};
+            std::strncpy(ticker, TARGET.c_str(), sizeof(ticker) - 1);
+            if (auto *book = books.find(ticker)) {
+                print_order_book(*book, book->last_msg_time());
             }
-            fmt::print(">>>>>>>>>>>>>>>>>>\n{}<<<<<<<<<<<<<<<<<<<<\n\n", msg);
-            break;
         }
-        case Msg_SSEL2_Transaction: {
-            auto *sse_trade_ptr = reinterpret_cast<SSEL2_Transaction *>(item->Data);
-            process_sse_trade(sse_trade_ptr);
-            break;
+        x2h::log::info("订阅重放结束, books: {}, events: {}", books.size(), events);
+        return 0;
+    }
+
+    if (argc >= 3 && std::string_view(argv[1]) == "verify") {
+        x2h::book::Verifier verifier{};
+        Checker checker{verifier};
+        DatReader reader{argv[2], [&](const std::shared_ptr<Item> &item) { checker.process(item); },
+                         ReadMode::MMAP};
+        if (argc >= 4) reader.set_filter(SymbolFilter{{argv[3]}});
+        reader.read();
+
+        verifier.stop();
+        verifier.report();
+        x2h::log::info("盘口校验结束, books: {}, events: {}", checker.books().size(), checker.events());
+        return 0;
+    }
+
+    if (argc >= 3 && std::string_view(argv[1]) == "resync") {
+        //! 跳过开头的 skip 条记录模拟中途启动
+        uint64_t skip = argc >= 4 ? std::stoull(argv[3]) : 0;
+        uint64_t records = 0;
+
+        x2h::book::Verifier verifier{};
+        Checker checker{verifier};
+        checker.set_resync(skip > 0, argc >= 5 && std::string_view(argv[4]) == "gap");
+        DatReader reader{argv[2], [&](const std::shared_ptr<Item> &item) {
+            if (records++ >= skip) checker.process(item);
+        }, ReadMode::MMAP};
+        reader.read();
+
+        verifier.stop();
+        verifier.report();
+        checker.resync()->report();
+
+        if (argc >= 6) {
+            TARGET = argv[5];
+            char ticker[20]{};
+            std::strncpy(ticker, TARGET.c_str(), sizeof(ticker) - 1);
+            if (auto *book = checker.books().find(ticker)) {
+                print_order_book(*book, book->last_msg_time());
+            }
         }
-        case Msg_SSEL2_Index:
-            break;
-        case Msg_SSEL2_Auction:
-            break;
-        case Msg_SSEL2_Overview:
-            break;
-        case Msg_SSEL2_Order: {
-            auto *sse_order_ptr = reinterpret_cast<SSEL2_Order *>(item->Data);
-            process_sse_order(sse_order_ptr);
-            break;
+        x2h::log::info("快照校正重放结束, books: {}, events: {}", checker.books().size(), checker.events());
+        return 0;
+    }
+
+    if (argc >= 4 && std::string_view(argv[1]) == "udp-recv") {
+        x2h::net::UdpFeedConfig config;
+        config.address = argv[2];
+        config.port = static_cast<uint16_t>(std::stoul(argv[3]));
+        if (argc >= 5) config.busy_poll = std::string_view(argv[4]) == "busy";
+        if (argc >= 6) config.idle_timeout_ms = std::stoll(argv[5]) * 1000;
+
+        x2h::book::BookSet books{};
+        uint64_t events = 0;
+        x2h::net::UdpFeed feed{config, [&](const std::shared_ptr<Item> &item) {
+            x2h::type::data::Event event;
+            if (x2h::dat::decode(item->DataType, item->Data, event)) {
+                books.apply(event);
+                ++events;
+                //! 实时行情: MDTTime -> 盘口更新完成
+                X2H_LATENCY(x2h::perf::local_recorder().end_to_end(x2h::perf::msg_of(event), event.rec_time());)
+            }
+        }};
+        feed.run();
+
+        if (argc >= 7) {
+            TARGET = argv[6];
+            char ticker[20]{};
+            std::strncpy(ticker, TARGET.c_str(), sizeof(ticker) - 1);
+            if (auto *book = books.find(ticker)) {
+                print_order_book(*book, book->last_msg_time());
+            }
         }
-        case Msg_SSEIOL1_Static:
-            break;
-        case Msg_SSEIOL1_Quotation:
-            break;
-        case Msg_SZSEL1_Static:
-            break;
-        case Msg_SZSEL1_Quotation:
-            break;
-        case Msg_SZSEL1_Bulletin:
-            break;
-        case Msg_SZSEL2_Static:
-            break;
-        case Msg_SZSEL2_Quotation:
-            break;
-        case Msg_SZSEL2_Transaction:
-            break;
-        case Msg_SZSEL2_Index:
-            break;
-        case Msg_SZSEL2_Order:
-            break;
-        case Msg_SZSEL2_Status:
-            break;
+        x2h::log::info("UDP 接收结束, datagrams: {}, records: {}, books: {}, events: {}",
+                       feed.datagrams(), feed.records(), books.size(), events);
+        return 0;
     }
 
-}
+    if (argc >= 5 && std::string_view(argv[1]) == "udp-send") {
+        x2h::net::UdpSenderConfig config;
+        config.address = argv[3];
+        config.port = static_cast<uint16_t>(std::stoul(argv[4]));
+        if (argc >= 6) config.speed = std::stod(argv[5]);
+
+        x2h::net::UdpSender sender{config};
+        auto records = sender.send(argv[2]);
+        x2h::log::info("UDP 发送结束, datagrams: {}, records: {}", sender.datagrams(), records);
+        return 0;
+    }
+
+    if (argc >= 4 && std::string_view(argv[1]) == "archive") {
+        x2h::archive::ArchiveWriter::convert(argv[2], argv[3]);
+        return 0;
+    }
+
+    if (argc >= 3 && std::string_view(argv[1]) == "archive-replay") {
+        x2h::archive::ArchiveReader reader{argv[2]};
+        x2h::book::BookSet books{};
+        auto apply = [&](const x2h::type::data::Event &event) { books.apply(event); };
+
+        uint64_t events;
+        if (argc >= 4) {
+            TARGET = argv[3];
+            char ticker[20]{};
+            std::strncpy(ticker, TARGET.c_str(), sizeof(ticker) - 1);
+            events = reader.read_symbol(ticker, apply);
+            if (auto *book = books.find(ticker)) {
+                print_order_book(*book, book->last_msg_time());
+            }
+        } else {
+            events = reader.read(apply);
+        }
+        x2h::log::info("存档重放完成, books: {}, events: {}", books.size(), events);
+        return 0;
+    }
+
+    if (argc >= 4 && std::string_view(argv[1]) == "checkpoint") {
+        int64_t minutes = argc >= 5 ? std::stoll(argv[4]) : 5;
+        x2h::replay::Checkpointer checkpointer{argv[2], argv[3], minutes * 60'000'000'000};
+        checkpointer.run();
+        return 0;
+    }
+
+    if (argc >= 5 && std::string_view(argv[1]) == "seek") {
+        x2h::replay::Checkpointer checkpointer{argv[2], argv[3], 0};
+        x2h::book::BookSet books{};
+        checkpointer.seek(x2h::util::hhmmssmmm_to_ns(std::stoll(argv[4])), books);
+
+        if (argc >= 6) {
+            TARGET = argv[5];
+            char ticker[20]{};
+            std::strncpy(ticker, TARGET.c_str(), sizeof(ticker) - 1);
+            if (auto *book = books.find(ticker)) {
+                print_order_book(*book, book->last_msg_time());
+            }
+        }
+        return 0;
+    }
+
+    if (argc >= 3 && std::string_view(argv[1]) == "generate") {
+        auto config = argc >= 4 ? x2h::dat::GeneratorConfig::load(argv[3]) : x2h::dat::GeneratorConfig{};
+        config.output = argv[2];
+
+        x2h::dat::Generator generator{config};
+        return generator.run(config.output) ? 0 : 1;
+    }
+
+    if (argc >= 3 && std::string_view(argv[1]) == "replay") {
+        x2h::replay::ParallelReplayConfig config;
+        if (argc >= 4) config.threads = std::stoul(argv[3]);
+        if (argc >= 5) config.batch_size = std::stoul(argv[4]);
+
+        x2h::replay::ParallelReplay replay{config};
+        replay.run(argv[2]);
+        x2h::log::info("重放完成, books: {}, events: {}", replay.book_count(), replay.events());
+        return 0;
+    }
+
+    if (argc >= 3 && std::string_view(argv[1]) == "flow") {
+        auto config = argc >= 4 ? x2h::analytics::FlowConfig::load(argv[3]) : x2h::analytics::FlowConfig{};
+        x2h::analytics::FlowAnalytics flow{config};
+        x2h::book::BookSet books{};
+        uint64_t events = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        DatReader reader{argv[2], [&](const std::shared_ptr<Item> &item) {
+            x2h::type::data::Event event;
+            if (!x2h::dat::decode(item->DataType, item->Data, event)) return;
+            //! 特征基于同一份盘口计算, 不另行维护
+            auto *book = books.apply(event);
+            if (book == nullptr) return;
+            flow.on_event(event, book->bbo());
+            ++events;
+        }, ReadMode::MMAP};
+        reader.read();
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        x2h::log::info("订单流特征完成, symbols: {}, events: {}, 耗时: {}ms", flow.size(), events, ms);
+
+        if (argc >= 5) {
+            char ticker[20]{};
+            std::strncpy(ticker, argv[4], sizeof(ticker) - 1);
+            auto features = flow.features(ticker);
+            for (size_t i = 0; i < features.size(); ++i) {
+                x2h::log::info("{} {:<24} {}", ticker, flow.feature_name(i), features[i]);
+            }
+        }
+        return 0;
+    }
+
+    if (argc >= 4 && std::string_view(argv[1]) == "digest") {
+        //! 间隔以 s 结尾时按市场时间(秒), 否则按事件数
+        std::string every = argc >= 5 ? argv[4] : "10000";
+        uint64_t every_events = 0;
+        int64_t every_ns = 0;
+        if (every.ends_with('s')) {
+            every_ns = static_cast<int64_t>(std::stod(every.substr(0, every.size() - 1)) * 1e9);
+        } else {
+            every_events = std::stoull(every);
+        }
+        uint64_t begin = argc >= 6 ? std::stoull(argv[5]) : 0;
+        uint64_t end = argc >= 7 ? std::stoull(argv[6]) : std::numeric_limits<uint64_t>::max();
+
+        x2h::book::BookSet books{};
+        x2h::replay::DigestWriter writer{argv[3], every_events, every_ns, begin, end};
+        if (!writer) return 1;
+
+        DatReader reader{argv[2], [&](const std::shared_ptr<Item> &item) {
+            x2h::type::data::Event event;
+            if (!x2h::dat::decode(item->DataType, item->Data, event)) return;
+            books.apply(event);
+            writer.on_event(event.time_ns(), books);
+        }, ReadMode::MMAP};
+        reader.read();
+        writer.finish(books);
+
+        x2h::log::info("摘要已写出 {}, records: {}, digest: {:016x}", argv[3], writer.records(), books.digest());
+        return 0;
+    }
+
+    if (argc >= 4 && std::string_view(argv[1]) == "digest-compare") {
+        int result = x2h::replay::compare_digests(argv[2], argv[3]);
+        return result == 0 ? 0 : 1;
+    }
+
+    if (argc >= 3 && std::string_view(argv[1]) == "book-diff") {
+        //! 参数为 .cfg 时先按合成行情配置生成, 再比对生成的文件
+        std::string dat_file = argv[2];
+        if (dat_file.ends_with(".cfg")) {
+            auto config = x2h::dat::GeneratorConfig::load(dat_file);
+            if (config.output.empty()) config.output = dat_file.substr(0, dat_file.size() - 4) + ".dat";
+            x2h::dat::Generator generator{config};
+            if (!generator.run(config.output)) return 1;
+            dat_file = config.output;
+        }
+        int32_t levels = argc >= 4 ? std::stoi(argv[3]) : 5;
+
+        x2h::book::DiffHarness<x2h::book::OrderBook, x2h::book::LevelBook> harness{levels};
+        DatReader reader{dat_file, [&](const std::shared_ptr<Item> &item) {
+            x2h::type::data::Event event;
+            if (x2h::dat::decode(item->DataType, item->Data, event)) harness.apply(event);
+        }, ReadMode::MMAP};
+        reader.read();
+
+        x2h::book::log_diff(harness.report(), "order_book", "level_book");
+        return harness.report().first_event == 0 ? 0 : 1;
+    }
+
+    if (argc >= 3 && std::string_view(argv[1]) == "memory") {
+        //! 行情时间 idle_ms 内没有消息的 OrderBook 转为紧凑表示, 0 表示不压缩
+        int64_t idle_ms = argc >= 4 ? std::stoll(argv[3]) : 0;
+        size_t top = argc >= 5 ? std::stoul(argv[4]) : 10;
+
+        x2h::book::BookSet books{};
+        books.set_compaction(idle_ms * 1'000'000);
+        DatReader reader{argv[2], [&](const std::shared_ptr<Item> &item) {
+            x2h::type::data::Event event;
+            if (x2h::dat::decode(item->DataType, item->Data, event)) books.apply(event);
+        }, ReadMode::MMAP};
+        reader.read();
+        books.log_memory(top);
+
+        //! 对照: 全部压缩后的占用
+        books.compact_idle(std::numeric_limits<int64_t>::max(), 0);
+        books.log_memory(0);
+        return 0;
+    }
+
+    if (argc >= 3 && std::string_view(argv[1]) == "alloc-check") {
+        if (!x2h::perf::ALLOC_ENABLED) {
+            x2h::log::warn("未定义 OB_ALLOC, 请使用 cmake -DOB_ALLOC=ON 重新编译");
+            return 1;
+        }
+
+        //! 预热 warmup 条事件后进入稳态, 未指定时以连续竞价开始为界
+        uint64_t warmup = argc >= 4 ? std::stoull(argv[3]) : 0;
+        auto policy = argc >= 5 && std::string_view(argv[4]) == "abort"
+                      ? x2h::perf::AllocPolicy::ABORT : x2h::perf::AllocPolicy::COUNT;
+        bool steady = false;
+        uint64_t events = 0;
+        uint64_t steady_events = 0;
+
+        x2h::book::BookSet books{};
+        DatReader reader{argv[2], [&](const std::shared_ptr<Item> &item) {
+            x2h::type::data::Event event;
+            bool decoded;
+            {
+                x2h::perf::ScopedAlloc scoped_alloc{x2h::perf::msg_of(item->DataType), x2h::perf::Stage::DECODE};
+                decoded = x2h::dat::decode(item->DataType, item->Data, event);
+            }
+            if (!decoded) return;
+
+            if (!steady && (warmup > 0 ? events >= warmup : event.time_ns() >= x2h::util::CONTINUOUS_TRADING_NS)) {
+                x2h::log::info("进入稳态, 已预热 events: {}", events);
+                x2h::perf::set_alloc_steady(true, policy);
+                steady = true;
+            }
+            books.apply(event);
+            ++events;
+            if (steady) ++steady_events;
+        }, ReadMode::MMAP};
+        reader.read();
+        x2h::perf::set_alloc_steady(false);
+
+        auto violations = x2h::perf::alloc_violations();
+        x2h::log::info("分配检查结束, books: {}, events: {}, 稳态 events: {}, 稳态热路径内分配: {}",
+                       books.size(), events, steady_events, violations);
+        return violations > 0 ? 1 : 0;
+    }
 
-int main()
-{
     A a{};
 
     DatReader reader{"/home/x2h1z/Downloads/DATA/dat/202109030705.dat",
                      [&](const std::shared_ptr<Item> &item) { a.process(item); }};
+    //! 只关注 TARGET, 其余股票的记录在读取层丢弃
+    reader.set_filter(SymbolFilter{{TARGET}});
 //    DatReader reader{"/home/x2h1z/Downloads/DATA/dat/202111100705.dat",
 //                     [&](const std::shared_ptr<Item> &item) { a.process(item); }};
     reader.read();
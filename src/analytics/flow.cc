@@ -0,0 +1,211 @@
+#include "analytics/flow.h"
+
+#include <cmath>
+#include <limits>
+
+#include "fmt/format.h"
+#include "utils.h"
+
+namespace x2h::analytics
+{
+    namespace
+    {
+        constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+
+        const char *instant_name(size_t feature) noexcept
+        {
+            switch (static_cast<Instant>(feature)) {
+                case Instant::MID:
+                    return "mid";
+                case Instant::SPREAD:
+                    return "spread";
+                case Instant::MICROPRICE:
+                    return "microprice";
+                case Instant::IMBALANCE:
+                    return "imbalance";
+                case Instant::LAST_PRICE:
+                    return "last_price";
+                default:
+                    return "unknown";
+            }
+        }
+
+        const char *windowed_name(size_t feature) noexcept
+        {
+            switch (static_cast<Windowed>(feature)) {
+                case Windowed::VWAP:
+                    return "vwap";
+                case Windowed::VOLUME:
+                    return "volume";
+                case Windowed::OFI:
+                    return "ofi";
+                case Windowed::CANCEL_RATE:
+                    return "cancel_rate";
+                case Windowed::TRADE_INTENSITY:
+                    return "trade_intensity";
+                default:
+                    return "unknown";
+            }
+        }
+
+        /*!
+         * @brief 卖一价, 卖方无挂单时视为无穷大
+        */
+        double ask_price(const type::data::PriceLevel &ask) noexcept
+        {
+            return ask.qty > 0 ? ask.price : std::numeric_limits<double>::infinity();
+        }
+
+        /*!
+         * @brief 两次买一卖一之间的订单流不平衡
+        */
+        double order_flow_imbalance(const book::Bbo &previous, const book::Bbo &current) noexcept
+        {
+            double e = 0;
+            if (current.bid.price >= previous.bid.price) e += static_cast<double>(current.bid.qty);
+            if (current.bid.price <= previous.bid.price) e -= static_cast<double>(previous.bid.qty);
+            if (ask_price(current.ask) <= ask_price(previous.ask)) e -= static_cast<double>(current.ask.qty);
+            if (ask_price(current.ask) >= ask_price(previous.ask)) e += static_cast<double>(previous.ask.qty);
+            return e;
+        }
+    }
+
+    FlowConfig FlowConfig::load(const std::string &file_path)
+    {
+        auto config = util::read_config(file_path);
+        FlowConfig result;
+
+        auto windows = util::split(config["flow.windows_ms"]);
+        if (!windows.empty()) {
+            result.windows_ns.clear();
+            for (const auto &window: windows) result.windows_ns.push_back(std::stoll(window) * 1'000'000);
+        }
+        if (!config["flow.buckets"].empty()) result.buckets = std::stoul(config["flow.buckets"]);
+        return result;
+    }
+
+    FlowBucket &FlowBucket::operator+=(const FlowBucket &other) noexcept
+    {
+        notional += other.notional;
+        volume += other.volume;
+        ofi += other.ofi;
+        orders += other.orders;
+        cancels += other.cancels;
+        trades += other.trades;
+        return *this;
+    }
+
+    FlowBucket &FlowBucket::operator-=(const FlowBucket &other) noexcept
+    {
+        notional -= other.notional;
+        volume -= other.volume;
+        ofi -= other.ofi;
+        orders -= other.orders;
+        cancels -= other.cancels;
+        trades -= other.trades;
+        return *this;
+    }
+
+    struct FlowAnalytics::State
+    {
+        State(const FlowConfig &config, size_t feature_count)
+                : features(feature_count, NaN)
+        {
+            windows.reserve(config.windows_ns.size());
+            for (auto window_ns: config.windows_ns) windows.emplace_back(window_ns, config.buckets);
+        }
+
+        book::Bbo bbo{};
+        double last_price{NaN};
+        std::vector<RollingWindow<FlowBucket>> windows;
+        std::vector<double> features;
+    };
+
+    FlowAnalytics::FlowAnalytics(FlowConfig config)
+            : config_(std::move(config))
+    {}
+
+    FlowAnalytics::~FlowAnalytics() = default;
+
+    FlowAnalytics::State &FlowAnalytics::state(const type::data::Event &event)
+    {
+        auto key = FastHash::Parse(event.ticker());
+        auto it = states_.find(key);
+        if (it == states_.end()) {
+            it = states_.emplace(key, std::make_unique<State>(config_, feature_count())).first;
+        }
+        return *it->second;
+    }
+
+    std::span<const double> FlowAnalytics::on_event(const type::data::Event &event, const book::Bbo &bbo)
+    {
+        auto &s = state(event);
+
+        FlowBucket delta;
+        if (event.type == type::data::EventType::ORDER) {
+            const auto &order = event.order;
+            bool cancel = order.exchange == type::data::Exchange::SH &&
+                          order.ord_type == static_cast<char>(type::data::sh::OrderType::DEL);
+            (cancel ? delta.cancels : delta.orders) = 1;
+        } else {
+            const auto &trade = event.trade;
+            if (trade.exchange == type::data::Exchange::SZ && trade.trade_flag == '4') {
+                delta.cancels = 1;
+            } else if (trade.price > 0 && trade.qty > 0) {
+                delta.trades = 1;
+                delta.volume = trade.qty;
+                delta.notional = trade.price * static_cast<double>(trade.qty);
+                s.last_price = trade.price;
+            }
+        }
+
+        delta.ofi = order_flow_imbalance(s.bbo, bbo);
+        s.bbo = bbo;
+
+        const auto &bid = bbo.bid;
+        const auto &ask = bbo.ask;
+        auto &f = s.features;
+        const bool two_sided = bid.qty > 0 && ask.qty > 0;
+        const auto depth = static_cast<double>(bid.qty + ask.qty);
+        f[index(Instant::MID)] = two_sided ? (bid.price + ask.price) / 2 : NaN;
+        f[index(Instant::SPREAD)] = two_sided ? ask.price - bid.price : NaN;
+        f[index(Instant::MICROPRICE)] = two_sided ? (bid.price * static_cast<double>(ask.qty) +
+                                                     ask.price * static_cast<double>(bid.qty)) / depth : NaN;
+        f[index(Instant::IMBALANCE)] = depth > 0 ? static_cast<double>(bid.qty - ask.qty) / depth : NaN;
+        f[index(Instant::LAST_PRICE)] = s.last_price;
+
+        const int64_t now_ns = event.time_ns();
+        for (size_t w = 0; w < s.windows.size(); ++w) {
+            auto &window = s.windows[w];
+            window.advance(now_ns);
+            window.add(delta);
+
+            const auto &total = window.total();
+            f[index(Windowed::VWAP, w)] = total.volume > 0 ? total.notional / static_cast<double>(total.volume) : NaN;
+            f[index(Windowed::VOLUME, w)] = static_cast<double>(total.volume);
+            f[index(Windowed::OFI, w)] = total.ofi;
+            f[index(Windowed::CANCEL_RATE, w)] = total.orders > 0 ? static_cast<double>(total.cancels) /
+                                                                    static_cast<double>(total.orders) : NaN;
+            f[index(Windowed::TRADE_INTENSITY, w)] = static_cast<double>(total.trades) * 1e9 /
+                                                     static_cast<double>(window.window_ns());
+        }
+        return f;
+    }
+
+    std::span<const double> FlowAnalytics::features(const char *ticker) const
+    {
+        auto it = states_.find(FastHash::Parse(ticker));
+        if (it == states_.end()) return {};
+        return it->second->features;
+    }
+
+    std::string FlowAnalytics::feature_name(size_t index) const
+    {
+        if (index < INSTANT_COUNT) return instant_name(index);
+
+        index -= INSTANT_COUNT;
+        size_t window = index / WINDOWED_COUNT;
+        if (window >= config_.windows_ns.size()) return "unknown";
+        return fmt::format("{}_{}ms", windowed_name(index % WINDOWED_COUNT), config_.windows_ns[window] / 1'000'000);
+    }
+}
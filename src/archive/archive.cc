@@ -0,0 +1,450 @@
+#include "archive/archive.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "archive/bitpack.h"
+#include "dat/decode.h"
+#include "dat/reader.h"
+#include "log/logger.h"
+#include "timestamp.h"
+
+namespace x2h::archive
+{
+    namespace
+    {
+        using type::data::Event;
+        using type::data::EventType;
+        using type::data::Exchange;
+
+        enum Column : uint8_t
+        {
+            KIND,
+            TIME,
+            REC_TIME,
+            CHANNEL,
+            PRICE,
+            QTY,
+            BUSINESS_NO,
+            /* order_id / trade_id */
+            ID,
+            ORIGIN_ORDER_ID,
+            BID_ID,
+            ASK_ID,
+            /* side / trade_flag */
+            FLAG,
+            ORD_TYPE,
+            AMOUNT,
+            COLUMN_COUNT
+        };
+
+        /* 按列是否存差分 */
+        constexpr bool DELTA[COLUMN_COUNT] = {
+                false, true, true, false, true, false, true,
+                true, true, true, true, false, false, false,
+        };
+
+        inline int64_t to_ticks(double value) noexcept
+        {
+            return std::llround(value * PRICE_SCALE);
+        }
+
+        inline double from_ticks(int64_t ticks) noexcept
+        {
+            return static_cast<double>(ticks) / PRICE_SCALE;
+        }
+
+        /*!
+         * @brief 事件展开为一行; 不适用的字段保留 row 中上一行的值
+        */
+        void to_row(const Event &event, int64_t (&row)[COLUMN_COUNT]) noexcept
+        {
+            if (event.type == EventType::ORDER) {
+                const auto &o = event.order;
+                row[KIND] = 0;
+                row[TIME] = o.time;
+                row[REC_TIME] = o.rec_time;
+                row[CHANNEL] = o.channel_no;
+                row[PRICE] = to_ticks(o.price);
+                row[QTY] = o.qty;
+                row[BUSINESS_NO] = o.business_no;
+                row[ID] = o.order_id;
+                row[ORIGIN_ORDER_ID] = o.origin_order_id;
+                row[FLAG] = o.side;
+                row[ORD_TYPE] = o.ord_type;
+            } else {
+                const auto &t = event.trade;
+                row[KIND] = 1;
+                row[TIME] = t.time;
+                row[REC_TIME] = t.rec_time;
+                row[CHANNEL] = t.channel_id;
+                row[PRICE] = to_ticks(t.price);
+                row[QTY] = t.qty;
+                row[BUSINESS_NO] = t.business_no;
+                row[ID] = t.trade_id;
+                row[BID_ID] = t.bid_id;
+                row[ASK_ID] = t.ask_id;
+                row[FLAG] = t.trade_flag;
+                row[AMOUNT] = to_ticks(t.memory);
+            }
+        }
+
+        void from_row(const int64_t *const (&cols)[COLUMN_COUNT], size_t i, const SymbolInfo &symbol,
+                      Event &event) noexcept
+        {
+            auto time_ns = [&](int64_t time) {
+                return symbol.exchange == Exchange::SH ? util::hhmmssmmm_to_ns(time)
+                                                       : util::yyyymmddhhmmssmmm_to_ns(time);
+            };
+
+            if (cols[KIND][i] == 0) {
+                event.type = EventType::ORDER;
+                event.order = {};
+                auto &o = event.order;
+                std::memcpy(o.ticker, symbol.ticker, sizeof(o.ticker));
+                o.time = cols[TIME][i];
+                o.time_ns = time_ns(o.time);
+                o.rec_time = cols[REC_TIME][i];
+                o.channel_no = static_cast<int32_t>(cols[CHANNEL][i]);
+                o.price = from_ticks(cols[PRICE][i]);
+                o.qty = cols[QTY][i];
+                o.business_no = cols[BUSINESS_NO][i];
+                o.order_id = cols[ID][i];
+                o.origin_order_id = cols[ORIGIN_ORDER_ID][i];
+                o.side = static_cast<char>(cols[FLAG][i]);
+                o.ord_type = static_cast<char>(cols[ORD_TYPE][i]);
+                o.exchange = symbol.exchange;
+            } else {
+                event.type = EventType::TRADE;
+                event.trade = {};
+                auto &t = event.trade;
+                std::memcpy(t.ticker, symbol.ticker, sizeof(t.ticker));
+                t.time = cols[TIME][i];
+                t.time_ns = time_ns(t.time);
+                t.rec_time = cols[REC_TIME][i];
+                t.channel_id = static_cast<int32_t>(cols[CHANNEL][i]);
+                t.price = from_ticks(cols[PRICE][i]);
+                t.qty = cols[QTY][i];
+                t.business_no = cols[BUSINESS_NO][i];
+                t.trade_id = cols[ID][i];
+                t.bid_id = cols[BID_ID][i];
+                t.ask_id = cols[ASK_ID][i];
+                t.trade_flag = static_cast<char>(cols[FLAG][i]);
+                t.memory = from_ticks(cols[AMOUNT][i]);
+                t.exchange = symbol.exchange;
+            }
+        }
+
+        template<typename T>
+        inline void append(std::vector<char> &out, const T &value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            auto offset = out.size();
+            out.resize(offset + sizeof(T));
+            std::memcpy(out.data() + offset, &value, sizeof(T));
+        }
+
+        template<typename T>
+        inline bool take(const char *&p, const char *end, T &value) noexcept
+        {
+            if (static_cast<size_t>(end - p) < sizeof(T)) return false;
+            std::memcpy(&value, p, sizeof(T));
+            p += sizeof(T);
+            return true;
+        }
+    }
+
+    ArchiveWriter::ArchiveWriter(const std::string &file_path)
+            : file_(std::fopen(file_path.c_str(), "wb"))
+    {
+        if (file_ == nullptr) {
+            log::error("存档文件 {} 创建失败", file_path);
+            return;
+        }
+
+        FileHeader header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.block_events = BLOCK_EVENTS;
+        util::write_pod(file_, header);
+        offset_ = sizeof(header);
+    }
+
+    ArchiveWriter::~ArchiveWriter()
+    {
+        close();
+    }
+
+    void ArchiveWriter::add(const type::data::Event &event)
+    {
+        auto key = FastHash::Parse(event.ticker());
+        auto it = pending_.find(key);
+        if (it == pending_.end()) {
+            SymbolInfo symbol{};
+            std::memcpy(symbol.ticker, event.ticker(), sizeof(symbol.ticker));
+            symbol.exchange = event.exchange();
+            symbols_.push_back(std::move(symbol));
+
+            it = pending_.emplace(key, Pending{static_cast<uint32_t>(symbols_.size() - 1), {}}).first;
+            it->second.events.reserve(BLOCK_EVENTS);
+        }
+
+        auto &pending = it->second;
+        pending.events.push_back(event);
+        if (pending.events.size() >= BLOCK_EVENTS) flush(pending);
+    }
+
+    /*!
+     * @brief 按列编码一个块并写出
+    */
+    void ArchiveWriter::flush(Pending &pending)
+    {
+        const auto count = pending.events.size();
+        if (count == 0 || file_ == nullptr) return;
+
+        //! 按行展开后转置为列
+        std::vector<int64_t> cols(COLUMN_COUNT * count);
+        int64_t row[COLUMN_COUNT]{};
+        for (size_t i = 0; i < count; ++i) {
+            to_row(pending.events[i], row);
+            for (int c = 0; c < COLUMN_COUNT; ++c) cols[c * count + i] = row[c];
+        }
+
+        buffer_.clear();
+        std::vector<uint64_t> values(count);
+        for (int c = 0; c < COLUMN_COUNT; ++c) {
+            const int64_t *col = cols.data() + c * count;
+            int64_t base;
+            uint64_t max = 0;
+
+            if (DELTA[c]) {
+                base = col[0];
+                int64_t prev = base;
+                for (size_t i = 0; i < count; ++i) {
+                    values[i] = zigzag(col[i] - prev);
+                    prev = col[i];
+                    max |= values[i];
+                }
+            } else {
+                base = *std::min_element(col, col + count);
+                for (size_t i = 0; i < count; ++i) {
+                    values[i] = static_cast<uint64_t>(col[i] - base);
+                    max |= values[i];
+                }
+            }
+
+            auto width = bit_width(max);
+            put_varint(buffer_, zigzag(base));
+            buffer_.push_back(static_cast<char>(width));
+            pack(values.data(), count, width, buffer_);
+        }
+
+        BlockHeader header{};
+        header.symbol = pending.index;
+        header.count = static_cast<uint32_t>(count);
+        header.length = static_cast<uint32_t>(buffer_.size());
+
+        symbols_[pending.index].blocks.push_back({offset_, header.count,
+                                                  pending.events.front().time_ns(),
+                                                  pending.events.back().time_ns()});
+
+        util::write_pod(file_, header);
+        std::fwrite(buffer_.data(), 1, buffer_.size(), file_);
+        offset_ += sizeof(header) + buffer_.size();
+        pending.events.clear();
+    }
+
+    bool ArchiveWriter::close()
+    {
+        if (file_ == nullptr) return false;
+
+        //! 按股票首次出现的顺序写出剩余块, 保证输出确定
+        std::vector<Pending *> rest;
+        for (auto &[_, pending] : pending_) rest.push_back(&pending);
+        std::sort(rest.begin(), rest.end(), [](auto *a, auto *b) { return a->index < b->index; });
+        for (auto *pending : rest) flush(*pending);
+
+        std::vector<char> footer;
+        append(footer, static_cast<uint32_t>(symbols_.size()));
+        for (const auto &symbol : symbols_) {
+            footer.insert(footer.end(), symbol.ticker, symbol.ticker + sizeof(symbol.ticker));
+            append(footer, symbol.exchange);
+            append(footer, static_cast<uint32_t>(symbol.blocks.size()));
+            for (const auto &block : symbol.blocks) {
+                append(footer, block.offset);
+                append(footer, block.count);
+                append(footer, block.first_time_ns);
+                append(footer, block.last_time_ns);
+            }
+        }
+        append(footer, offset_);
+        footer.insert(footer.end(), MAGIC, MAGIC + sizeof(MAGIC));
+
+        bool ok = std::fwrite(footer.data(), 1, footer.size(), file_) == footer.size();
+        offset_ += footer.size();
+        ok = std::fclose(file_) == 0 && ok;
+        file_ = nullptr;
+        return ok;
+    }
+
+    uint64_t ArchiveWriter::convert(const std::string &dat_file, const std::string &archive_file)
+    {
+        ArchiveWriter writer{archive_file};
+        if (!writer.is_open()) return 0;
+
+        uint64_t events = 0;
+        type::data::Event event;
+        DatReader reader{dat_file, [&](const std::shared_ptr<Item> &item) {
+            if (dat::decode(item->DataType, item->Data, event)) {
+                writer.add(event);
+                ++events;
+            }
+        }, ReadMode::MMAP};
+        reader.read();
+
+        if (!writer.close()) {
+            log::error("存档文件 {} 写入失败", archive_file);
+        }
+        log::info("{} -> {}, events: {}, symbols: {}, bytes: {}", dat_file, archive_file, events,
+                  writer.symbols_.size(), writer.offset_);
+        return events;
+    }
+
+    ArchiveReader::ArchiveReader(const std::string &file_path)
+    {
+        if (!mapping_.open(file_path)) return;
+
+        valid_ = parse_footer();
+        if (!valid_) log::error("存档文件 {} 格式错误", file_path);
+    }
+
+    bool ArchiveReader::parse_footer()
+    {
+        const char *data = mapping_.data();
+        const size_t size = mapping_.size();
+        const size_t tail = sizeof(uint64_t) + sizeof(MAGIC);
+        if (size < sizeof(FileHeader) + tail) return false;
+
+        FileHeader header{};
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) return false;
+        if (std::memcmp(data + size - sizeof(MAGIC), MAGIC, sizeof(MAGIC)) != 0) return false;
+
+        uint64_t footer;
+        std::memcpy(&footer, data + size - tail, sizeof(footer));
+        if (footer < sizeof(FileHeader) || footer > size - tail) return false;
+
+        const char *p = data + footer;
+        const char *end = data + size - tail;
+
+        uint32_t count;
+        if (!take(p, end, count)) return false;
+        symbols_.resize(count);
+
+        for (uint32_t i = 0; i < count; ++i) {
+            auto &symbol = symbols_[i];
+            uint32_t blocks;
+            if (!take(p, end, symbol.ticker) || !take(p, end, symbol.exchange) || !take(p, end, blocks)) {
+                return false;
+            }
+
+            symbol.blocks.resize(blocks);
+            for (auto &block : symbol.blocks) {
+                if (!take(p, end, block.offset) || !take(p, end, block.count) ||
+                    !take(p, end, block.first_time_ns) || !take(p, end, block.last_time_ns)) {
+                    return false;
+                }
+                if (block.offset + sizeof(BlockHeader) > footer) return false;
+            }
+
+            index_.emplace(FastHash::Parse(symbol.ticker), i);
+        }
+
+        return true;
+    }
+
+    size_t ArchiveReader::decode_block(uint64_t offset, std::vector<type::data::Event> &events) const
+    {
+        events.clear();
+
+        BlockHeader header{};
+        std::memcpy(&header, mapping_.data() + offset, sizeof(header));
+        if (header.symbol >= symbols_.size()) return 0;
+
+        const size_t count = header.count;
+        const char *p = mapping_.data() + offset + sizeof(header);
+        const char *end = p + header.length;
+        if (end > mapping_.data() + mapping_.size()) return 0;
+
+        std::vector<int64_t> cols(COLUMN_COUNT * count);
+        std::vector<uint64_t> values(count);
+        for (int c = 0; c < COLUMN_COUNT; ++c) {
+            if (p >= end) return 0;
+            int64_t base = unzigzag(get_varint(p));
+            int width = static_cast<uint8_t>(*p++);
+            auto bytes = packed_size(count, width);
+            if (width > 64 || static_cast<size_t>(end - p) < bytes) return 0;
+
+            unpack(p, count, width, values.data());
+            p += bytes;
+
+            int64_t *col = cols.data() + c * count;
+            if (DELTA[c]) {
+                //! 前缀和, 依赖上一项, 单独成循环让 unpack 保持可向量化
+                int64_t prev = base;
+                for (size_t i = 0; i < count; ++i) {
+                    prev += unzigzag(values[i]);
+                    col[i] = prev;
+                }
+            } else {
+                for (size_t i = 0; i < count; ++i) col[i] = base + static_cast<int64_t>(values[i]);
+            }
+        }
+
+        const int64_t *ptrs[COLUMN_COUNT];
+        for (int c = 0; c < COLUMN_COUNT; ++c) ptrs[c] = cols.data() + c * count;
+
+        const auto &symbol = symbols_[header.symbol];
+        events.resize(count);
+        for (size_t i = 0; i < count; ++i) from_row(ptrs, i, symbol, events[i]);
+        return count;
+    }
+
+    uint64_t ArchiveReader::read(const EventCallback &callback) const
+    {
+        if (!valid_) return 0;
+
+        std::vector<uint64_t> offsets;
+        for (const auto &symbol : symbols_) {
+            for (const auto &block : symbol.blocks) offsets.push_back(block.offset);
+        }
+        std::sort(offsets.begin(), offsets.end());
+
+        uint64_t events = 0;
+        std::vector<type::data::Event> block;
+        for (auto offset : offsets) {
+            decode_block(offset, block);
+            for (const auto &event : block) callback(event);
+            events += block.size();
+        }
+        return events;
+    }
+
+    uint64_t ArchiveReader::read_symbol(const char *ticker, const EventCallback &callback) const
+    {
+        if (!valid_) return 0;
+
+        auto it = index_.find(FastHash::Parse(ticker));
+        if (it == index_.end()) return 0;
+
+        uint64_t events = 0;
+        std::vector<type::data::Event> block;
+        for (const auto &info : symbols_[it->second].blocks) {
+            decode_block(info.offset, block);
+            for (const auto &event : block) callback(event);
+            events += block.size();
+        }
+        return events;
+    }
+}
@@ -0,0 +1,161 @@
+#include "book/book_set.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "log/logger.h"
+#include "perf/alloc.h"
+#include "perf/counters.h"
+#include "perf/latency.h"
+#include "utils.h"
+
+namespace x2h::book
+{
+    BookSet::BookSet(size_t max_books)
+            : max_books_(max_books)
+    {}
+
+    OrderBook *BookSet::find(uint64_t key) const noexcept
+    {
+        auto it = books_.find(key);
+        return it == books_.end() ? nullptr : it->second.get();
+    }
+
+    OrderBook *BookSet::get_or_create(const char *ticker, type::data::Exchange exchange)
+    {
+        auto k = key(ticker);
+        auto it = books_.find(k);
+        if (it != books_.end()) return it->second.get();
+
+        if (max_books_ != 0 && books_.size() >= max_books_) {
+            if (rejected_++ == 0) {
+                log::warn("OrderBook 数量达到上限 {}, 忽略 {}", max_books_, ticker);
+            }
+            return nullptr;
+        }
+
+        Symbol symbol{next_id_++, ticker, exchange};
+        auto [pos, _] = books_.emplace(k, std::make_unique<OrderBook>(symbol));
+        return pos->second.get();
+    }
+
+    OrderBook *BookSet::apply(const type::data::Event &event)
+    {
+        auto *book = get_or_create(event.ticker(), event.exchange());
+        if (book == nullptr) return nullptr;
+
+        X2H_LATENCY(uint64_t start = perf::rdtsc();)
+        X2H_COUNTERS(perf::ScopedCounters scoped_counters{perf::msg_of(event), perf::Stage::APPLY};)
+        X2H_ALLOC(perf::ScopedAlloc scoped_alloc{perf::msg_of(event), perf::Stage::APPLY};)
+        if (event.type == type::data::EventType::ORDER) {
+            book->on_order(event.order);
+        } else {
+            book->on_trade(event.trade);
+        }
+        X2H_LATENCY(perf::local_recorder().stage(perf::msg_of(event), perf::Stage::APPLY, perf::elapsed_ns(start));)
+
+        if (idle_ns_ > 0 && event.time_ns() >= next_compact_ns_) {
+            if (next_compact_ns_ != 0) compact_idle(event.time_ns(), idle_ns_);
+            next_compact_ns_ = event.time_ns() + idle_ns_;
+        }
+        return book;
+    }
+
+    size_t BookSet::compact_idle(int64_t now_ns, int64_t idle_ns)
+    {
+        size_t count = 0;
+        for (auto &[key, book]: books_) {
+            if (book->compacted() || book->last_time_ns() > now_ns - idle_ns) continue;
+            book->compact();
+            ++count;
+        }
+        return count;
+    }
+
+    size_t BookSet::compacted() const noexcept
+    {
+        return std::count_if(books_.begin(), books_.end(), [](const auto &item) { return item.second->compacted(); });
+    }
+
+    BookMemory BookSet::memory() const noexcept
+    {
+        BookMemory total;
+        for (const auto &[key, book]: books_) {
+            total += book->memory();
+        }
+        return total;
+    }
+
+    uint64_t BookSet::digest() const noexcept
+    {
+        uint64_t digest = 0;
+        for (const auto &[key, book]: books_) {
+            digest += book_digest(key, book->digest());
+        }
+        return digest;
+    }
+
+    void BookSet::log_memory(size_t top) const
+    {
+        std::vector<std::pair<BookMemory, const OrderBook *>> books;
+        books.reserve(books_.size());
+        for (const auto &[key, book]: books_) {
+            books.emplace_back(book->memory(), book.get());
+        }
+
+        top = std::min(top, books.size());
+        std::partial_sort(books.begin(), books.begin() + static_cast<ptrdiff_t>(top), books.end(),
+                          [](const auto &a, const auto &b) { return a.first.bytes > b.first.bytes; });
+        for (size_t i = 0; i < top; ++i) {
+            const auto &[memory, book] = books[i];
+            const auto &code = book->symbol().code;
+            log::info("内存 {} orders: {}, levels: {}, late_orders: {}, bytes: {}{}",
+                      std::string_view(code, strnlen(code, sizeof(code))),
+                      memory.orders, memory.levels, memory.late_orders, memory.bytes,
+                      book->compacted() ? " (compact)" : "");
+        }
+
+        auto total = memory();
+        log::info("内存合计 books: {} (compact: {}), orders: {}, levels: {}, late_orders: {}, bytes: {}",
+                  books_.size(), compacted(), total.orders, total.levels, total.late_orders, total.bytes);
+    }
+
+    std::unique_ptr<OrderBook> BookSet::extract(uint64_t key)
+    {
+        auto node = books_.extract(key);
+        return node.empty() ? nullptr : std::move(node.mapped());
+    }
+
+    void BookSet::insert(std::unique_ptr<OrderBook> book)
+    {
+        auto k = key(book->symbol().code);
+        books_.insert_or_assign(k, std::move(book));
+    }
+
+    bool BookSet::save(std::FILE *file) const
+    {
+        if (!util::write_pod(file, static_cast<uint64_t>(books_.size()))) return false;
+        for (const auto &[key, book]: books_) {
+            if (!util::write_pod(file, key) || !book->save(file)) return false;
+        }
+        return true;
+    }
+
+    bool BookSet::load(std::FILE *file)
+    {
+        books_.clear();
+
+        uint64_t size;
+        if (!util::read_pod(file, size)) return false;
+        for (uint64_t i = 0; i < size; ++i) {
+            uint64_t key;
+            auto book = std::make_unique<OrderBook>();
+            if (!util::read_pod(file, key) || !book->load(file)) return false;
+            next_id_ = std::max(next_id_, book->symbol().id + 1);
+            books_.emplace(key, std::move(book));
+        }
+        return true;
+    }
+}
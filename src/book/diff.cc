@@ -0,0 +1,31 @@
+#include "book/diff.h"
+
+#include "log/logger.h"
+
+namespace x2h::book
+{
+    void log_diff(const DiffReport &report, const char *reference, const char *candidate)
+    {
+        auto print = [&](const char *name, uint64_t cycles) {
+            auto ns = perf::tsc_to_ns(cycles);
+            double rate = ns > 0 ? static_cast<double>(report.events) * 1e9 / static_cast<double>(ns) : 0.0;
+            double per_event = report.events > 0 ? static_cast<double>(ns) / static_cast<double>(report.events) : 0.0;
+            log::info("引擎 {:<10} 耗时: {}ms, 吞吐: {:.0f} events/s, {:.1f} ns/event", name, ns / 1'000'000, rate,
+                      per_event);
+        };
+        print(reference, report.reference_cycles);
+        print(candidate, report.candidate_cycles);
+
+        if (report.first_event == 0) {
+            log::info("差分比对一致, events: {}, compared: {}", report.events, report.compared);
+            return;
+        }
+
+        log::warn("差分比对不一致, events: {}, compared: {}, 分歧股票数: {}",
+                  report.events, report.compared, report.diverged);
+        log::warn("首次分歧 event: {}, ticker: {}, time: {}, {} {} 第 {} 档, {}: {}@{}, {}: {}@{}",
+                  report.first_event, report.ticker, report.time, report.what, report.side == 0 ? "买" : "卖",
+                  report.level + 1, reference, report.reference.qty, report.reference.price,
+                  candidate, report.candidate.qty, report.candidate.price);
+    }
+}
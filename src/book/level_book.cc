@@ -0,0 +1,240 @@
+#include "book/level_book.h"
+
+#include <algorithm>
+
+#include "log/logger.h"
+
+namespace x2h::book
+{
+    static_assert(BookEngine<LevelBook>);
+
+    namespace
+    {
+        template<typename Levels>
+        int32_t copy_depth(const Levels &book, type::data::PriceLevel *levels, int32_t count) noexcept
+        {
+            int32_t n = 0;
+            for (auto it = book.begin(); n < count && it != book.end(); ++it, ++n) {
+                levels[n] = {it->first, it->second.qty};
+            }
+            return n;
+        }
+    }
+
+    LevelBook::LevelBook(const Symbol &symbol)
+            : symbol_(symbol)
+    {}
+
+    void LevelBook::on_order(const type::data::Order &order)
+    {
+        type::data::Order new_order(order);
+        last_msg_time_ = new_order.time;
+
+        int64_t id;
+        if (order.exchange == type::data::Exchange::SH) {
+            id = last_order_id_ = new_order.origin_order_id;
+            //! 上证的撤单会通过 Order 回报
+            if (new_order.ord_type == static_cast<char>(type::data::sh::OrderType::DEL)) {
+                if (new_order.is_buy()) {
+                    remove_id(true, id);
+                } else if (new_order.is_sell()) {
+                    remove_id(false, id);
+                }
+                return;
+            }
+        } else {
+            id = last_order_id_ = new_order.order_id;
+            if (trade_supped(new_order)) return;
+        }
+
+        if (new_order.qty > 0) add(new_order, id);
+    }
+
+    void LevelBook::on_trade(const type::data::Trade &trade)
+    {
+        last_msg_time_ = trade.time;
+
+        if (trade.exchange == type::data::Exchange::SZ && trade.trade_flag == '4') {
+            on_cancel(trade);
+            return;
+        }
+
+        int64_t traded_id = trade.is_buy() ? trade.bid_id : trade.ask_id;
+        if (last_order_id_ < traded_id) {
+            late_orders_[traded_id] = trade.qty;
+        }
+
+        const bool sh = trade.exchange == type::data::Exchange::SH;
+        on_traded(bids_, true, trade, trade.bid_id, [&](double price) {
+            return sh ? price >= trade.price : price > trade.price;
+        });
+        on_traded(asks_, false, trade, trade.ask_id, [&](double price) {
+            return sh ? price <= trade.price : price < trade.price;
+        });
+    }
+
+    int32_t LevelBook::bid_depth(type::data::PriceLevel *levels, int32_t count) const noexcept
+    {
+        return copy_depth(bids_, levels, count);
+    }
+
+    int32_t LevelBook::ask_depth(type::data::PriceLevel *levels, int32_t count) const noexcept
+    {
+        return copy_depth(asks_, levels, count);
+    }
+
+    Bbo LevelBook::bbo() const noexcept
+    {
+        Bbo bbo;
+        bid_depth(&bbo.bid, 1);
+        ask_depth(&bbo.ask, 1);
+        return bbo;
+    }
+
+    void LevelBook::add(const type::data::Order &order, int64_t id)
+    {
+        if (!order.is_buy() && !order.is_sell()) {
+            log::warn("未知Order Side: {}, ticker: {}, order_id: {}", order.side, order.ticker, order.order_id);
+            return;
+        }
+
+        int32_t index;
+        if (free_ != NIL) {
+            index = free_;
+            free_ = nodes_[index].next;
+        } else {
+            index = static_cast<int32_t>(nodes_.size());
+            nodes_.emplace_back();
+        }
+        auto &node = nodes_[index];
+        node = Node{id, order.qty, order.time_ns, order.business_no, order.price, NIL, NIL, NIL, order.is_buy()};
+
+        //! 序号重复时与 OrderBook 一样都保留, 接在相同序号链表末尾
+        auto [it, inserted] = index_.try_emplace(id, index);
+        if (!inserted) {
+            int32_t last = it->second;
+            while (nodes_[last].same_id != NIL) last = nodes_[last].same_id;
+            nodes_[last].same_id = index;
+        }
+
+        if (node.buy) {
+            insert(bids_, index);
+        } else {
+            insert(asks_, index);
+        }
+        ++size_;
+    }
+
+    template<typename Levels>
+    void LevelBook::insert(Levels &levels, int32_t index)
+    {
+        auto &node = nodes_[index];
+        auto &level = levels[node.price];
+        node.prev = level.tail;
+        if (level.tail != NIL) {
+            nodes_[level.tail].next = index;
+        } else {
+            level.head = index;
+        }
+        level.tail = index;
+        level.qty += node.qty;
+    }
+
+    template<typename Levels>
+    void LevelBook::remove(Levels &levels, typename Levels::iterator level, int32_t index)
+    {
+        auto &node = nodes_[index];
+        auto &entry = level->second;
+        (node.prev != NIL ? nodes_[node.prev].next : entry.head) = node.next;
+        (node.next != NIL ? nodes_[node.next].prev : entry.tail) = node.prev;
+        entry.qty -= node.qty;
+        if (entry.head == NIL) levels.erase(level);
+
+        auto it = index_.find(node.id);
+        if (it->second == index) {
+            if (node.same_id == NIL) {
+                index_.erase(it);
+            } else {
+                it->second = node.same_id;
+            }
+        } else {
+            int32_t prev = it->second;
+            while (nodes_[prev].same_id != index) prev = nodes_[prev].same_id;
+            nodes_[prev].same_id = node.same_id;
+        }
+
+        node.next = free_;
+        free_ = index;
+        --size_;
+    }
+
+    void LevelBook::remove_id(bool buy, int64_t id)
+    {
+        auto it = index_.find(id);
+        if (it == index_.end()) return;
+
+        for (int32_t i = it->second; i != NIL;) {
+            const auto &node = nodes_[i];
+            int32_t next = node.same_id;
+            if (node.buy == buy) {
+                if (buy) {
+                    remove(bids_, bids_.find(node.price), i);
+                } else {
+                    remove(asks_, asks_.find(node.price), i);
+                }
+            }
+            i = next;
+        }
+    }
+
+    template<typename Levels, typename Through>
+    void LevelBook::on_traded(Levels &levels, bool buy, const type::data::Trade &trade, int64_t id, Through through)
+    {
+        const bool sh = trade.exchange == type::data::Exchange::SH;
+
+        if (auto it = index_.find(id); it != index_.end()) {
+            for (int32_t i = it->second; i != NIL;) {
+                auto &node = nodes_[i];
+                int32_t next = node.same_id;
+                if (node.buy == buy && !(sh && trade.business_no < node.business_no)) {
+                    auto level = levels.find(node.price);
+                    node.qty -= trade.qty;
+                    level->second.qty -= trade.qty;
+                    if (node.qty <= 0) remove(levels, level, i);
+                }
+                i = next;
+            }
+        }
+
+        //! 比成交价更优(上证含成交价)且更早的挂单应已成交, 序号匹配的挂单已在上面处理
+        for (auto level = levels.begin(); level != levels.end() && through(level->first);) {
+            auto next_level = std::next(level);
+            for (int32_t i = level->second.head; i != NIL;) {
+                int32_t next = nodes_[i].next;
+                if (nodes_[i].id != id && nodes_[i].time_ns < trade.time_ns) remove(levels, level, i);
+                i = next;
+            }
+            level = next_level;
+        }
+    }
+
+    bool LevelBook::trade_supped(type::data::Order &order)
+    {
+        auto it = late_orders_.find(order.order_id);
+        if (it == late_orders_.end()) return false;
+
+        order.qty -= std::min(it->second, order.qty);
+        return order.qty <= 0;
+    }
+
+    void LevelBook::on_cancel(const type::data::Trade &trade)
+    {
+        const bool buy = trade.bid_id != 0;
+        const int64_t id = buy ? trade.bid_id : trade.ask_id;
+        if (last_order_id_ >= id) {
+            remove_id(buy, id);
+        } else {
+            late_orders_[id] = trade.qty;
+        }
+    }
+}
@@ -1,7 +1,29 @@
 #include "book/order_book.h"
 
+#include <algorithm>
+#include <vector>
+
+#include "log/logger.h"
+#include "perf/alloc.h"
+#include "perf/counters.h"
+#include "perf/latency.h"
+#include "utils.h"
+
 namespace x2h::book
 {
+    static_assert(BookEngine<OrderBook>);
+
+    struct OrderBook::Compact
+    {
+        /* 到达顺序, 与 bids_/asks_ 相同 */
+        std::vector<type::data::Order> bids;
+        std::vector<type::data::Order> asks;
+        /* 按 order_id 排序 */
+        std::vector<std::pair<int64_t, int64_t>> late_orders;
+    };
+
+    OrderBook::OrderBook() = default;
+
     OrderBook::OrderBook(const Symbol &symbol)
             : symbol_(symbol)
     {}
@@ -21,16 +43,18 @@ namespace x2h::book
     {
         if (order.is_buy()) {
             bids_.push_back(order);
+            digest_ += hash_order(true, order);
 
             if ((best_bid_.price == 0) || (order.price > best_bid_.price))
                 best_bid_ = order;
         } else if (order.is_sell()) {
             asks_.push_back(order);
+            digest_ += hash_order(false, order);
 
             if ((best_ask_.price == 0) || (order.price < best_ask_.price))
                 best_ask_ = order;
         } else {
-            printf("未知Order Side: %c\n", order.side);
+            log::warn("未知Order Side: {}, ticker: {}, order_id: {}", order.side, order.ticker, order.order_id);
         }
     }
 
@@ -39,22 +63,36 @@ namespace x2h::book
     */
     void OrderBook::on_order(const type::data::Order &order)
     {
+        X2H_LATENCY(perf::ScopedOp scoped_op{perf::msg_of(order.exchange, false), perf::Op::ADD};)
+        X2H_COUNTERS(perf::ScopedCounters scoped_counters{perf::msg_of(order.exchange, false), perf::Op::ADD};)
+        X2H_ALLOC(perf::ScopedAlloc scoped_alloc{perf::msg_of(order.exchange, false), perf::Op::ADD};)
+        if (compact_) expand();
         type::data::Order new_order(order);
         last_msg_time_ = new_order.time;
+        last_time_ns_ = new_order.time_ns;
 
         if (order.exchange == type::data::Exchange::SH) {
             last_order_id_ = new_order.origin_order_id;
             //! 上证的撤单会通过 Order 回报
             if (new_order.ord_type == static_cast<char>(type::data::sh::OrderType::DEL)) {
+                X2H_LATENCY(scoped_op.set_op(perf::Op::CANCEL);)
+                X2H_COUNTERS(scoped_counters.set_op(perf::Op::CANCEL);)
+                X2H_ALLOC(scoped_alloc.set_op(perf::Op::CANCEL);)
+                size_t removed = 0;
                 if (new_order.is_buy()) {
-                    bids_.remove_if([&](type::data::Order &o) {
-                        return o.origin_order_id == new_order.origin_order_id;
+                    removed = bids_.remove_if([&](type::data::Order &o) {
+                        if (o.origin_order_id != new_order.origin_order_id) return false;
+                        digest_ -= hash_order(true, o);
+                        return true;
                     });
                 } else if (new_order.is_sell()) {
-                    asks_.remove_if([&](type::data::Order &o) {
-                        return o.origin_order_id == new_order.origin_order_id;
+                    removed = asks_.remove_if([&](type::data::Order &o) {
+                        if (o.origin_order_id != new_order.origin_order_id) return false;
+                        digest_ -= hash_order(false, o);
+                        return true;
                     });
                 }
+                if (removed == 0 && hybrid()) consume_level(new_order.is_buy(), new_order.price, new_order.qty);
                 return;
             }
         } else {
@@ -69,14 +107,32 @@ namespace x2h::book
         }
     }
 
+    void OrderBook::restore_order(const type::data::Order &order)
+    {
+        if (compact_) expand();
+        type::data::Order new_order(order);
+        last_msg_time_ = new_order.time;
+        last_time_ns_ = new_order.time_ns;
+        last_order_id_ = order.exchange == type::data::Exchange::SH ? new_order.origin_order_id : new_order.order_id;
+        add_order(new_order);
+    }
+
     /*!
      * @brief 新的 Trade 消息
     */
     void OrderBook::on_trade(const type::data::Trade &trade)
     {
         last_msg_time_ = trade.time;
+        last_time_ns_ = trade.time_ns;
+        X2H_LATENCY(perf::ScopedOp scoped_op{perf::msg_of(trade.exchange, true), perf::Op::FILL};)
+        X2H_COUNTERS(perf::ScopedCounters scoped_counters{perf::msg_of(trade.exchange, true), perf::Op::FILL};)
+        X2H_ALLOC(perf::ScopedAlloc scoped_alloc{perf::msg_of(trade.exchange, true), perf::Op::FILL};)
+        if (compact_) expand();
 
         if (trade.exchange == type::data::Exchange::SZ && trade.trade_flag == '4') {
+            X2H_LATENCY(scoped_op.set_op(perf::Op::CANCEL);)
+            X2H_COUNTERS(scoped_counters.set_op(perf::Op::CANCEL);)
+            X2H_ALLOC(scoped_alloc.set_op(perf::Op::CANCEL);)
             on_cancel(trade);
         } else {
             on_traded(trade);
@@ -94,9 +150,12 @@ namespace x2h::book
             trade_id = trade.bid_id;
 
             if (last_order_id_ >= trade_id) {
-                bids_.remove_if([&](type::data::Order &order) {
-                    return order.order_id == trade_id;
+                auto removed = bids_.remove_if([&](type::data::Order &order) {
+                    if (order.order_id != trade_id) return false;
+                    digest_ -= hash_order(true, order);
+                    return true;
                 });
+                if (removed == 0 && hybrid()) consume_level(true, trade.price, trade.qty);
             } else {
                 late_orders_[trade_id] = trade.qty;
             }
@@ -104,9 +163,12 @@ namespace x2h::book
             trade_id = trade.ask_id;
 
             if (last_order_id_ >= trade_id) {
-                asks_.remove_if([&](type::data::Order &order) {
-                    return order.order_id == trade_id;
+                auto removed = asks_.remove_if([&](type::data::Order &order) {
+                    if (order.order_id != trade_id) return false;
+                    digest_ -= hash_order(false, order);
+                    return true;
                 });
+                if (removed == 0 && hybrid()) consume_level(false, trade.price, trade.qty);
             } else {
                 late_orders_[trade_id] = trade.qty;
             }
@@ -123,6 +185,9 @@ namespace x2h::book
             late_orders_[traded_id] = trade.qty;
         }
 
+        bool bid_found = false;
+        bool ask_found = false;
+
         //! 按时间、价格、order_id来删减 Order
         /*if (last_order_id_ >= trade.bid_id)*/ {
             auto it = bids_.begin();
@@ -134,10 +199,15 @@ namespace x2h::book
                     auto qty1 = new_it->qty;
                     if (trade.bid_id == new_it->origin_order_id) {
                         if (trade.business_no < new_it->business_no) continue;
+                        bid_found = true;
+                        digest_ -= hash_order(true, *new_it);
                         new_it->qty -= trade.qty;
                         if (new_it->qty <= 0)
                             bids_.erase(new_it);
-                    } else if ((new_it->price >= trade.price && new_it->time < trade.time)) {
+                        else
+                            digest_ += hash_order(true, *new_it);
+                    } else if ((new_it->price >= trade.price && new_it->time_ns < trade.time_ns)) {
+                        digest_ -= hash_order(true, *new_it);
                         bids_.erase(new_it);
                     }
                 }
@@ -147,10 +217,15 @@ namespace x2h::book
                     ++it;
 
                     if (trade.bid_id == new_it->order_id) {
+                        bid_found = true;
+                        digest_ -= hash_order(true, *new_it);
                         new_it->qty -= trade.qty;
                         if (new_it->qty <= 0)
                             bids_.erase(new_it);
-                    } else if ((new_it->price > trade.price) && (new_it->time < trade.time)) {
+                        else
+                            digest_ += hash_order(true, *new_it);
+                    } else if ((new_it->price > trade.price) && (new_it->time_ns < trade.time_ns)) {
+                        digest_ -= hash_order(true, *new_it);
                         bids_.erase(new_it);
                     }
                 }
@@ -167,10 +242,15 @@ namespace x2h::book
                     auto qty1 = new_it->qty;
                     if (trade.ask_id == new_it->origin_order_id) {
                         if (trade.business_no < new_it->business_no) continue;
+                        ask_found = true;
+                        digest_ -= hash_order(false, *new_it);
                         new_it->qty -= trade.qty;
                         if (new_it->qty <= 0)
                             asks_.erase(new_it);
-                    } else if ((new_it->price <= trade.price) && (new_it->time < trade.time)) {
+                        else
+                            digest_ += hash_order(false, *new_it);
+                    } else if ((new_it->price <= trade.price) && (new_it->time_ns < trade.time_ns)) {
+                        digest_ -= hash_order(false, *new_it);
                         asks_.erase(new_it);
                     }
                 }
@@ -180,15 +260,30 @@ namespace x2h::book
                     ++it;
 
                     if (trade.ask_id == new_it->order_id) {
+                        ask_found = true;
+                        digest_ -= hash_order(false, *new_it);
                         new_it->qty -= trade.qty;
                         if (new_it->qty <= 0)
                             asks_.erase(new_it);
-                    } else if ((new_it->price < trade.price) && (new_it->time < trade.time)) {
+                        else
+                            digest_ += hash_order(false, *new_it);
+                    } else if ((new_it->price < trade.price) && (new_it->time_ns < trade.time_ns)) {
+                        digest_ -= hash_order(false, *new_it);
                         asks_.erase(new_it);
                     }
                 }
             }
         }
+
+        if (hybrid()) {
+            //! 被动方(序号较小)不在队列中, 说明是快照之前的挂单
+            bool bid_passive = trade.bid_id < trade.ask_id;
+            if (bid_passive ? !bid_found : !ask_found) consume_level(bid_passive, trade.price, trade.qty);
+
+            //! 比成交价更优的档位已被吃穿
+            bid_levels_.erase(bid_levels_.begin(), bid_levels_.lower_bound(trade.price));
+            ask_levels_.erase(ask_levels_.begin(), ask_levels_.lower_bound(trade.price));
+        }
     }
 
     /*!
@@ -219,6 +314,9 @@ namespace x2h::book
     */
     void OrderBook::match_order(const type::data::Order &order) noexcept
     {
+        X2H_LATENCY(perf::ScopedOp scoped_op{perf::msg_of(order.exchange, false), perf::Op::MATCH};)
+        X2H_COUNTERS(perf::ScopedCounters scoped_counters{perf::msg_of(order.exchange, false), perf::Op::MATCH};)
+        X2H_ALLOC(perf::ScopedAlloc scoped_alloc{perf::msg_of(order.exchange, false), perf::Op::MATCH};)
         if (order.is_sell()) {
             match_ask_book();
         } else if (order.is_buy()) {
@@ -298,6 +396,379 @@ namespace x2h::book
         }
     }
 
+    namespace
+    {
+        template<typename Levels>
+        void consume(Levels &levels, double price, int64_t qty) noexcept
+        {
+            auto it = levels.find(price);
+            if (it == levels.end()) return;
+            it->second -= qty;
+            if (it->second <= 0) levels.erase(it);
+        }
+
+        /*!
+         * @brief 以单侧快照校正 Order 队列, 返回快照中尚未对应到 Order 的数量
+        */
+        template<typename Levels>
+        void reconcile(std::list<type::data::Order> &queue, Levels &levels,
+                       const type::data::PriceLevel *snapshot, int32_t count)
+        {
+            levels.clear();
+            if (count <= 0) {
+                //! 快照中该侧没有挂单
+                queue.clear();
+                return;
+            }
+
+            //! 快照只覆盖到第 count 档, 更深的 Order 保持不变
+            auto comp = levels.key_comp();
+            const double worst = snapshot[count - 1].price;
+            auto covered = [&](double price) { return !comp(worst, price); };
+
+            Levels excess{comp};
+            for (const auto &order: queue) {
+                if (covered(order.price)) excess[order.price] += order.qty;
+            }
+            for (int32_t i = 0; i < count; ++i) {
+                auto &qty = excess[snapshot[i].price];
+                qty -= snapshot[i].qty;
+                if (qty < 0) levels[snapshot[i].price] = -qty;
+            }
+
+            //! 多出的数量按时间从早到晚扣减, 较早的 Order 更可能已被成交
+            for (auto it = queue.begin(); it != queue.end();) {
+                auto found = covered(it->price) ? excess.find(it->price) : excess.end();
+                if (found == excess.end() || found->second <= 0) {
+                    ++it;
+                    continue;
+                }
+                auto cut = std::min(found->second, it->qty);
+                found->second -= cut;
+                it->qty -= cut;
+                it = it->qty <= 0 ? queue.erase(it) : std::next(it);
+            }
+        }
+    }
+
+    inline void OrderBook::consume_level(bool buy, double price, int64_t qty) noexcept
+    {
+        if (price <= 0) return;
+        if (buy) {
+            consume(bid_levels_, price, qty);
+        } else {
+            consume(ask_levels_, price, qty);
+        }
+    }
+
+    void OrderBook::resync(const type::data::PriceLevel *bids, int32_t bid_count,
+                           const type::data::PriceLevel *asks, int32_t ask_count)
+    {
+        if (compact_) expand();
+        reconcile(bids_, bid_levels_, bids, bid_count);
+        reconcile(asks_, ask_levels_, asks, ask_count);
+
+        best_bid_ = bids_.empty() ? type::data::Order{} : *std::max_element(
+                bids_.begin(), bids_.end(), [](const auto &a, const auto &b) { return a.price < b.price; });
+        best_ask_ = asks_.empty() ? type::data::Order{} : *std::min_element(
+                asks_.begin(), asks_.end(), [](const auto &a, const auto &b) { return a.price < b.price; });
+        //! 快照校正批量改动队列, 直接重算
+        rehash();
+    }
+
+    namespace
+    {
+        /* 存档格式版本, OrderBook 成员变化时递增 */
+        constexpr uint32_t SAVE_VERSION = 3;
+
+        template<typename Queue>
+        bool save_queue(std::FILE *file, const Queue &queue)
+        {
+            if (!util::write_pod(file, static_cast<uint64_t>(queue.size()))) return false;
+            for (const auto &order: queue) {
+                if (!util::write_pod(file, order)) return false;
+            }
+            return true;
+        }
+
+        template<typename Queue>
+        bool load_queue(std::FILE *file, Queue &queue)
+        {
+            uint64_t size;
+            if (!util::read_pod(file, size)) return false;
+            queue.clear();
+            for (uint64_t i = 0; i < size; ++i) {
+                type::data::Order order;
+                if (!util::read_pod(file, order)) return false;
+                queue.push_back(order);
+            }
+            return true;
+        }
+
+        template<typename Map>
+        bool save_map(std::FILE *file, const Map &map)
+        {
+            if (!util::write_pod(file, static_cast<uint64_t>(map.size()))) return false;
+            for (const auto &[key, value]: map) {
+                if (!util::write_pod(file, key) || !util::write_pod(file, value)) return false;
+            }
+            return true;
+        }
+
+        template<typename Map>
+        bool load_map(std::FILE *file, Map &map)
+        {
+            uint64_t size;
+            if (!util::read_pod(file, size)) return false;
+            map.clear();
+            for (uint64_t i = 0; i < size; ++i) {
+                typename Map::key_type key;
+                typename Map::mapped_type value;
+                if (!util::read_pod(file, key) || !util::read_pod(file, value)) return false;
+                map.emplace(key, value);
+            }
+            return true;
+        }
+    }
+
+    bool OrderBook::save(std::FILE *file) const
+    {
+        //! 紧凑表示按相同格式写出, 恢复后为普通表示
+        const auto *compact = compact_.get();
+        return util::write_pod(file, SAVE_VERSION) &&
+               util::write_pod(file, symbol_) &&
+               util::write_pod(file, last_order_id_) &&
+               util::write_pod(file, last_msg_time_) &&
+               util::write_pod(file, last_time_ns_) &&
+               util::write_pod(file, best_bid_) &&
+               util::write_pod(file, best_ask_) &&
+               (compact ? save_queue(file, compact->bids) : save_queue(file, bids_)) &&
+               (compact ? save_queue(file, compact->asks) : save_queue(file, asks_)) &&
+               (compact ? save_map(file, compact->late_orders) : save_map(file, late_orders_)) &&
+               save_map(file, bid_book_snapshot_) &&
+               save_map(file, ask_book_snapshot_) &&
+               save_map(file, bid_levels_) &&
+               save_map(file, ask_levels_);
+    }
+
+    bool OrderBook::load(std::FILE *file)
+    {
+        uint32_t version;
+        if (!util::read_pod(file, version) || version != SAVE_VERSION) {
+            log::error("OrderBook 存档版本不匹配");
+            return false;
+        }
+
+        compact_.reset();
+        bool loaded = util::read_pod(file, symbol_) &&
+               util::read_pod(file, last_order_id_) &&
+               util::read_pod(file, last_msg_time_) &&
+               util::read_pod(file, last_time_ns_) &&
+               util::read_pod(file, best_bid_) &&
+               util::read_pod(file, best_ask_) &&
+               load_queue(file, bids_) &&
+               load_queue(file, asks_) &&
+               load_map(file, late_orders_) &&
+               load_map(file, bid_book_snapshot_) &&
+               load_map(file, ask_book_snapshot_) &&
+               load_map(file, bid_levels_) &&
+               load_map(file, ask_levels_);
+        rehash();
+        return loaded;
+    }
+
+    namespace
+    {
+        template<typename Levels, typename Queue>
+        void add_levels(Levels &levels, const Queue &queue)
+        {
+            for (const auto &item: queue) {
+                levels[item.price] += item.qty;
+            }
+        }
+
+        //! 按 libstdc++ 的节点布局估算: 链表节点两个指针, 红黑树节点颜色 + 三个指针, 哈希节点 next 指针 + 缓存的哈希值
+        template<typename T>
+        constexpr size_t LIST_NODE = sizeof(T) + 2 * sizeof(void *);
+        template<typename T>
+        constexpr size_t TREE_NODE = sizeof(T) + 4 * sizeof(void *);
+        template<typename T>
+        constexpr size_t HASH_NODE = sizeof(T) + 2 * sizeof(void *);
+
+        template<typename Map>
+        size_t tree_bytes(const Map &map) noexcept
+        {
+            return map.size() * TREE_NODE<typename Map::value_type>;
+        }
+
+        /*!
+         * @brief 把一个价位的数量计入按优先级排列的前 count 档, 排不进前 count 档的直接丢弃
+        */
+        template<typename Better>
+        void add_top(type::data::PriceLevel *levels, int32_t &n, int32_t count, double price, int64_t qty,
+                     Better better) noexcept
+        {
+            int32_t i = 0;
+            while (i < n && better(levels[i].price, price)) ++i;
+            if (i < n && levels[i].price == price) {
+                levels[i].qty += qty;
+                return;
+            }
+            if (i >= count) return;
+
+            //! 挤出的最差档不会再回到前 count 档: 之后只有更优的价位才能挤掉它前面的档
+            for (int32_t j = std::min(n, count - 1); j > i; --j) levels[j] = levels[j - 1];
+            levels[i] = {price, qty};
+            if (n < count) ++n;
+        }
+
+        /*!
+         * @brief 快照档位余量与挂单合并后的前 count 档, 不构造完整的 map, 不分配内存
+        */
+        template<typename Levels, typename Queue>
+        int32_t top_depth(const Levels &book, const Queue &queue, type::data::PriceLevel *levels,
+                          int32_t count) noexcept
+        {
+            if (count <= 0) return 0;
+            const auto better = book.key_comp();
+
+            int32_t n = 0;
+            int32_t seen = 0;
+            //! 档位表本身有序, 前 count 个之后的档位不可能进入前 count 档
+            for (auto it = book.begin(); seen < count && it != book.end(); ++it, ++seen) {
+                add_top(levels, n, count, it->first, it->second, better);
+            }
+            for (const auto &order: queue) {
+                add_top(levels, n, count, order.price, order.qty, better);
+            }
+            return n;
+        }
+
+        template<typename Vector>
+        size_t vector_bytes(const Vector &vector) noexcept
+        {
+            return vector.capacity() * sizeof(typename Vector::value_type);
+        }
+    }
+
+    uint64_t OrderBook::hash_order(bool buy, const type::data::Order &order) noexcept
+    {
+        return order_digest(buy, order.price, order.qty,
+                            order.exchange == type::data::Exchange::SH ? order.origin_order_id : order.order_id);
+    }
+
+    void OrderBook::rehash() noexcept
+    {
+        digest_ = 0;
+        for (const auto &order: bids_) digest_ += hash_order(true, order);
+        for (const auto &order: asks_) digest_ += hash_order(false, order);
+    }
+
+    size_t OrderBook::bid_size() const noexcept
+    {
+        return compact_ ? compact_->bids.size() : bids_.size();
+    }
+
+    size_t OrderBook::ask_size() const noexcept
+    {
+        return compact_ ? compact_->asks.size() : asks_.size();
+    }
+
+    std::map<double, int64_t> OrderBook::get_ask_book() const noexcept
+    {
+        std::map<double, int64_t> ask{ask_levels_};
+        if (compact_) {
+            add_levels(ask, compact_->asks);
+        } else {
+            add_levels(ask, asks_);
+        }
+        return ask;
+    }
+
+    std::map<double, int64_t, std::greater<>> OrderBook::get_bid_book() const noexcept
+    {
+        std::map<double, int64_t, std::greater<>> bid{bid_levels_};
+        if (compact_) {
+            add_levels(bid, compact_->bids);
+        } else {
+            add_levels(bid, bids_);
+        }
+        return bid;
+    }
+
+    int32_t OrderBook::bid_depth(type::data::PriceLevel *levels, int32_t count) const
+    {
+        return compact_ ? top_depth(bid_levels_, compact_->bids, levels, count)
+                        : top_depth(bid_levels_, bids_, levels, count);
+    }
+
+    int32_t OrderBook::ask_depth(type::data::PriceLevel *levels, int32_t count) const
+    {
+        return compact_ ? top_depth(ask_levels_, compact_->asks, levels, count)
+                        : top_depth(ask_levels_, asks_, levels, count);
+    }
+
+    Bbo OrderBook::bbo() const
+    {
+        Bbo bbo;
+        bid_depth(&bbo.bid, 1);
+        ask_depth(&bbo.ask, 1);
+        return bbo;
+    }
+
+    void OrderBook::compact()
+    {
+        if (compact_) return;
+
+        //! 挂单保持到达顺序: reconcile 按时间从早到晚裁剪, get_*_queue 也按到达顺序返回; 按价格聚合只在读取时做
+        auto compact = std::make_unique<Compact>();
+        compact->bids.assign(bids_.begin(), bids_.end());
+        compact->asks.assign(asks_.begin(), asks_.end());
+        compact->late_orders.assign(late_orders_.begin(), late_orders_.end());
+        std::sort(compact->late_orders.begin(), compact->late_orders.end());
+
+        //! 以空容器替换, clear 不会释放哈希表的桶数组
+        bids_ = OrderQueue{};
+        asks_ = OrderQueue{};
+        late_orders_ = decltype(late_orders_){};
+        bid_book_snapshot_ = decltype(bid_book_snapshot_){};
+        ask_book_snapshot_ = decltype(ask_book_snapshot_){};
+        compact_ = std::move(compact);
+    }
+
+    void OrderBook::expand()
+    {
+        if (!compact_) return;
+
+        bids_.assign(compact_->bids.begin(), compact_->bids.end());
+        asks_.assign(compact_->asks.begin(), compact_->asks.end());
+        late_orders_.reserve(compact_->late_orders.size());
+        late_orders_.insert(compact_->late_orders.begin(), compact_->late_orders.end());
+        compact_.reset();
+    }
+
+    BookMemory OrderBook::memory() const noexcept
+    {
+        BookMemory memory;
+        memory.orders = size();
+        memory.levels = bid_levels_.size() + ask_levels_.size() +
+                        bid_book_snapshot_.size() + ask_book_snapshot_.size();
+        memory.bytes = sizeof(OrderBook) + tree_bytes(bid_levels_) + tree_bytes(ask_levels_) +
+                       tree_bytes(bid_book_snapshot_) + tree_bytes(ask_book_snapshot_);
+
+        if (compact_) {
+            memory.late_orders = compact_->late_orders.size();
+            memory.bytes += sizeof(Compact) + vector_bytes(compact_->bids) + vector_bytes(compact_->asks) +
+                            vector_bytes(compact_->late_orders);
+        } else {
+            memory.late_orders = late_orders_.size();
+            memory.bytes += (bids_.size() + asks_.size()) * LIST_NODE<type::data::Order> +
+                            late_orders_.size() * HASH_NODE<decltype(late_orders_)::value_type> +
+                            late_orders_.bucket_count() * sizeof(void *);
+        }
+        return memory;
+    }
+
 #if 0
     std::string OrderBook::print_order_book(int count_limit) const {
         std::string msg;
@@ -0,0 +1,109 @@
+#include "book/resync.h"
+
+#include "book/quote.h"
+#include "log/logger.h"
+#include "timestamp.h"
+
+namespace x2h::book
+{
+    namespace
+    {
+        uint64_t channel_key(type::data::Exchange exchange, int32_t channel) noexcept
+        {
+            return static_cast<uint64_t>(exchange) << 32 | static_cast<uint32_t>(channel);
+        }
+    }
+
+    Resync::Resync(BookSet &books, bool late_start)
+            : books_(books),
+              late_start_(late_start)
+    {}
+
+    OrderBook *Resync::apply(const type::data::Event &event)
+    {
+        if (gap_detection_) {
+            const auto key = BookSet::key(event.ticker());
+            if (event.type == type::data::EventType::ORDER) {
+                check_sequence(key, event.order.exchange, event.order.channel_no, event.order.business_no);
+            } else {
+                check_sequence(key, event.trade.exchange, event.trade.channel_id, event.trade.business_no);
+            }
+        }
+        return books_.apply(event);
+    }
+
+    /*!
+     * @brief 同一频道的逐笔委托与成交共用连续序号, 跳号说明丢失了记录,
+     *        但无法得知丢失的记录属于哪只股票, 因此整个频道上的股票都等待校正
+    */
+    void Resync::check_sequence(uint64_t key, type::data::Exchange exchange, int32_t channel_no, int64_t seq)
+    {
+        const auto channel = channel_key(exchange, channel_no);
+        channels_.try_emplace(key, channel);
+
+        auto [it, inserted] = sequences_.try_emplace(channel, seq);
+        if (inserted) return;
+
+        int64_t last = it->second;
+        //! 重复或乱序的记录不影响序号
+        if (seq <= last) return;
+        it->second = seq;
+        if (seq == last + 1) return;
+
+        ++gaps_;
+        size_t marked = 0;
+        for (const auto &[book, on]: channels_) {
+            if (on != channel) continue;
+            stale_.insert(book);
+            ++marked;
+        }
+        log::debug("频道 {} 序号缺口 {} -> {}, 等待校正: {}", channel_no, last, seq, marked);
+    }
+
+    bool Resync::on_snapshot(const SSEL2_Quotation &quote)
+    {
+        return resync(quote, type::data::Exchange::SH, util::hhmmssmmm_to_ns(quote.Time));
+    }
+
+    bool Resync::on_snapshot(const SZSEL2_Quotation &quote)
+    {
+        return resync(quote, type::data::Exchange::SZ, util::yyyymmddhhmmssmmm_to_ns(quote.Time));
+    }
+
+    template<typename Quotation>
+    bool Resync::resync(const Quotation &quote, type::data::Exchange exchange, int64_t time_ns)
+    {
+        //! 集合竞价阶段的快照是虚拟撮合结果, 不能用来校正
+        if (time_ns < util::CONTINUOUS_TRADING_NS) return false;
+
+        const auto key = BookSet::key(quote.Symbol);
+        auto *book = books_.find(key);
+        bool pending = stale_.count(key) > 0 || (late_start_ && seeded_.count(key) == 0);
+        if (!pending && (book == nullptr || !book->hybrid())) return false;
+
+        if (book == nullptr) {
+            book = books_.get_or_create(quote.Symbol, exchange);
+            if (book == nullptr) return false;
+        }
+
+        type::data::PriceLevel bids[QUOTE_LEVELS];
+        type::data::PriceLevel asks[QUOTE_LEVELS];
+        book->resync(bids, quote_levels(quote.BuyLevel, quote.BuyLevelNo, bids),
+                     asks, quote_levels(quote.SellLevel, quote.SellLevelNo, asks));
+
+        seeded_.insert(key);
+        stale_.erase(key);
+        ++resyncs_;
+        return true;
+    }
+
+    void Resync::report() const
+    {
+        size_t hybrid = 0;
+        for (const auto &[key, book]: books_) {
+            if (book->hybrid()) ++hybrid;
+        }
+        log::info("快照校正: resyncs: {}, gaps: {}, seeded: {}, hybrid: {}, pending: {}",
+                  resyncs_, gaps_, seeded_.size(), hybrid, stale_.size());
+    }
+}
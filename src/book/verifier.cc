@@ -0,0 +1,146 @@
+#include "book/verifier.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "fmt/format.h"
+#include "log/logger.h"
+
+namespace x2h::book
+{
+    namespace
+    {
+        template<size_t N>
+        std::string join(const std::array<uint64_t, N> &values)
+        {
+            std::string out;
+            for (size_t i = 0; i < N; ++i) {
+                if (i > 0) out += ' ';
+                out += std::to_string(values[i]);
+            }
+            return out;
+        }
+    }
+
+    Verifier::Verifier(size_t capacity, double tolerance, pipeline::WaitStrategy strategy)
+            : tolerance_(tolerance),
+              queue_(capacity),
+              waiter_(strategy)
+    {
+        thread_ = std::thread(&Verifier::run, this);
+    }
+
+    Verifier::~Verifier()
+    {
+        stop();
+    }
+
+    void Verifier::stop()
+    {
+        if (stopped_) return;
+        stopped_ = true;
+
+        queue_.close();
+        waiter_.notify();
+        if (thread_.joinable()) thread_.join();
+    }
+
+    void Verifier::copy_book(const OrderBook &book, VerifySample &sample)
+    {
+        //! 在盘口线程上执行, 只取前 VERIFY_LEVELS 档, 不构造完整盘口
+        sample.book_count[0] = book.bid_depth(sample.book[0], VERIFY_LEVELS);
+        sample.book_count[1] = book.ask_depth(sample.book[1], VERIFY_LEVELS);
+    }
+
+    void Verifier::run()
+    {
+        while (true) {
+            waiter_.wait([&] { return queue_.front() != nullptr || queue_.drained(); });
+
+            auto *sample = queue_.front();
+            if (sample == nullptr) break;
+            compare(*sample);
+            queue_.pop();
+        }
+    }
+
+    /*!
+     * @brief 逐档比较价格与数量, 一侧缺档视为该档出错
+    */
+    void Verifier::compare(const VerifySample &sample)
+    {
+        auto &stats = stats_[FastHash::Parse(sample.ticker)];
+        ++stats.checks;
+
+        int errors = 0;
+        int first = VERIFY_LEVELS;
+        for (int side = 0; side < 2; ++side) {
+            int count = std::max(sample.book_count[side], sample.quote_count[side]);
+            for (int i = 0; i < count; ++i) {
+                bool equal = i < sample.book_count[side] && i < sample.quote_count[side] &&
+                             std::abs(sample.book[side][i].price - sample.quote[side][i].price) <= tolerance_ &&
+                             sample.book[side][i].qty == sample.quote[side][i].qty;
+                if (equal) continue;
+
+                ++errors;
+                ++stats.level_errors[side][i];
+                first = std::min(first, i);
+            }
+        }
+
+        ++stats.error_count[errors];
+        if (errors == 0) return;
+
+        ++stats.mismatches;
+        ++stats.first_level[first];
+        if (stats.first_divergence == 0) {
+            stats.first_divergence = sample.time;
+            log::debug("{} 首次偏离, 快照时间: {}, 盘口时间: {}, 出错档位数: {}",
+                       sample.ticker, sample.time, sample.book_time, errors);
+        }
+        stats.last_divergence = sample.time;
+    }
+
+    void Verifier::report(size_t top) const
+    {
+        VerifyStats total{};
+        size_t diverged = 0;
+        std::vector<std::pair<uint64_t, const VerifyStats *>> ranked;
+
+        for (const auto &[key, stats]: stats_) {
+            total.checks += stats.checks;
+            total.mismatches += stats.mismatches;
+            for (int side = 0; side < 2; ++side) {
+                for (int i = 0; i < VERIFY_LEVELS; ++i) total.level_errors[side][i] += stats.level_errors[side][i];
+            }
+            for (size_t i = 0; i < total.first_level.size(); ++i) total.first_level[i] += stats.first_level[i];
+            for (size_t i = 0; i < total.error_count.size(); ++i) total.error_count[i] += stats.error_count[i];
+            if (stats.mismatches > 0) {
+                ++diverged;
+                ranked.emplace_back(key, &stats);
+            }
+        }
+
+        log::info("盘口校验: symbols: {}, diverged: {}, checks: {}, mismatches: {}, dropped: {}",
+                  stats_.size(), diverged, total.checks, total.mismatches, dropped_);
+        if (total.mismatches == 0) return;
+
+        log::info("出错档位(买): {}", join(total.level_errors[0]));
+        log::info("出错档位(卖): {}", join(total.level_errors[1]));
+        log::info("最浅出错档位: {}", join(total.first_level));
+        log::info("每次出错档位数: {}", join(total.error_count));
+
+        size_t n = std::min(top, ranked.size());
+        std::partial_sort(ranked.begin(), ranked.begin() + static_cast<std::ptrdiff_t>(n), ranked.end(),
+                          [](const auto &a, const auto &b) { return a.second->mismatches > b.second->mismatches; });
+        for (size_t i = 0; i < n; ++i) {
+            const auto &stats = *ranked[i].second;
+            char ticker[9]{};
+            std::memcpy(ticker, &ranked[i].first, sizeof(ranked[i].first));
+            log::info("{}: checks: {}, mismatches: {}, first: {}, last: {}, 最浅出错档位: {}",
+                      ticker, stats.checks, stats.mismatches, stats.first_divergence, stats.last_divergence,
+                      join(stats.first_level));
+        }
+    }
+}
@@ -0,0 +1,734 @@
+#include "dat/generator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <unordered_map>
+
+#include "dat/reader.h"
+#include "log/logger.h"
+#include "mdt/MDTStruct.h"
+#include "timestamp.h"
+#include "utils.h"
+
+namespace x2h::dat
+{
+    namespace
+    {
+        using ConfigMap = std::unordered_map<std::string, std::string>;
+
+        int64_t get_int(const ConfigMap &config, const std::string &key, int64_t def)
+        {
+            auto it = config.find(key);
+            return (it == config.end() || it->second.empty()) ? def : std::stoll(it->second);
+        }
+
+        double get_double(const ConfigMap &config, const std::string &key, double def)
+        {
+            auto it = config.find(key);
+            return (it == config.end() || it->second.empty()) ? def : std::stod(it->second);
+        }
+
+        constexpr int64_t AUCTION_BEGIN_NS = util::hhmmssmmm_to_ns(9'15'00'000);
+        constexpr int64_t AUCTION_END_NS = util::hhmmssmmm_to_ns(9'25'00'000);
+        constexpr int64_t MORNING_END_NS = util::hhmmssmmm_to_ns(11'30'00'000);
+        constexpr int64_t AFTERNOON_BEGIN_NS = util::hhmmssmmm_to_ns(13'00'00'000);
+        constexpr int64_t CLOSE_NS = util::hhmmssmmm_to_ns(15'00'00'000);
+
+        /* 一手 */
+        constexpr int64_t LOT = 100;
+        /* 行情接收相对交易所时间的延迟 */
+        constexpr int64_t FEED_LATENCY_US = 200;
+        constexpr size_t FLUSH_SIZE = 1 << 20;
+
+        static_assert(sizeof(Header) + sizeof(SZSEL2_Quotation) <= INT16_MAX &&
+                      sizeof(Header) + sizeof(SSEL2_Quotation) <= INT16_MAX, "记录长度超出 Header 的表示范围");
+
+        /*
+         * 随机数只依赖 mt19937_64 的输出, 不使用标准库的分布,
+         * 因为其实现随标准库而不同, 会破坏跨平台的可重现性
+        */
+        double uniform(std::mt19937_64 &rng) noexcept
+        {
+            return static_cast<double>(rng() >> 11) * 0x1.0p-53;
+        }
+
+        bool chance(std::mt19937_64 &rng, double p) noexcept
+        {
+            return uniform(rng) < p;
+        }
+
+        double exponential(std::mt19937_64 &rng) noexcept
+        {
+            return -std::log(1.0 - uniform(rng));
+        }
+
+        double normal(std::mt19937_64 &rng) noexcept
+        {
+            double u1 = 1.0 - uniform(rng);
+            double u2 = uniform(rng);
+            return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * M_PI * u2);
+        }
+
+        /*!
+         * @brief 成功概率为 p 的几何分布, 取值 0, 1, 2, ...
+        */
+        int64_t geometric(std::mt19937_64 &rng, double p) noexcept
+        {
+            return static_cast<int64_t>(std::log(1.0 - uniform(rng)) / std::log(1.0 - p));
+        }
+
+        double price_of(int64_t tick) noexcept
+        {
+            return static_cast<double>(tick) / 100.0;
+        }
+    }
+
+    GeneratorConfig GeneratorConfig::load(const std::string &file_path)
+    {
+        auto config = util::read_config(file_path);
+        GeneratorConfig result;
+
+        result.output = config["gen.output"];
+        result.seed = static_cast<uint64_t>(get_int(config, "gen.seed", 1));
+        result.date = get_int(config, "gen.date", result.date);
+        result.sh_symbols = static_cast<size_t>(get_int(config, "gen.sh_symbols", 100));
+        result.sz_symbols = static_cast<size_t>(get_int(config, "gen.sz_symbols", 100));
+        result.channels = std::max(1, static_cast<int>(get_int(config, "gen.channels", 4)));
+        result.events = static_cast<uint64_t>(get_int(config, "gen.events", 1'000'000));
+        result.rate = get_double(config, "gen.rate", result.rate);
+        result.cancel_ratio = get_double(config, "gen.cancel_ratio", result.cancel_ratio);
+        result.aggressive_ratio = get_double(config, "gen.aggressive_ratio", result.aggressive_ratio);
+        result.volatility = get_double(config, "gen.volatility", result.volatility);
+        result.auction_burst = get_double(config, "gen.auction_burst", result.auction_burst);
+        result.out_of_order = get_double(config, "gen.out_of_order", result.out_of_order);
+        result.snapshot_ms = get_int(config, "gen.snapshot_ms", result.snapshot_ms);
+        result.max_depth = static_cast<size_t>(get_int(config, "gen.max_depth", 2'000));
+        result.skew = get_double(config, "gen.skew", result.skew);
+        return result;
+    }
+
+    /*!
+     * @brief 单个股票的模型盘口与行情统计, 价格以分(0.01 元)为单位
+    */
+    struct Generator::Security
+    {
+        struct Resting
+        {
+            int64_t id;
+            int64_t qty;
+        };
+
+        struct Live
+        {
+            bool buy;
+            int64_t tick;
+            /* 在 ids 中的下标 */
+            size_t pos;
+        };
+
+        size_t index{0};
+        char code[8]{};
+        bool sh{true};
+        size_t channel{0};
+
+        int64_t prev_close{0};
+        int64_t up_limit{0};
+        int64_t down_limit{0};
+        double mid{0};
+
+        int64_t open{0};
+        int64_t high{0};
+        int64_t low{0};
+        int64_t last{0};
+        uint64_t total_no{0};
+        int64_t total_volume{0};
+        double total_amount{0};
+        bool dirty{false};
+
+        std::map<int64_t, std::deque<Resting>, std::greater<>> bids;
+        std::map<int64_t, std::deque<Resting>> asks;
+        /* 挂单序号, 用于随机选择撤单 */
+        std::vector<int64_t> ids;
+        std::unordered_map<int64_t, Live> live;
+
+        int64_t best_bid() const noexcept
+        { return bids.empty() ? 0 : bids.begin()->first; }
+
+        int64_t best_ask() const noexcept
+        { return asks.empty() ? 0 : asks.begin()->first; }
+
+        void rest(int64_t id, bool buy, int64_t tick, int64_t qty)
+        {
+            live[id] = {buy, tick, ids.size()};
+            ids.push_back(id);
+            if (buy) {
+                bids[tick].push_back({id, qty});
+            } else {
+                asks[tick].push_back({id, qty});
+            }
+        }
+
+        /*!
+         * @brief 从挂单索引中移除, 价位队列由调用方维护
+        */
+        void forget(int64_t id)
+        {
+            auto it = live.find(id);
+            size_t pos = it->second.pos;
+            live[ids.back()].pos = pos;
+            ids[pos] = ids.back();
+            ids.pop_back();
+            live.erase(it);
+        }
+
+        void on_trade(int64_t tick, int64_t qty)
+        {
+            if (open == 0) open = high = low = tick;
+            high = std::max(high, tick);
+            low = std::min(low, tick);
+            last = tick;
+            ++total_no;
+            total_volume += qty;
+            total_amount += price_of(tick) * static_cast<double>(qty);
+            mid = static_cast<double>(tick);
+        }
+    };
+
+    struct Generator::Channel
+    {
+        int32_t id{0};
+        /* 深证: 委托与成交共用的消息记录号; 上证: 业务序号 */
+        int64_t rec{0};
+        /* 上证委托/成交各自的序号与原始订单号 */
+        int64_t order_rec{0};
+        int64_t trade_rec{0};
+        int64_t order_id{0};
+    };
+
+    struct Generator::Record
+    {
+        int32_t type;
+        uint32_t offset;
+        uint32_t len;
+    };
+
+    namespace
+    {
+        /*!
+         * @brief 按价格优先, 时间优先吃掉对手盘中与 crosses 交叉的挂单
+         * @return 剩余数量
+        */
+        template<typename Levels, typename Crosses, typename OnFill>
+        int64_t sweep(Levels &levels, Crosses crosses, int64_t qty, OnFill on_fill)
+        {
+            while (qty > 0 && !levels.empty() && crosses(levels.begin()->first)) {
+                const int64_t tick = levels.begin()->first;
+                auto &queue = levels.begin()->second;
+                auto &resting = queue.front();
+
+                int64_t fill = std::min(qty, resting.qty);
+                resting.qty -= fill;
+                qty -= fill;
+                on_fill(resting.id, tick, fill, resting.qty == 0);
+
+                if (resting.qty == 0) queue.pop_front();
+                if (queue.empty()) levels.erase(levels.begin());
+            }
+            return qty;
+        }
+
+        template<typename Levels>
+        int64_t remove_resting(Levels &levels, int64_t tick, int64_t id)
+        {
+            auto level = levels.find(tick);
+            auto &queue = level->second;
+            auto it = std::find_if(queue.begin(), queue.end(), [&](const auto &r) { return r.id == id; });
+            int64_t qty = it->qty;
+            queue.erase(it);
+            if (queue.empty()) levels.erase(level);
+            return qty;
+        }
+
+        template<typename Levels, typename Level, typename Queue>
+        unsigned copy_levels(const Levels &levels, Level *out, unsigned &queue_no, Queue *queue)
+        {
+            unsigned n = 0;
+            for (const auto &[tick, orders]: levels) {
+                if (n >= LEVEL_TEN) break;
+                int64_t volume = 0;
+                for (const auto &order: orders) volume += order.qty;
+                out[n].Price = price_of(tick);
+                out[n].Volume = static_cast<decltype(out[n].Volume)>(volume);
+                out[n].TotalOrderNo = static_cast<decltype(out[n].TotalOrderNo)>(orders.size());
+
+                if (n == 0) {
+                    //! 揭示一档的前 50 笔委托
+                    queue_no = 0;
+                    for (const auto &order: orders) {
+                        if (queue_no >= ORDER_LEVEL_FIFTY) break;
+                        queue[queue_no++] = static_cast<Queue>(order.qty);
+                    }
+                }
+                ++n;
+            }
+            return n;
+        }
+    }
+
+    Generator::Generator(GeneratorConfig config)
+            : config_(std::move(config)),
+              rng_(config_.seed)
+    {
+        if (config_.rate <= 0) config_.rate = 1;
+        create_securities();
+    }
+
+    Generator::~Generator()
+    {
+        if (file_ != nullptr) std::fclose(file_);
+    }
+
+    void Generator::create_securities()
+    {
+        for (int i = 0; i < config_.channels; ++i) {
+            channels_.push_back({1 + i});
+        }
+        for (int i = 0; i < config_.channels; ++i) {
+            channels_.push_back({2011 + i});
+        }
+
+        const size_t total = config_.sh_symbols + config_.sz_symbols;
+        for (size_t i = 0; i < total; ++i) {
+            auto security = std::make_unique<Security>();
+            security->index = i;
+            security->sh = i < config_.sh_symbols;
+            size_t n = security->sh ? i : i - config_.sh_symbols;
+            std::snprintf(security->code, sizeof(security->code), "%06zu", security->sh ? 600000 + n : 1 + n);
+            security->channel = (security->sh ? 0 : config_.channels) + n % config_.channels;
+
+            //! 昨收 3~50 元, 涨跌停 10%
+            security->prev_close = 300 + static_cast<int64_t>(rng_() % 4'700);
+            security->up_limit = std::llround(static_cast<double>(security->prev_close) * 1.1);
+            security->down_limit = std::llround(static_cast<double>(security->prev_close) * 0.9);
+            security->mid = static_cast<double>(security->prev_close);
+            securities_.push_back(std::move(security));
+        }
+
+        //! 活跃度按 Zipf 分布随机分配给各股票, 洗牌不用 std::shuffle 以保证可重现
+        std::vector<size_t> ranks(total);
+        for (size_t i = 0; i < total; ++i) ranks[i] = i;
+        for (size_t i = total; i > 1; --i) {
+            std::swap(ranks[i - 1], ranks[rng_() % i]);
+        }
+
+        double sum = 0;
+        weights_.resize(total);
+        for (size_t i = 0; i < total; ++i) {
+            sum += 1.0 / std::pow(static_cast<double>(ranks[i] + 1), config_.skew);
+            weights_[i] = sum;
+        }
+    }
+
+    size_t Generator::pick_security()
+    {
+        double u = uniform(rng_) * weights_.back();
+        auto it = std::upper_bound(weights_.begin(), weights_.end(), u);
+        return std::min(static_cast<size_t>(it - weights_.begin()), weights_.size() - 1);
+    }
+
+    uint64_t Generator::mdt_time() noexcept
+    {
+        //! 接收时间不回退
+        auto mdt = static_cast<uint64_t>(epoch_us_ + clock_ns_ / 1'000 + FEED_LATENCY_US);
+        last_mdt_ = std::max(last_mdt_, mdt);
+        return last_mdt_;
+    }
+
+    void Generator::push(int32_t type, const void *data, uint32_t len)
+    {
+        auto offset = static_cast<uint32_t>(scratch_.size());
+        scratch_.insert(scratch_.end(), static_cast<const char *>(data), static_cast<const char *>(data) + len);
+        pending_.push_back({type, offset, len});
+    }
+
+    void Generator::flush_records()
+    {
+        for (const auto &record: pending_) {
+            Header header{static_cast<short>(sizeof(Header) + record.len), record.type,
+                          static_cast<short>(record.len)};
+            auto *p = reinterpret_cast<const char *>(&header);
+            buffer_.insert(buffer_.end(), p, p + sizeof(header));
+            buffer_.insert(buffer_.end(), scratch_.data() + record.offset,
+                           scratch_.data() + record.offset + record.len);
+        }
+        stats_.records += pending_.size();
+        pending_.clear();
+        scratch_.clear();
+
+        if (buffer_.size() >= FLUSH_SIZE) {
+            std::fwrite(buffer_.data(), 1, buffer_.size(), file_);
+            buffer_.clear();
+        }
+    }
+
+    void Generator::emit_order(Security &security, int64_t id, bool buy, int64_t tick, int64_t qty, bool del)
+    {
+        auto &channel = channels_[security.channel];
+        const int64_t time = util::ns_to_hhmmssmmm(clock_ns_);
+
+        if (security.sh) {
+            SSEL2_Order order{};
+            order.MDTTime = mdt_time();
+            order.RecID = static_cast<unsigned>(++channel.order_rec);
+            order.SetID = channel.id;
+            std::strcpy(order.Symbol, security.code);
+            order.Time = static_cast<int>(time);
+            order.OrderType = del ? 'D' : 'A';
+            order.OrderID = id;
+            order.OrderPrice = price_of(tick);
+            order.Balance = static_cast<double>(qty);
+            order.OrderCode[0] = buy ? 'B' : 'S';
+            order.RecNO = ++channel.rec;
+            push(Msg_SSEL2_Order, &order, sizeof(order));
+        } else {
+            SZSEL2_Order order{};
+            order.MDTTime = mdt_time();
+            order.SetID = static_cast<unsigned>(channel.id);
+            order.RecID = static_cast<unsigned long long>(id);
+            std::strcpy(order.Symbol, security.code);
+            std::strcpy(order.SymbolSource, "102");
+            order.Time = config_.date * 1'000'000'000 + time;
+            order.OrderPrice = price_of(tick);
+            order.OrderVolume = static_cast<double>(qty);
+            order.OrderCode = buy ? '1' : '2';
+            order.OrderType = '2';
+            push(Msg_SZSEL2_Order, &order, sizeof(order));
+        }
+        security.dirty = true;
+    }
+
+    void Generator::emit_trade(Security &security, int64_t bid_id, int64_t ask_id, int64_t tick, int64_t qty,
+                               char flag)
+    {
+        auto &channel = channels_[security.channel];
+        const int64_t time = util::ns_to_hhmmssmmm(clock_ns_);
+
+        if (security.sh) {
+            SSEL2_Transaction trade{};
+            trade.MDTTime = mdt_time();
+            trade.TradeTime = static_cast<int>(time);
+            trade.RecID = static_cast<unsigned>(++channel.trade_rec);
+            trade.TradeChannel = channel.id;
+            std::strcpy(trade.Symbol, security.code);
+            trade.TradePrice = price_of(tick);
+            trade.TradeVolume = static_cast<unsigned>(qty);
+            trade.TradeAmount = price_of(tick) * static_cast<double>(qty);
+            trade.BuyRecID = bid_id;
+            trade.SellRecID = ask_id;
+            trade.BuySellFlag = flag;
+            trade.RecNO = ++channel.rec;
+            push(Msg_SSEL2_Transaction, &trade, sizeof(trade));
+        } else {
+            SZSEL2_Transaction trade{};
+            trade.MDTTime = mdt_time();
+            trade.SetID = static_cast<unsigned>(channel.id);
+            trade.RecID = static_cast<unsigned long long>(++channel.rec);
+            trade.BuyOrderID = static_cast<unsigned long long>(bid_id);
+            trade.SellOrderID = static_cast<unsigned long long>(ask_id);
+            std::strcpy(trade.Symbol, security.code);
+            std::strcpy(trade.SymbolSource, "102");
+            trade.TradeTime = config_.date * 1'000'000'000 + time;
+            trade.TradePrice = price_of(tick);
+            trade.TradeVolume = static_cast<double>(qty);
+            trade.TradeType = flag;
+            push(Msg_SZSEL2_Transaction, &trade, sizeof(trade));
+        }
+        security.dirty = true;
+    }
+
+    void Generator::on_event(Security &security, bool auction)
+    {
+        if (!security.dirty) dirty_.push_back(security.index);
+
+        const double p_cancel = config_.cancel_ratio / (1.0 + config_.cancel_ratio);
+        bool cancel = !security.ids.empty() &&
+                      (security.ids.size() >= config_.max_depth || chance(rng_, p_cancel));
+        if (cancel) {
+            cancel_order(security);
+        } else {
+            add_order(security, auction);
+        }
+    }
+
+    void Generator::add_order(Security &security, bool auction)
+    {
+        //! 中间价做对数随机游走, 限制在涨跌停之内
+        security.mid *= std::exp(config_.volatility * normal(rng_));
+        security.mid = std::clamp(security.mid, static_cast<double>(security.down_limit),
+                                  static_cast<double>(security.up_limit));
+
+        const bool buy = chance(rng_, 0.5);
+        const int64_t qty = LOT * (1 + geometric(rng_, 0.3));
+        const int64_t mid = std::llround(security.mid);
+        int64_t tick;
+
+        if (auction) {
+            //! 集合竞价阶段不撮合, 买卖价可以交叉
+            tick = std::llround(security.mid + 3.0 * normal(rng_));
+        } else if (chance(rng_, config_.aggressive_ratio) && (buy ? !security.asks.empty() : !security.bids.empty())) {
+            int64_t through = geometric(rng_, 0.6);
+            tick = buy ? security.best_ask() + through : security.best_bid() - through;
+        } else {
+            int64_t offset = 1 + geometric(rng_, 0.3);
+            tick = buy ? mid - offset : mid + offset;
+            if (buy && !security.asks.empty()) tick = std::min(tick, security.best_ask() - 1);
+            if (!buy && !security.bids.empty()) tick = std::max(tick, security.best_bid() + 1);
+        }
+        tick = std::clamp(tick, security.down_limit, security.up_limit);
+
+        ++stats_.orders;
+        auto &channel = channels_[security.channel];
+        const int64_t id = security.sh ? ++channel.order_id : ++channel.rec;
+
+        //! 深证先写委托再写成交; 上证只写成交后的剩余部分, 且在成交之后
+        if (!security.sh) emit_order(security, id, buy, tick, qty, false);
+        const size_t first_trade = pending_.size();
+
+        int64_t remaining = qty;
+        if (!auction) {
+            auto on_fill = [&](int64_t resting, int64_t at, int64_t fill, bool done) {
+                char flag = security.sh ? (buy ? 'B' : 'S') : 'F';
+                emit_trade(security, buy ? id : resting, buy ? resting : id, at, fill, flag);
+                security.on_trade(at, fill);
+                if (done) security.forget(resting);
+                ++stats_.trades;
+            };
+            if (buy) {
+                remaining = sweep(security.asks, [&](int64_t ask) { return ask <= tick; }, qty, on_fill);
+            } else {
+                remaining = sweep(security.bids, [&](int64_t bid) { return bid >= tick; }, qty, on_fill);
+            }
+        }
+
+        if (remaining > 0) {
+            security.rest(id, buy, tick, remaining);
+            if (security.sh) emit_order(security, id, buy, tick, remaining, false);
+        }
+
+        //! 乱序: 深证成交先于委托, 上证剩余委托先于成交
+        const bool traded = pending_.size() > first_trade + (security.sh && remaining > 0 ? 1 : 0);
+        if (traded && chance(rng_, config_.out_of_order)) {
+            if (security.sh) {
+                std::rotate(pending_.begin(), pending_.end() - 1, pending_.end());
+            } else {
+                std::rotate(pending_.begin(), pending_.begin() + 1, pending_.end());
+            }
+            ++stats_.out_of_order;
+        }
+    }
+
+    void Generator::cancel_order(Security &security)
+    {
+        const int64_t id = security.ids[rng_() % security.ids.size()];
+        const auto live = security.live[id];
+        const int64_t qty = live.buy ? remove_resting(security.bids, live.tick, id)
+                                     : remove_resting(security.asks, live.tick, id);
+        security.forget(id);
+        ++stats_.cancels;
+
+        if (security.sh) {
+            //! 上证撤单以 OrderType = 'D' 的委托发布
+            emit_order(security, id, live.buy, live.tick, qty, true);
+        } else {
+            //! 深证撤单以 TradeType = '4' 的成交发布, 价格为 0
+            emit_trade(security, live.buy ? id : 0, live.buy ? 0 : id, 0, qty, '4');
+        }
+    }
+
+    /*!
+     * @brief 开盘集合竞价撮合: 取成交量最大的价格, 同量时取最接近中间价的价格
+    */
+    void Generator::uncross(Security &security)
+    {
+        if (security.bids.empty() || security.asks.empty() || security.best_bid() < security.best_ask()) return;
+
+        int64_t price = 0;
+        int64_t best_volume = -1;
+        const auto mid = static_cast<double>(security.mid);
+        for (int64_t tick = security.best_ask(); tick <= security.best_bid(); ++tick) {
+            int64_t buy_volume = 0;
+            int64_t sell_volume = 0;
+            for (auto it = security.bids.begin(); it != security.bids.end() && it->first >= tick; ++it) {
+                for (const auto &order: it->second) buy_volume += order.qty;
+            }
+            for (auto it = security.asks.begin(); it != security.asks.end() && it->first <= tick; ++it) {
+                for (const auto &order: it->second) sell_volume += order.qty;
+            }
+            int64_t volume = std::min(buy_volume, sell_volume);
+            if (volume > best_volume ||
+                (volume == best_volume && std::abs(tick - mid) < std::abs(price - mid))) {
+                best_volume = volume;
+                price = tick;
+            }
+        }
+
+        while (!security.bids.empty() && !security.asks.empty() &&
+               security.best_bid() >= price && security.best_ask() <= price) {
+            auto &bid = security.bids.begin()->second.front();
+            auto &ask = security.asks.begin()->second.front();
+            int64_t fill = std::min(bid.qty, ask.qty);
+
+            emit_trade(security, bid.id, ask.id, price, fill, security.sh ? 'N' : 'F');
+            security.on_trade(price, fill);
+            ++stats_.trades;
+            ++stats_.auction_trades;
+
+            bid.qty -= fill;
+            ask.qty -= fill;
+            if (bid.qty == 0) {
+                security.forget(bid.id);
+                security.bids.begin()->second.pop_front();
+                if (security.bids.begin()->second.empty()) security.bids.erase(security.bids.begin());
+            }
+            if (ask.qty == 0) {
+                security.forget(ask.id);
+                security.asks.begin()->second.pop_front();
+                if (security.asks.begin()->second.empty()) security.asks.erase(security.asks.begin());
+            }
+        }
+    }
+
+    void Generator::snapshot(Security &security)
+    {
+        const int64_t time = util::ns_to_hhmmssmmm(clock_ns_);
+
+        if (security.sh) {
+            SSEL2_Quotation quote{};
+            quote.MDTTime = mdt_time();
+            quote.Time = static_cast<int>(time);
+            std::strcpy(quote.Symbol, security.code);
+            quote.PreClosePrice = price_of(security.prev_close);
+            quote.OpenPrice = price_of(security.open);
+            quote.HighPrice = price_of(security.high);
+            quote.LowPrice = price_of(security.low);
+            quote.LastPrice = price_of(security.last);
+            std::strcpy(quote.TradeStatus, "TRADE");
+            quote.TotalNo = security.total_no;
+            quote.TotalVolume = static_cast<unsigned long long>(security.total_volume);
+            quote.TotalAmount = security.total_amount;
+            quote.SellLevelNo = copy_levels(security.asks, quote.SellLevel,
+                                                             quote.SellLevelQueueNo01, quote.SellLevelQueue);
+            quote.BuyLevelNo = copy_levels(security.bids, quote.BuyLevel,
+                                                            quote.BuyLevelQueueNo01, quote.BuyLevelQueue);
+            push(Msg_SSEL2_Quotation, &quote, sizeof(quote));
+        } else {
+            SZSEL2_Quotation quote{};
+            quote.MDTTime = mdt_time();
+            quote.Time = config_.date * 1'000'000'000 + time;
+            std::strcpy(quote.Symbol, security.code);
+            std::strcpy(quote.SymbolSource, "102");
+            quote.PreClosePrice = price_of(security.prev_close);
+            quote.OpenPrice = price_of(security.open);
+            quote.LastPrice = price_of(security.last);
+            quote.HighPrice = price_of(security.high);
+            quote.LowPrice = price_of(security.low);
+            quote.PriceUpLimit = price_of(security.up_limit);
+            quote.PriceDownLimit = price_of(security.down_limit);
+            quote.TotalNo = security.total_no;
+            quote.TotalVolume = static_cast<double>(security.total_volume);
+            quote.TotalAmount = security.total_amount;
+            std::strcpy(quote.SecurityPhaseTag, "T0");
+            quote.SellLevelNo = copy_levels(security.asks, quote.SellLevel,
+                                                              quote.SellLevelQueueNo01, quote.SellLevelQueue);
+            quote.BuyLevelNo = copy_levels(security.bids, quote.BuyLevel,
+                                                             quote.BuyLevelQueueNo01, quote.BuyLevelQueue);
+            push(Msg_SZSEL2_Quotation, &quote, sizeof(quote));
+        }
+        ++stats_.snapshots;
+    }
+
+    /*!
+     * @brief 输出 until_ns 之前到期的快照, 只包含上次快照之后有变化的股票
+    */
+    void Generator::emit_snapshots(int64_t until_ns)
+    {
+        if (config_.snapshot_ms <= 0) return;
+
+        const int64_t interval = config_.snapshot_ms * 1'000'000;
+        const int64_t now = clock_ns_;
+        while (next_snapshot_ns_ <= until_ns) {
+            if (!dirty_.empty()) {
+                clock_ns_ = next_snapshot_ns_;
+                for (auto index: dirty_) {
+                    snapshot(*securities_[index]);
+                    securities_[index]->dirty = false;
+                }
+                dirty_.clear();
+                flush_records();
+            }
+            next_snapshot_ns_ += interval;
+        }
+        clock_ns_ = now;
+    }
+
+    bool Generator::run(const std::string &file_path)
+    {
+        file_ = std::fopen(file_path.c_str(), "wb");
+        if (file_ == nullptr) {
+            log::error("文件 {} 创建失败", file_path);
+            return false;
+        }
+
+        epoch_us_ = util::yyyymmddhhmmssmmm_to_epoch_ns(config_.date * 1'000'000'000) / 1'000;
+        bool auction = config_.auction_burst > 0;
+        clock_ns_ = auction ? AUCTION_BEGIN_NS : util::CONTINUOUS_TRADING_NS;
+        next_snapshot_ns_ = auction ? AUCTION_END_NS : util::CONTINUOUS_TRADING_NS;
+
+        uint64_t events = 0;
+        while (config_.events == 0 || events < config_.events) {
+            double rate = auction ? config_.rate * config_.auction_burst : config_.rate;
+            clock_ns_ += std::max<int64_t>(1, static_cast<int64_t>(exponential(rng_) * 1e9 / rate));
+
+            if (auction && clock_ns_ >= AUCTION_END_NS) {
+                //! 9:25 集中撮合后直到 9:30 没有逐笔
+                clock_ns_ = AUCTION_END_NS;
+                for (auto &security: securities_) {
+                    if (!security->dirty) dirty_.push_back(security->index);
+                    uncross(*security);
+                    flush_records();
+                }
+                auction = false;
+                emit_snapshots(util::CONTINUOUS_TRADING_NS - 1);
+                clock_ns_ = util::CONTINUOUS_TRADING_NS;
+                continue;
+            }
+            if (clock_ns_ >= MORNING_END_NS && clock_ns_ < AFTERNOON_BEGIN_NS) {
+                emit_snapshots(MORNING_END_NS);
+                clock_ns_ += AFTERNOON_BEGIN_NS - MORNING_END_NS;
+                next_snapshot_ns_ = AFTERNOON_BEGIN_NS;
+            }
+            if (clock_ns_ >= CLOSE_NS) break;
+
+            if (!auction) emit_snapshots(clock_ns_);
+            on_event(*securities_[pick_security()], auction);
+            flush_records();
+            ++events;
+        }
+        emit_snapshots(std::min(clock_ns_, CLOSE_NS));
+
+        std::fwrite(buffer_.data(), 1, buffer_.size(), file_);
+        buffer_.clear();
+        bool ok = std::ferror(file_) == 0;
+        std::fclose(file_);
+        file_ = nullptr;
+
+        log::info("合成行情 {}: records: {}, orders: {}, cancels: {}, trades: {} (集合竞价 {}), snapshots: {}, "
+                  "乱序: {}, 结束时间: {}", file_path, stats_.records, stats_.orders, stats_.cancels,
+                  stats_.trades, stats_.auction_trades, stats_.snapshots, stats_.out_of_order,
+                  util::ns_to_hhmmssmmm(clock_ns_));
+        return ok;
+    }
+}
@@ -0,0 +1,110 @@
+#include "dat/mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+#include "log/logger.h"
+
+MappedFile::MappedFile(const std::string &file_path)
+{
+    open(file_path);
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+        : path_(std::move(other.path_)),
+          fd_(std::exchange(other.fd_, -1)),
+          data_(std::exchange(other.data_, nullptr)),
+          size_(std::exchange(other.size_, 0)),
+          mapped_size_(std::exchange(other.mapped_size_, 0)),
+          map_ahead_(other.map_ahead_)
+{}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+    if (this != &other) {
+        close();
+        path_ = std::move(other.path_);
+        fd_ = std::exchange(other.fd_, -1);
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        mapped_size_ = std::exchange(other.mapped_size_, 0);
+        map_ahead_ = other.map_ahead_;
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string &file_path)
+{
+    close();
+    path_ = file_path;
+
+    fd_ = ::open(file_path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        x2h::log::error("文件 {} 打开失败", file_path);
+        return false;
+    }
+
+    remap();
+    return true;
+}
+
+void MappedFile::close() noexcept
+{
+    if (data_ != nullptr) {
+        ::munmap(const_cast<char *>(data_), mapped_size_);
+        data_ = nullptr;
+    }
+    size_ = 0;
+    mapped_size_ = 0;
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+size_t MappedFile::remap()
+{
+    if (fd_ < 0) return 0;
+
+    struct stat st{};
+    if (::fstat(fd_, &st) != 0) return size_;
+
+    auto new_size = static_cast<size_t>(st.st_size);
+    if (data_ != nullptr && new_size >= size_ && new_size <= mapped_size_) {
+        //! MAP_SHARED 映射中文件末尾之后的页在文件变长后即可访问
+        size_ = new_size;
+        return size_;
+    }
+    if (new_size == size_ && data_ != nullptr) return size_;
+
+    if (data_ != nullptr) {
+        ::munmap(const_cast<char *>(data_), mapped_size_);
+        data_ = nullptr;
+    }
+    size_ = new_size;
+    mapped_size_ = 0;
+
+    if (size_ > 0) {
+        auto page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        size_t length = (size_ + map_ahead_ + page - 1) / page * page;
+
+        void *addr = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd_, 0);
+        if (addr == MAP_FAILED) {
+            x2h::log::error("文件 {} 映射失败", path_);
+            size_ = 0;
+            return 0;
+        }
+        ::madvise(addr, length, MADV_SEQUENTIAL);
+        data_ = static_cast<const char *>(addr);
+        mapped_size_ = length;
+    }
+    return size_;
+}
@@ -0,0 +1,75 @@
+#include "dat/merge_reader.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "log/logger.h"
+
+MergeReader::MergeReader(std::vector<std::string> filepaths, DatCallback callback)
+        : dat_filepaths_(std::move(filepaths)),
+          callback_(std::move(callback))
+{}
+
+uint64_t MergeReader::record_time(const Header *header) noexcept
+{
+    return DatReader::record_time(header + 1, static_cast<uint16_t>(header->DataLen));
+}
+
+bool MergeReader::advance(Source &source)
+{
+    const size_t size = source.mapping.size();
+    if (source.offset + sizeof(Header) > size) return false;
+
+    auto header = (const Header *) (source.mapping.data() + source.offset);
+    if (source.offset + DatReader::record_size(*header) > size) return false;
+
+    uint64_t time = record_time(header);
+    if (time < source.time) ++out_of_order_;
+    source.time = time;
+    return true;
+}
+
+void MergeReader::read()
+{
+    std::vector<Source> sources(dat_filepaths_.size());
+    //! 小顶堆, 元素为 sources 下标
+    std::vector<size_t> heap;
+
+    auto later = [&](size_t a, size_t b) {
+        if (sources[a].time != sources[b].time) return sources[a].time > sources[b].time;
+        return a > b;
+    };
+
+    for (size_t i = 0; i < sources.size(); ++i) {
+        if (sources[i].mapping.open(dat_filepaths_[i]) && advance(sources[i])) {
+            heap.push_back(i);
+        }
+    }
+    std::make_heap(heap.begin(), heap.end(), later);
+
+    auto item = std::make_shared<Item>();
+
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), later);
+        size_t index = heap.back();
+        auto &source = sources[index];
+
+        auto header = (const Header *) (source.mapping.data() + source.offset);
+        item->DataType = (MsgType) header->DataType;
+        item->DataLen = static_cast<uint16_t>(header->DataLen);
+        item->Data = const_cast<Header *>(header + 1);
+        source.offset += DatReader::record_size(*header);
+
+        callback_(item);
+
+        if (advance(source)) {
+            std::push_heap(heap.begin(), heap.end(), later);
+        } else {
+            heap.pop_back();
+        }
+    }
+
+    if (out_of_order_ > 0) {
+        x2h::log::warn("归并输入中有 {} 条记录的 MDTTime 回退", out_of_order_);
+    }
+}
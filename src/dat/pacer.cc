@@ -0,0 +1,75 @@
+#include "dat/pacer.h"
+
+#include <bit>
+#include <thread>
+
+#include "log/logger.h"
+#include "pipeline/wait_strategy.h"
+
+int64_t Pacer::Stats::percentile(double p) const noexcept
+{
+    if (count == 0) return 0;
+
+    auto rank = static_cast<uint64_t>(p * static_cast<double>(count));
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        seen += buckets[i];
+        if (seen > rank) return i == 0 ? 0 : int64_t{1} << i;
+    }
+    return max_ns;
+}
+
+Pacer::Clock::time_point Pacer::target_of(uint64_t mdt_time) const noexcept
+{
+    //! MDTTime 回退时目标时刻早于首条记录, 直接释放
+    auto offset_us = static_cast<double>(static_cast<int64_t>(mdt_time - first_time_));
+    return first_clock_ + std::chrono::nanoseconds(static_cast<int64_t>(offset_us * 1'000 / speed_));
+}
+
+int64_t Pacer::remaining_ns(uint64_t mdt_time) const noexcept
+{
+    if (!enabled() || !started_) return 0;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(target_of(mdt_time) - Clock::now()).count();
+}
+
+int64_t Pacer::wait(uint64_t mdt_time) noexcept
+{
+    if (!enabled()) return 0;
+
+    auto now = Clock::now();
+    if (!started_) {
+        started_ = true;
+        first_time_ = mdt_time;
+        first_clock_ = now;
+    }
+
+    auto target = target_of(mdt_time);
+
+    auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(target - now).count();
+    if (remaining > spin_ns_) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(remaining - spin_ns_));
+        now = Clock::now();
+    }
+    while (now < target) {
+        x2h::pipeline::cpu_relax();
+        now = Clock::now();
+    }
+
+    int64_t lateness = std::chrono::duration_cast<std::chrono::nanoseconds>(now - target).count();
+    ++stats_.count;
+    stats_.total_ns += lateness;
+    if (lateness > stats_.max_ns) stats_.max_ns = lateness;
+    if (lateness > 1'000) ++stats_.late;
+    auto bucket = static_cast<int>(std::bit_width(static_cast<uint64_t>(lateness)));
+    ++stats_.buckets[bucket < BUCKETS ? bucket : BUCKETS - 1];
+    return lateness;
+}
+
+void Pacer::report() const
+{
+    if (stats_.count == 0) return;
+
+    x2h::log::info("重放延迟(ns): records: {}, late(>1us): {}, mean: {}, p50: {}, p99: {}, p99.9: {}, max: {}",
+                   stats_.count, stats_.late, stats_.total_ns / static_cast<int64_t>(stats_.count),
+                   stats_.percentile(0.5), stats_.percentile(0.99), stats_.percentile(0.999), stats_.max_ns);
+}
@@ -1,26 +1,109 @@
 #include "dat/reader.h"
 
-DatReader::DatReader(std::string filepath, DatCallback callback)
+#include <chrono>
+#include <thread>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "dat/mapped_file.h"
+#include "log/logger.h"
+#include "pipeline/wait_strategy.h"
+
+namespace
+{
+    /* 追踪模式每次多映射的长度 */
+    constexpr size_t FOLLOW_MAP_AHEAD = 64 << 20;
+    /* 无数据时先自旋检查的次数, 之后阻塞等待 */
+    constexpr int FOLLOW_SPIN_LIMIT = 256;
+    /* 单次阻塞等待上限, 保证及时响应 stop() 与超时 */
+    constexpr int FOLLOW_POLL_MS = 100;
+
+    /*!
+     * @brief 等待文件被写入. Linux 下用 inotify, 其它平台退化为定时轮询
+    */
+    class FileWatch
+    {
+    public:
+        explicit FileWatch(const std::string &file_path)
+        {
+#if defined(__linux__)
+            fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            if (fd_ >= 0 && ::inotify_add_watch(fd_, file_path.c_str(), IN_MODIFY | IN_CLOSE_WRITE) < 0) {
+                ::close(fd_);
+                fd_ = -1;
+            }
+#endif
+        }
+
+        ~FileWatch()
+        {
+#if defined(__linux__)
+            if (fd_ >= 0) ::close(fd_);
+#endif
+        }
+
+        FileWatch(const FileWatch &) = delete;
+
+        FileWatch &operator=(const FileWatch &) = delete;
+
+        void wait(int timeout_ms)
+        {
+#if defined(__linux__)
+            if (fd_ >= 0) {
+                //! watch 先于检查文件长度建立, 期间的写入事件会留在队列里, 不会丢失唤醒
+                pollfd pfd{fd_, POLLIN, 0};
+                if (::poll(&pfd, 1, timeout_ms) > 0) {
+                    char buf[4096];
+                    while (::read(fd_, buf, sizeof(buf)) > 0) {}
+                }
+                return;
+            }
+#endif
+            std::this_thread::sleep_for(std::chrono::milliseconds(std::min(timeout_ms, 1)));
+        }
+
+    private:
+        int fd_{-1};
+    };
+}
+
+DatReader::DatReader(std::string filepath, DatCallback callback, ReadMode mode)
         : dat_filepath_(std::move(filepath)),
-          callback_(std::move(callback))
+          callback_(std::move(callback)),
+          mode_(mode)
 {}
 
 void DatReader::bytes_stream_read()
 {
     std::FILE* file_ptr = std::fopen(dat_filepath_.c_str(), "rb");
+    if (file_ptr == nullptr) {
+        x2h::log::error("文件 {} 打开失败", dat_filepath_);
+        return;
+    }
 
-    void* head_buf = std::malloc(8);
-    void* msg_buf = std::malloc(4096);
+    void* head_buf = std::malloc(sizeof(Header));
+    void* msg_buf = std::malloc(1 << 16);
     std::shared_ptr<Item> item = std::make_shared<Item>();
 
-    while (std::fread(head_buf, 1, sizeof(head_buf), file_ptr) > 0) {
+    record_offset_ = 0;
+
+    while (!stopped_ && std::fread(head_buf, 1, sizeof(Header), file_ptr) == sizeof(Header)) {
         auto* head = (Header*)head_buf;
 
         item->DataType = (MsgType)head->DataType;
-        fread(msg_buf, 1, head->DataLen, file_ptr);
+        item->DataLen = static_cast<uint16_t>(head->DataLen);
+        if (fread(msg_buf, 1, item->DataLen, file_ptr) != item->DataLen) break;
         item->Data = msg_buf;
 
-        callback_(item);
+        if (accept(item->DataType, msg_buf, item->DataLen)) {
+            pace(msg_buf, item->DataLen);
+            callback_(item);
+        }
+        record_offset_ += record_size(*head);
     }
 
     std::free(head_buf);
@@ -33,30 +116,110 @@ void DatReader::bytes_stream_read()
 
 void DatReader::memory_map_read()
 {
-    //boost::interprocess::file_mapping mapping(dat_filepath_.c_str(), boost::interprocess::read_only);
-    //boost::interprocess::mapped_region region(mapping, boost::interprocess::read_only);
+    MappedFile mapping(dat_filepath_);
+    if (!mapping.is_open()) return;
+
+    const char* addr = mapping.data();
+    const size_t size = mapping.size();
+    size_t offset = start_offset_;
 
-    //const char* addr = (const char*)region.get_address();
-    //const size_t size = region.get_size();
-    //const size_t total_size = reinterpret_cast<size_t>(addr) + size;
+    auto item = std::make_shared<Item>();
 
-    //while (reinterpret_cast<size_t>(addr) <= total_size) {
-    //    auto header = (Header*)addr;
+    while (!stopped_ && offset + sizeof(Header) <= size) {
+        auto header = (const Header*)(addr + offset);
+        size_t total = record_size(*header);
+        //! 文件尾部不完整的记录
+        if (offset + total > size) break;
 
-    //    // auto item = new Item;
-    //    auto item = std::make_shared<Item>();
-    //    item->DataType = (MsgType)header->DataType;
-    //    item->Data = header + 1;
+        item->DataType = (MsgType)header->DataType;
+        item->DataLen = static_cast<uint16_t>(header->DataLen);
+        item->Data = const_cast<Header*>(header + 1);
 
-    //    addr += header->DataLen;
+        record_offset_ = offset;
+        offset += total;
+        if (!accept(item->DataType, item->Data, item->DataLen)) continue;
 
-    //    addr += sizeof(Header); // +8
-    //    callback_(item);
-    //
-    //}
+        pace(item->Data, item->DataLen);
+        callback_(item);
+    }
+}
+
+/*!
+ * @brief 追踪仍在写入的文件: 读到不完整记录时等待文件增长, 直到 stop() 或空闲超时
+*/
+void DatReader::follow_read()
+{
+    FileWatch watch{dat_filepath_};
+    MappedFile mapping;
+    mapping.set_map_ahead(FOLLOW_MAP_AHEAD);
+    if (!mapping.open(dat_filepath_)) return;
+
+    size_t offset = start_offset_;
+
+    auto item = std::make_shared<Item>();
+    std::chrono::steady_clock::time_point idle_since;
+    int spins = 0;
+
+    while (!stopped_) {
+        const char* addr = mapping.data();
+        const size_t size = mapping.size();
+
+        //! 记录头与数据都写完整才交付, 长度以 Header.DataLen 为准
+        if (offset + sizeof(Header) <= size) {
+            auto header = (const Header*)(addr + offset);
+            size_t total = record_size(*header);
+            if (offset + total <= size) {
+                item->DataType = (MsgType)header->DataType;
+                item->DataLen = static_cast<uint16_t>(header->DataLen);
+                item->Data = const_cast<Header*>(header + 1);
+
+                record_offset_ = offset;
+                offset += total;
+                spins = 0;
+                if (!accept(item->DataType, item->Data, item->DataLen)) continue;
+
+                pace(item->Data, item->DataLen);
+                callback_(item);
+                continue;
+            }
+        }
+
+        if (mapping.remap() > size) {
+            spins = 0;
+            continue;
+        }
+        if (mapping.size() < offset) {
+            x2h::log::error("文件 {} 被截断, 停止追踪", dat_filepath_);
+            break;
+        }
+
+        //! 从有数据转入等待时开始计算空闲时长
+        if (++spins == 1) idle_since = std::chrono::steady_clock::now();
+        if (spins < FOLLOW_SPIN_LIMIT) {
+            x2h::pipeline::cpu_relax();
+            continue;
+        }
+
+        //! 空闲时也切换订阅, 避免写线程的旧表迟迟不能回收
+        if (subscription_ != nullptr) refresh_subscription(offset);
+
+        auto idle = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - idle_since).count();
+        if (idle_timeout_ms_ > 0 && idle >= idle_timeout_ms_) break;
+
+        watch.wait(FOLLOW_POLL_MS);
+    }
 }
 
 void DatReader::read()
 {
-    bytes_stream_read();
-}
\ No newline at end of file
+    pacer_.reset();
+    if (mode_ == ReadMode::FOLLOW) {
+        follow_read();
+    } else if (mode_ == ReadMode::MMAP) {
+        memory_map_read();
+    } else {
+        bytes_stream_read();
+    }
+    if (pacer_.enabled()) pacer_.report();
+}
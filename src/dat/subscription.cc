@@ -0,0 +1,139 @@
+#include "dat/subscription.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+
+#include "log/logger.h"
+#include "utils.h"
+
+namespace
+{
+    std::vector<std::string> normalize(std::vector<std::string> symbols)
+    {
+        std::sort(symbols.begin(), symbols.end());
+        symbols.erase(std::unique(symbols.begin(), symbols.end()), symbols.end());
+        return symbols;
+    }
+
+    std::unique_ptr<SubscriptionTable> make_table(uint64_t version, const std::vector<std::string> &symbols)
+    {
+        auto table = std::make_unique<SubscriptionTable>();
+        table->version = version;
+        table->symbols = symbols;
+        table->filter = SymbolFilter{symbols};
+        return table;
+    }
+
+    /* 读线程槽位用尽时使用, 不过滤也不更新 */
+    const SubscriptionTable EMPTY_TABLE{};
+}
+
+Subscription::Subscription(std::vector<std::string> symbols)
+        : current_(normalize(std::move(symbols))),
+          table_(make_table(1, current_))
+{}
+
+bool Subscription::update(std::vector<std::string> symbols)
+{
+    symbols = normalize(std::move(symbols));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (symbols == current_) return false;
+    if (symbols.empty()) {
+        //! 空列表表示全部接受, 新增的股票无从得知, 无法从存档重建, 只会从半途的逐笔建出错误的盘口
+        x2h::log::warn("不支持由 {} 个股票切换为全部订阅, 忽略本次更新", current_.size());
+        return false;
+    }
+
+    current_ = std::move(symbols);
+    uint64_t version = version_.load(std::memory_order_relaxed) + 1;
+    table_.publish(make_table(version, current_));
+    version_.store(version, std::memory_order_release);
+
+    //! 读线程越过静默点后旧表才被释放, 未回收的留待下次
+    table_.reclaim();
+    x2h::log::info("订阅更新, version: {}, symbols: {}", version, current_.size());
+    return true;
+}
+
+Subscription::Reader::Reader(Subscription &subscription)
+        : subscription_(subscription),
+          slot_(subscription.table_.attach()),
+          table_(&EMPTY_TABLE)
+{
+    if (slot_ < 0) {
+        x2h::log::error("订阅表读线程数超过上限 {}", RcuPtr<SubscriptionTable>::MAX_READERS);
+        return;
+    }
+    table_ = subscription_.table_.read(slot_);
+    symbols_ = table_->symbols;
+}
+
+Subscription::Reader::~Reader()
+{
+    if (slot_ >= 0) subscription_.table_.detach(slot_);
+}
+
+bool Subscription::Reader::refresh()
+{
+    if (slot_ < 0) return false;
+
+    auto *table = subscription_.table_.read(slot_);
+    if (table == table_) return false;
+    table_ = table;
+
+    added_.clear();
+    removed_.clear();
+    std::set_difference(table->symbols.begin(), table->symbols.end(), symbols_.begin(), symbols_.end(),
+                        std::back_inserter(added_));
+    std::set_difference(symbols_.begin(), symbols_.end(), table->symbols.begin(), table->symbols.end(),
+                        std::back_inserter(removed_));
+    symbols_ = table->symbols;
+    return true;
+}
+
+SubscriptionWatcher::SubscriptionWatcher(Subscription &subscription, std::string file_path, int64_t interval_ms)
+        : subscription_(subscription),
+          file_path_(std::move(file_path)),
+          interval_ms_(interval_ms)
+{
+    thread_ = std::thread(&SubscriptionWatcher::run, this);
+}
+
+SubscriptionWatcher::~SubscriptionWatcher()
+{
+    stop();
+}
+
+void SubscriptionWatcher::stop()
+{
+    running_.store(false, std::memory_order_release);
+    if (thread_.joinable()) thread_.join();
+}
+
+std::vector<std::string> SubscriptionWatcher::load(const std::string &file_path)
+{
+    std::vector<std::string> symbols;
+    for (auto &[symbol, _]: x2h::util::read_list(file_path)) {
+        auto code = x2h::util::trim(symbol);
+        if (!code.empty()) symbols.push_back(std::move(code));
+    }
+    return symbols;
+}
+
+void SubscriptionWatcher::run()
+{
+    int64_t last_write = -1;
+
+    while (running_.load(std::memory_order_acquire)) {
+        auto write_time = x2h::util::file_last_write_time<std::chrono::nanoseconds>(file_path_);
+        if (write_time >= 0 && write_time != last_write) {
+            last_write = write_time;
+            subscription_.update(load(file_path_));
+        }
+        //! 读线程可能长时间停在空闲等待中, 周期性尝试回收
+        subscription_.reclaim();
+        std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms_));
+    }
+}
@@ -0,0 +1,78 @@
+#include "dat/symbol_filter.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "log/logger.h"
+
+namespace
+{
+    constexpr size_t LANES = 4;
+
+    bool match_scalar(const uint64_t *values, const uint64_t *masks, size_t n, uint64_t key) noexcept
+    {
+        for (size_t i = 0; i < n; ++i) {
+            if ((key & masks[i]) == values[i]) return true;
+        }
+        return false;
+    }
+
+#if defined(__x86_64__)
+    __attribute__((target("avx2")))
+    bool match_avx2(const uint64_t *values, const uint64_t *masks, size_t n, uint64_t key) noexcept
+    {
+        const __m256i k = _mm256_set1_epi64x(static_cast<long long>(key));
+        for (size_t i = 0; i < n; i += LANES) {
+            auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+            auto m = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(masks + i));
+            auto eq = _mm256_cmpeq_epi64(_mm256_and_si256(k, m), v);
+            if (!_mm256_testz_si256(eq, eq)) return true;
+        }
+        return false;
+    }
+#endif
+}
+
+SymbolFilter::SymbolFilter(const std::vector<std::string> &symbols)
+{
+    for (const auto &symbol: symbols) {
+        if (symbol.empty()) continue;
+        if (symbol.size() >= sizeof(uint64_t)) {
+            long_.push_back(symbol);
+            continue;
+        }
+
+        //! 比较到结尾 '\0' 为止, "60011" 不会匹配 "600111"
+        uint64_t value = 0;
+        std::memcpy(&value, symbol.data(), symbol.size());
+        uint64_t mask = ~uint64_t{0} >> (64 - 8 * (symbol.size() + 1));
+        values_.push_back(value);
+        masks_.push_back(mask);
+    }
+
+    count_ = values_.size();
+    while (values_.size() % LANES != 0) {
+        values_.push_back(1);
+        masks_.push_back(0);
+    }
+
+    match_ = &match_scalar;
+#if defined(__x86_64__)
+    if (__builtin_cpu_supports("avx2")) match_ = &match_avx2;
+#endif
+
+    x2h::log::info("股票过滤: {} 个代码, {}", size(), match_ == &match_scalar ? "scalar" : "avx2");
+}
+
+bool SymbolFilter::contains(const char *symbol) const noexcept
+{
+    uint64_t key;
+    std::memcpy(&key, symbol, sizeof(key));
+    if (count_ > 0 && match_(values_.data(), masks_.data(), values_.size(), key)) return true;
+
+    for (const auto &s: long_) {
+        if (std::strncmp(symbol, s.c_str(), s.size() + 1) == 0) return true;
+    }
+    return false;
+}
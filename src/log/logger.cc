@@ -0,0 +1,271 @@
+#include "log/logger.h"
+
+#include <bit>
+#include <cstdlib>
+#include <ctime>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace x2h::log
+{
+    namespace
+    {
+        uint64_t current_thread_id() noexcept
+        {
+#if defined(__linux__)
+            return static_cast<uint64_t>(::syscall(SYS_gettid));
+#else
+            return std::hash<std::thread::id>{}(std::this_thread::get_id());
+#endif
+        }
+
+        const char *level_name(Level level) noexcept
+        {
+            switch (level) {
+                case DBG:
+                    return "DBG";
+                case INF:
+                    return "INF";
+                case WRN:
+                    return "WRN";
+                case ERR:
+                    return "ERR";
+                default:
+                    return "OFF";
+            }
+        }
+
+        /*!
+         * @brief 线程退出时通知后台线程回收其 Ring
+        */
+        struct LocalRing
+        {
+            std::shared_ptr<Ring> ring;
+
+            ~LocalRing()
+            {
+                if (ring) ring->retire();
+            }
+        };
+    }
+
+    Ring::Ring(size_t capacity)
+            : capacity_(std::bit_ceil(capacity)),
+              mask_(std::bit_ceil(capacity) - 1),
+              thread_id_(current_thread_id())
+    {
+        buffer_ = static_cast<char *>(std::aligned_alloc(64, capacity_));
+    }
+
+    Ring::~Ring()
+    {
+        std::free(buffer_);
+    }
+
+    char *Ring::reserve(uint32_t size) noexcept
+    {
+        if (size > capacity_ / 2) return nullptr;
+
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        size_t offset = head & mask_;
+        size_t pad = (offset + size > capacity_) ? capacity_ - offset : 0;
+
+        if (head + pad + size - tail_cache_ > capacity_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head + pad + size - tail_cache_ > capacity_) return nullptr;
+        }
+
+        if (pad > 0) {
+            //! 尾部剩余空间不足, 写入填充标记后从头开始
+            std::memcpy(buffer_ + offset, &PAD, sizeof(PAD));
+            std::memcpy(buffer_ + offset + sizeof(PAD), &pad, sizeof(uint32_t));
+            head_.store(head + pad, std::memory_order_release);
+            offset = 0;
+        }
+
+        return buffer_ + offset;
+    }
+
+    void Ring::commit(uint32_t size) noexcept
+    {
+        head_.store(head_.load(std::memory_order_relaxed) + size, std::memory_order_release);
+    }
+
+    const char *Ring::front() noexcept
+    {
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+
+        while (true) {
+            if (tail == head_cache_) {
+                head_cache_ = head_.load(std::memory_order_acquire);
+                if (tail == head_cache_) return nullptr;
+            }
+
+            const char *p = buffer_ + (tail & mask_);
+            uint32_t size;
+            std::memcpy(&size, p, sizeof(size));
+            if (size != PAD) return p;
+
+            uint32_t pad;
+            std::memcpy(&pad, p + sizeof(PAD), sizeof(pad));
+            tail += pad;
+            tail_.store(tail, std::memory_order_release);
+        }
+    }
+
+    void Ring::pop(uint32_t size) noexcept
+    {
+        tail_.store(tail_.load(std::memory_order_relaxed) + size, std::memory_order_release);
+    }
+
+    Logger &Logger::instance()
+    {
+        static Logger logger;
+        return logger;
+    }
+
+    Logger::Logger()
+    {
+        if (const char *env = std::getenv("OB_LOG_LEVEL")) {
+            level_.store(static_cast<Level>(std::atoi(env)), std::memory_order_relaxed);
+        }
+        thread_ = std::thread(&Logger::run, this);
+    }
+
+    Logger::~Logger()
+    {
+        stop();
+        if (file_ != stderr && file_ != nullptr) {
+            std::fclose(file_);
+        }
+    }
+
+    bool Logger::open(const std::string &file_path)
+    {
+        std::FILE *file = file_path.empty() ? stderr : std::fopen(file_path.c_str(), "a");
+        if (file == nullptr) {
+            fmt::print(stderr, "日志文件 {} 打开失败\n", file_path);
+            return false;
+        }
+
+        flush();
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (file_ != stderr) std::fclose(file_);
+        file_ = file;
+        return true;
+    }
+
+    Ring &Logger::local_ring()
+    {
+        thread_local LocalRing local;
+        if (!local.ring) {
+            local.ring = std::make_shared<Ring>(ring_capacity_);
+            std::lock_guard<std::mutex> lock(mutex_);
+            rings_.push_back(local.ring);
+        }
+        return *local.ring;
+    }
+
+    void Logger::flush()
+    {
+        if (!running_.load(std::memory_order_acquire)) return;
+
+        uint64_t request = flush_request_.fetch_add(1, std::memory_order_acq_rel) + 1;
+        while (flush_done_.load(std::memory_order_acquire) < request && running_.load(std::memory_order_acquire)) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+
+    void Logger::stop()
+    {
+        if (!running_.exchange(false, std::memory_order_acq_rel)) return;
+        if (thread_.joinable()) thread_.join();
+
+        //! 后台线程退出后写出残留记录
+        std::lock_guard<std::mutex> lock(mutex_);
+        while (drain_once()) {}
+        std::fflush(file_);
+    }
+
+    void Logger::run()
+    {
+        while (running_.load(std::memory_order_acquire)) {
+            uint64_t request = flush_request_.load(std::memory_order_acquire);
+
+            bool busy;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                busy = drain_once();
+                if (!busy) std::fflush(file_);
+            }
+
+            if (!busy) {
+                flush_done_.store(request, std::memory_order_release);
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    }
+
+    /*!
+     * @brief 依次取出各 Ring 中的记录
+     * @return 是否处理了记录
+    */
+    bool Logger::drain_once()
+    {
+        bool busy = false;
+        uint64_t dropped = 0;
+
+        for (auto it = rings_.begin(); it != rings_.end();) {
+            auto &ring = **it;
+
+            //! 每个 Ring 单次最多处理固定条数, 避免单线程饿死其它线程
+            for (int i = 0; i < 1024; ++i) {
+                const char *p = ring.front();
+                if (p == nullptr) break;
+
+                RecordHeader header{};
+                std::memcpy(&header, p, sizeof(header));
+                write_record(ring, header, p + sizeof(header));
+                ring.pop(header.size);
+                busy = true;
+            }
+
+            dropped += ring.take_dropped();
+            if (ring.retired() && ring.empty()) {
+                it = rings_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        if (dropped > 0) {
+            fmt::print(file_, "[log] 日志缓冲区已满, 丢弃 {} 条记录\n", dropped);
+        }
+
+        return busy;
+    }
+
+    void Logger::write_record(const Ring &ring, const RecordHeader &header, const char *args)
+    {
+        buffer_.clear();
+
+        std::time_t secs = header.timestamp / 1'000'000'000;
+        std::tm tm{};
+        localtime_r(&secs, &tm);
+        fmt::format_to(std::back_inserter(buffer_), "[{:02}:{:02}:{:02}.{:06}] [{}] [{}] ",
+                       tm.tm_hour, tm.tm_min, tm.tm_sec, header.timestamp / 1'000 % 1'000'000,
+                       level_name(header.level), ring.thread_id());
+
+        try {
+            header.format(buffer_, header.fmt, args);
+        } catch (const fmt::format_error &e) {
+            fmt::format_to(std::back_inserter(buffer_), "<格式化失败: {}> {}", e.what(), header.fmt);
+        }
+
+        buffer_.push_back('\n');
+        std::fwrite(buffer_.data(), 1, buffer_.size(), file_);
+    }
+}
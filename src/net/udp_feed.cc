@@ -0,0 +1,320 @@
+#include "net/udp_feed.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include "dat/mapped_file.h"
+#include "dat/merge_reader.h"
+#include "log/logger.h"
+#include "pipeline/wait_strategy.h"
+
+namespace x2h::net
+{
+    namespace
+    {
+        /* 阻塞接收的超时, 保证及时响应 stop() 与空闲超时 */
+        constexpr int RECV_TIMEOUT_MS = 100;
+        /* 每个接收槽的控制消息缓冲区, 用于 SO_RXQ_OVFL */
+        constexpr size_t CONTROL_SIZE = 64;
+
+        bool is_multicast(const in_addr &addr) noexcept
+        {
+            return IN_MULTICAST(ntohl(addr.s_addr));
+        }
+
+        bool parse_address(const std::string &address, uint16_t port, sockaddr_in &out)
+        {
+            out = {};
+            out.sin_family = AF_INET;
+            out.sin_port = htons(port);
+            return ::inet_pton(AF_INET, address.c_str(), &out.sin_addr) == 1;
+        }
+    }
+
+    UdpFeed::UdpFeed(UdpFeedConfig config, DatCallback callback)
+            : config_(std::move(config)),
+              callback_(std::move(callback))
+    {
+        if (config_.batch == 0) config_.batch = 1;
+        if (!open() && fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    UdpFeed::~UdpFeed()
+    {
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    bool UdpFeed::open()
+    {
+        sockaddr_in addr{};
+        if (!parse_address(config_.address, config_.port, addr)) {
+            log::error("无效地址 {}", config_.address);
+            return false;
+        }
+
+        fd_ = ::socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd_ < 0) {
+            log::error("socket 创建失败: {}", std::strerror(errno));
+            return false;
+        }
+
+        int on = 1;
+        ::setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        ::setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &config_.socket_buffer, sizeof(config_.socket_buffer));
+        //! 内核在控制消息中返回因接收缓冲区满而丢弃的数据报数
+        ::setsockopt(fd_, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on));
+
+        if (config_.busy_poll) {
+            //! 需要 CAP_NET_ADMIN 才能调大, 失败时仅靠用户态忙轮询
+            int usec = 50;
+            ::setsockopt(fd_, SOL_SOCKET, SO_BUSY_POLL, &usec, sizeof(usec));
+        } else {
+            timeval tv{0, RECV_TIMEOUT_MS * 1000};
+            ::setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        }
+
+        if (::bind(fd_, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0) {
+            log::error("绑定 {}:{} 失败: {}", config_.address, config_.port, std::strerror(errno));
+            return false;
+        }
+
+        if (is_multicast(addr.sin_addr)) {
+            ip_mreq mreq{};
+            mreq.imr_multiaddr = addr.sin_addr;
+            if (::inet_pton(AF_INET, config_.interface.c_str(), &mreq.imr_interface) != 1 ||
+                ::setsockopt(fd_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) != 0) {
+                log::error("加入组播组 {} 失败: {}", config_.address, std::strerror(errno));
+                return false;
+            }
+        }
+
+        buffer_.resize(config_.batch * (config_.datagram_size + CONTROL_SIZE));
+        return true;
+    }
+
+    /*!
+     * @brief 拆分数据报中的记录并交付
+    */
+    void UdpFeed::dispatch(const char *data, size_t size)
+    {
+        auto &item = *item_;
+        size_t offset = 0;
+
+        while (offset + sizeof(Header) <= size) {
+            auto header = (const Header *) (data + offset);
+            size_t total = DatReader::record_size(*header);
+            if (offset + total > size) break;
+
+            item.DataType = (MsgType) header->DataType;
+            item.DataLen = static_cast<uint16_t>(header->DataLen);
+            item.Data = const_cast<Header *>(header + 1);
+            offset += total;
+            ++records_;
+            callback_(item_);
+        }
+
+        if (offset != size) ++malformed_;
+    }
+
+    void UdpFeed::run()
+    {
+        if (fd_ < 0) return;
+
+        const unsigned batch = config_.batch;
+        const size_t slot = config_.datagram_size;
+        char *data = buffer_.data();
+        char *control = buffer_.data() + batch * slot;
+
+        std::vector<iovec> iov(batch);
+        std::vector<mmsghdr> msgs(batch);
+        for (unsigned i = 0; i < batch; ++i) {
+            iov[i] = {data + i * slot, slot};
+        }
+
+        uint32_t dropped = 0;
+        auto idle_since = std::chrono::steady_clock::now();
+        const int flags = config_.busy_poll ? MSG_DONTWAIT : MSG_WAITFORONE;
+
+        while (!stopped_.load(std::memory_order_relaxed)) {
+            //! recvmmsg 会改写 msg_controllen 等字段, 每次调用前重置
+            for (unsigned i = 0; i < batch; ++i) {
+                auto &hdr = msgs[i].msg_hdr;
+                hdr = {};
+                hdr.msg_iov = &iov[i];
+                hdr.msg_iovlen = 1;
+                hdr.msg_control = control + i * CONTROL_SIZE;
+                hdr.msg_controllen = CONTROL_SIZE;
+            }
+
+            int n = ::recvmmsg(fd_, msgs.data(), batch, flags, nullptr);
+            if (n <= 0) {
+                if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                    log::error("recvmmsg 失败: {}", std::strerror(errno));
+                    break;
+                }
+                if (config_.idle_timeout_ms > 0) {
+                    auto idle = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::steady_clock::now() - idle_since).count();
+                    if (idle >= config_.idle_timeout_ms) break;
+                }
+                if (config_.busy_poll) pipeline::cpu_relax();
+                continue;
+            }
+
+            for (int i = 0; i < n; ++i) {
+                auto &hdr = msgs[i].msg_hdr;
+                if (hdr.msg_flags & MSG_TRUNC) {
+                    ++malformed_;
+                    continue;
+                }
+                for (auto *cmsg = CMSG_FIRSTHDR(&hdr); cmsg != nullptr; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+                    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL) {
+                        std::memcpy(&dropped, CMSG_DATA(cmsg), sizeof(dropped));
+                    }
+                }
+                dispatch(static_cast<const char *>(iov[i].iov_base), msgs[i].msg_len);
+            }
+            datagrams_ += n;
+            if (config_.idle_timeout_ms > 0) idle_since = std::chrono::steady_clock::now();
+        }
+
+        if (dropped > 0 || malformed_ > 0) {
+            log::warn("UDP 接收: 内核丢弃 {} 个数据报, 不完整 {} 个", dropped, malformed_);
+        }
+    }
+
+    UdpSender::UdpSender(UdpSenderConfig config)
+            : config_(std::move(config))
+    {
+        if (config_.batch == 0) config_.batch = 1;
+        if (!open() && fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    UdpSender::~UdpSender()
+    {
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    bool UdpSender::open()
+    {
+        sockaddr_in addr{};
+        if (!parse_address(config_.address, config_.port, addr)) {
+            log::error("无效地址 {}", config_.address);
+            return false;
+        }
+
+        fd_ = ::socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd_ < 0) {
+            log::error("socket 创建失败: {}", std::strerror(errno));
+            return false;
+        }
+
+        if (is_multicast(addr.sin_addr)) {
+            in_addr iface{};
+            unsigned char loop = 1;
+            unsigned char ttl = 1;
+            if (::inet_pton(AF_INET, config_.interface.c_str(), &iface) != 1 ||
+                ::setsockopt(fd_, IPPROTO_IP, IP_MULTICAST_IF, &iface, sizeof(iface)) != 0) {
+                log::error("组播接口 {} 设置失败: {}", config_.interface, std::strerror(errno));
+                return false;
+            }
+            ::setsockopt(fd_, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+            ::setsockopt(fd_, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+        }
+
+        if (::connect(fd_, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0) {
+            log::error("连接 {}:{} 失败: {}", config_.address, config_.port, std::strerror(errno));
+            return false;
+        }
+        return true;
+    }
+
+    /*!
+     * @brief 文件中记录是连续的, 相邻记录直接合并为一个数据报, 零拷贝发送
+    */
+    uint64_t UdpSender::send(const std::string &dat_file)
+    {
+        if (fd_ < 0) return 0;
+
+        MappedFile mapping{dat_file};
+        if (!mapping.is_open()) return 0;
+
+        const char *addr = mapping.data();
+        const size_t size = mapping.size();
+
+        std::vector<iovec> iov;
+        std::vector<mmsghdr> msgs;
+        iov.reserve(config_.batch);
+        msgs.reserve(config_.batch);
+
+        auto flush = [&]() {
+            msgs.resize(iov.size());
+            for (size_t i = 0; i < iov.size(); ++i) {
+                msgs[i] = {};
+                msgs[i].msg_hdr.msg_iov = &iov[i];
+                msgs[i].msg_hdr.msg_iovlen = 1;
+            }
+
+            size_t sent = 0;
+            while (sent < msgs.size()) {
+                int n = ::sendmmsg(fd_, msgs.data() + sent, msgs.size() - sent, 0);
+                if (n < 0) {
+                    if (errno == EINTR || errno == ENOBUFS || errno == EAGAIN) continue;
+                    log::error("sendmmsg 失败: {}", std::strerror(errno));
+                    break;
+                }
+                sent += n;
+            }
+            datagrams_ += sent;
+            iov.clear();
+        };
+
+        Pacer pacer{config_.speed};
+        uint64_t records = 0;
+
+        size_t begin = 0;
+        size_t offset = 0;
+        while (offset + sizeof(Header) <= size) {
+            auto header = (const Header *) (addr + offset);
+            size_t total = DatReader::record_size(*header);
+            if (offset + total > size) break;
+
+            if (pacer.enabled()) {
+                uint64_t time = MergeReader::record_time(header);
+                if (pacer.remaining_ns(time) > 0) {
+                    //! 先发出已到时的记录再等待
+                    if (offset > begin) iov.push_back({const_cast<char *>(addr + begin), offset - begin});
+                    flush();
+                    begin = offset;
+                }
+                pacer.wait(time);
+            }
+
+            if (offset + total - begin > config_.datagram_size && offset > begin) {
+                iov.push_back({const_cast<char *>(addr + begin), offset - begin});
+                begin = offset;
+                if (iov.size() == config_.batch) flush();
+            }
+
+            offset += total;
+            ++records;
+        }
+
+        if (offset > begin) iov.push_back({const_cast<char *>(addr + begin), offset - begin});
+        flush();
+        pacer.report();
+        return records;
+    }
+}
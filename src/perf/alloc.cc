@@ -0,0 +1,264 @@
+#include "perf/alloc.h"
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+#include "log/logger.h"
+
+namespace x2h::perf
+{
+    namespace
+    {
+        /* 消息类型 x (阶段 + 操作) */
+        constexpr size_t SLOTS = MSG_COUNT * KIND_COUNT;
+
+        /*!
+         * @brief 全部线程共用的计数; 分配钩子内不能再分配, 因此不使用线程局部的注册表
+        */
+        struct AllocTable
+        {
+            std::array<std::atomic<uint64_t>, SLOTS> entries{};
+            std::array<std::atomic<uint64_t>, SLOTS> allocations{};
+            std::array<std::atomic<uint64_t>, SLOTS> bytes{};
+            std::array<std::atomic<uint64_t>, SLOTS> frees{};
+            std::array<std::atomic<uint64_t>, SLOTS> steady{};
+            /* 热路径作用域之外 */
+            std::atomic<uint64_t> other_allocations{0};
+            std::atomic<uint64_t> other_bytes{0};
+            std::atomic<uint64_t> violations{0};
+        };
+
+        AllocTable table;
+        std::atomic<bool> steady_state{false};
+        std::atomic<AllocPolicy> steady_policy{AllocPolicy::COUNT};
+
+        /* 当前线程所处的阶段/操作, -1 表示不在热路径内 */
+        thread_local int16_t current_stage = -1;
+        thread_local int16_t current_op = -1;
+
+        int16_t slot_of(Msg msg, size_t kind) noexcept
+        {
+            return static_cast<int16_t>(static_cast<size_t>(msg) * KIND_COUNT + kind);
+        }
+
+        void bump(std::atomic<uint64_t> &counter, uint64_t n = 1) noexcept
+        {
+            counter.fetch_add(n, std::memory_order_relaxed);
+        }
+
+#ifdef OB_ALLOC
+        void write_stderr(const char *text) noexcept
+        {
+#if defined(__linux__)
+            auto unused = ::write(2, text, std::strlen(text));
+            (void) unused;
+#endif
+        }
+
+        /*!
+         * @brief 在钩子内输出违规位置后 abort, 不经过日志(日志本身会分配)
+        */
+        [[noreturn]] void abort_on(int16_t slot) noexcept
+        {
+            write_stderr("稳态热路径内发生分配: ");
+            write_stderr(msg_name(static_cast<Msg>(slot / KIND_COUNT)));
+            write_stderr(" ");
+            write_stderr(kind_name(static_cast<size_t>(slot) % KIND_COUNT));
+            write_stderr("\n");
+            std::abort();
+        }
+
+        void on_allocate(size_t size) noexcept
+        {
+            int16_t stage = current_stage;
+            int16_t op = current_op;
+            if (stage < 0 && op < 0) {
+                bump(table.other_allocations);
+                bump(table.other_bytes, size);
+                return;
+            }
+
+            for (int16_t slot: {stage, op}) {
+                if (slot < 0) continue;
+                bump(table.allocations[slot]);
+                bump(table.bytes[slot], size);
+            }
+
+            if (steady_state.load(std::memory_order_relaxed)) {
+                //! 计入最内层的作用域
+                int16_t inner = op >= 0 ? op : stage;
+                bump(table.steady[inner]);
+                bump(table.violations);
+                if (steady_policy.load(std::memory_order_relaxed) == AllocPolicy::ABORT) abort_on(inner);
+            }
+        }
+
+        void on_free() noexcept
+        {
+            for (int16_t slot: {current_stage, current_op}) {
+                if (slot >= 0) bump(table.frees[slot]);
+            }
+        }
+
+        void *allocate(size_t size, size_t align) noexcept
+        {
+            if (size == 0) size = 1;
+            void *p = align <= alignof(std::max_align_t)
+                      ? std::malloc(size)
+                      : std::aligned_alloc(align, (size + align - 1) / align * align);
+            if (p != nullptr) on_allocate(size);
+            return p;
+        }
+
+        void deallocate(void *p) noexcept
+        {
+            if (p == nullptr) return;
+            on_free();
+            std::free(p);
+        }
+#endif
+    }
+
+    ScopedAlloc::ScopedAlloc(Msg msg, Stage stage) noexcept
+            : is_op_(false), previous_(current_stage)
+    {
+        current_stage = slot_of(msg, kind_of(stage));
+        bump(table.entries[current_stage]);
+    }
+
+    ScopedAlloc::ScopedAlloc(Msg msg, Op op) noexcept
+            : is_op_(true), previous_(current_op)
+    {
+        current_op = slot_of(msg, kind_of(op));
+        bump(table.entries[current_op]);
+    }
+
+    ScopedAlloc::~ScopedAlloc()
+    {
+        (is_op_ ? current_op : current_stage) = previous_;
+    }
+
+    void ScopedAlloc::set_op(Op op) noexcept
+    {
+        if (!is_op_ || current_op < 0) return;
+
+        auto msg = static_cast<Msg>(current_op / KIND_COUNT);
+        table.entries[current_op].fetch_sub(1, std::memory_order_relaxed);
+        current_op = slot_of(msg, kind_of(op));
+        bump(table.entries[current_op]);
+    }
+
+    void set_alloc_steady(bool steady, AllocPolicy policy) noexcept
+    {
+        steady_policy.store(policy, std::memory_order_relaxed);
+        steady_state.store(steady, std::memory_order_release);
+    }
+
+    uint64_t alloc_violations() noexcept
+    {
+        return table.violations.load(std::memory_order_relaxed);
+    }
+
+    AllocReporter::~AllocReporter()
+    {
+        if (ALLOC_ENABLED) report();
+    }
+
+    void AllocReporter::report() const
+    {
+        for (size_t slot = 0; slot < SLOTS; ++slot) {
+            uint64_t entries = table.entries[slot].load(std::memory_order_relaxed);
+            uint64_t allocations = table.allocations[slot].load(std::memory_order_relaxed);
+            if (entries == 0 && allocations == 0) continue;
+
+            log::info("分配 {:<8} {:<10} n: {}, allocs: {} ({:.3f}/消息), bytes: {}, frees: {}, 稳态 allocs: {}",
+                      msg_name(static_cast<Msg>(slot / KIND_COUNT)), kind_name(slot % KIND_COUNT), entries,
+                      allocations, entries > 0 ? static_cast<double>(allocations) / static_cast<double>(entries) : 0.0,
+                      table.bytes[slot].load(std::memory_order_relaxed),
+                      table.frees[slot].load(std::memory_order_relaxed),
+                      table.steady[slot].load(std::memory_order_relaxed));
+        }
+        log::info("热路径之外: allocs: {}, bytes: {}; 稳态热路径内分配: {}",
+                  table.other_allocations.load(std::memory_order_relaxed),
+                  table.other_bytes.load(std::memory_order_relaxed), alloc_violations());
+    }
+}
+
+#ifdef OB_ALLOC
+
+void *operator new(std::size_t size)
+{
+    void *p = x2h::perf::allocate(size, 0);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](std::size_t size)
+{
+    void *p = x2h::perf::allocate(size, 0);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void *operator new(std::size_t size, std::align_val_t align)
+{
+    void *p = x2h::perf::allocate(size, static_cast<std::size_t>(align));
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](std::size_t size, std::align_val_t align)
+{
+    void *p = x2h::perf::allocate(size, static_cast<std::size_t>(align));
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return x2h::perf::allocate(size, 0);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return x2h::perf::allocate(size, 0);
+}
+
+void operator delete(void *p) noexcept
+{ x2h::perf::deallocate(p); }
+
+void operator delete[](void *p) noexcept
+{ x2h::perf::deallocate(p); }
+
+void operator delete(void *p, std::size_t) noexcept
+{ x2h::perf::deallocate(p); }
+
+void operator delete[](void *p, std::size_t) noexcept
+{ x2h::perf::deallocate(p); }
+
+void operator delete(void *p, std::align_val_t) noexcept
+{ x2h::perf::deallocate(p); }
+
+void operator delete[](void *p, std::align_val_t) noexcept
+{ x2h::perf::deallocate(p); }
+
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept
+{ x2h::perf::deallocate(p); }
+
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept
+{ x2h::perf::deallocate(p); }
+
+void operator delete(void *p, const std::nothrow_t &) noexcept
+{ x2h::perf::deallocate(p); }
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept
+{ x2h::perf::deallocate(p); }
+
+#endif
@@ -0,0 +1,219 @@
+#include "perf/counters.h"
+
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "log/logger.h"
+
+namespace x2h::perf
+{
+    namespace
+    {
+        std::mutex recorders_mutex;
+        std::vector<std::shared_ptr<CounterRecorder>> recorders;
+        std::atomic<bool> warned{false};
+
+#if defined(__linux__)
+        struct EventSpec
+        {
+            uint32_t type;
+            uint64_t config;
+        };
+
+        constexpr uint64_t cache_miss(uint64_t cache) noexcept
+        {
+            return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        }
+
+        /* 与 Counter 的顺序一致 */
+        constexpr EventSpec EVENTS[COUNTER_COUNT] = {
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+                {PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_L1D)},
+                {PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_LL)},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        };
+
+        /*!
+         * @brief 只统计当前线程的用户态
+        */
+        int open_event(const EventSpec &spec, int group_fd) noexcept
+        {
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = spec.type;
+            attr.config = spec.config;
+            attr.disabled = group_fd < 0 ? 1 : 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+            return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+        }
+#endif
+    }
+
+    const char *counter_name(Counter counter) noexcept
+    {
+        switch (counter) {
+            case Counter::CYCLES:
+                return "cycles";
+            case Counter::INSTRUCTIONS:
+                return "instructions";
+            case Counter::L1D_MISSES:
+                return "l1d_misses";
+            case Counter::LLC_MISSES:
+                return "llc_misses";
+            case Counter::BRANCH_MISSES:
+                return "branch_misses";
+            default:
+                return "unknown";
+        }
+    }
+
+    CounterGroup::CounterGroup()
+    {
+        fds_.fill(-1);
+        slots_.fill(-1);
+
+#if defined(__linux__)
+        leader_ = open_event(EVENTS[0], -1);
+        if (leader_ < 0) {
+            if (!warned.exchange(true)) {
+                log::warn("perf_event_open 不可用({}), 硬件计数器关闭", std::strerror(errno));
+            }
+            return;
+        }
+        fds_[0] = leader_;
+        slots_[0] = opened_++;
+
+        for (size_t i = 1; i < COUNTER_COUNT; ++i) {
+            fds_[i] = open_event(EVENTS[i], leader_);
+            if (fds_[i] >= 0) {
+                slots_[i] = opened_++;
+            } else if (!warned.exchange(true)) {
+                //! 虚拟机内常见缓存类事件不可用, 其余计数照常
+                log::warn("计数器 {} 不可用({})", counter_name(static_cast<Counter>(i)), std::strerror(errno));
+            }
+        }
+
+        ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#else
+        if (!warned.exchange(true)) log::warn("非 Linux 平台, 硬件计数器关闭");
+#endif
+    }
+
+    CounterGroup::~CounterGroup()
+    {
+#if defined(__linux__)
+        for (int fd: fds_) {
+            if (fd >= 0) close(fd);
+        }
+#endif
+    }
+
+    bool CounterGroup::read(CounterValues &values) const noexcept
+    {
+#if defined(__linux__)
+        if (leader_ < 0) return false;
+
+        //! PERF_FORMAT_GROUP: nr, values[nr]
+        uint64_t buffer[COUNTER_COUNT + 1];
+        auto n = ::read(leader_, buffer, sizeof(uint64_t) * (opened_ + 1));
+        if (n < static_cast<ssize_t>(sizeof(uint64_t) * (opened_ + 1))) return false;
+
+        for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+            values[i] = slots_[i] >= 0 ? buffer[1 + slots_[i]] : 0;
+        }
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void CounterRecorder::add(Msg msg, size_t kind, const CounterValues &begin, const CounterValues &end) noexcept
+    {
+        auto &totals = totals_[static_cast<size_t>(msg)][kind];
+        //! 单写者, 不需要原子的读-改-写
+        totals.samples.store(totals.samples.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+            auto &value = totals.values[i];
+            value.store(value.load(std::memory_order_relaxed) + (end[i] - begin[i]), std::memory_order_relaxed);
+        }
+    }
+
+    CounterRecorder &local_counters()
+    {
+        thread_local std::shared_ptr<CounterRecorder> local;
+        if (!local) {
+            local = std::make_shared<CounterRecorder>();
+            std::lock_guard<std::mutex> lock(recorders_mutex);
+            recorders.push_back(local);
+        }
+        return *local;
+    }
+
+    CounterReporter::~CounterReporter()
+    {
+        if (COUNTERS_ENABLED) report();
+    }
+
+    void CounterReporter::report() const
+    {
+        std::lock_guard<std::mutex> lock(recorders_mutex);
+
+        std::array<bool, COUNTER_COUNT> has{};
+        for (const auto &recorder: recorders) {
+            for (size_t i = 0; i < COUNTER_COUNT; ++i) has[i] = has[i] || recorder->group().has(static_cast<Counter>(i));
+        }
+        if (!has[static_cast<size_t>(Counter::CYCLES)]) {
+            log::info("硬件计数器不可用, 无统计");
+            return;
+        }
+
+        auto per_msg = [&](const CounterValues &values, uint64_t samples, Counter counter) -> std::string {
+            auto i = static_cast<size_t>(counter);
+            if (!has[i]) return "n/a";
+            return fmt::format("{:.1f}", static_cast<double>(values[i]) / static_cast<double>(samples));
+        };
+
+        for (size_t m = 0; m < MSG_COUNT; ++m) {
+            for (size_t kind = 0; kind < KIND_COUNT; ++kind) {
+                uint64_t samples = 0;
+                CounterValues values{};
+                for (const auto &recorder: recorders) {
+                    const auto &totals = recorder->totals(static_cast<Msg>(m), kind);
+                    samples += totals.samples.load(std::memory_order_relaxed);
+                    for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+                        values[i] += totals.values[i].load(std::memory_order_relaxed);
+                    }
+                }
+                if (samples == 0) continue;
+
+                auto cycles = values[static_cast<size_t>(Counter::CYCLES)];
+                auto instructions = values[static_cast<size_t>(Counter::INSTRUCTIONS)];
+                std::string ipc = has[static_cast<size_t>(Counter::INSTRUCTIONS)] && cycles > 0
+                                  ? fmt::format("{:.2f}", static_cast<double>(instructions) / static_cast<double>(cycles))
+                                  : "n/a";
+
+                log::info("计数器 {:<8} {:<7} n: {}, cycles: {}, instructions: {}, IPC: {}, L1D miss: {}, "
+                          "LLC miss: {}, branch miss: {} (每条消息)", msg_name(static_cast<Msg>(m)), kind_name(kind),
+                          samples, per_msg(values, samples, Counter::CYCLES),
+                          per_msg(values, samples, Counter::INSTRUCTIONS),
+                          ipc, per_msg(values, samples, Counter::L1D_MISSES),
+                          per_msg(values, samples, Counter::LLC_MISSES),
+                          per_msg(values, samples, Counter::BRANCH_MISSES));
+            }
+        }
+    }
+}
@@ -0,0 +1,236 @@
+#include "perf/latency.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "log/logger.h"
+#include "utils.h"
+
+namespace x2h::perf
+{
+    namespace
+    {
+        std::mutex recorders_mutex;
+        std::vector<std::shared_ptr<LatencyRecorder>> recorders;
+
+        constexpr int64_t MAX_END_TO_END_US = 3'600'000'000;
+
+        double calibrate() noexcept
+        {
+#if defined(__x86_64__) || defined(__i386__)
+            auto begin = std::chrono::steady_clock::now();
+            uint64_t tsc_begin = rdtsc();
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            uint64_t tsc_end = rdtsc();
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - begin).count();
+            return ns > 0 ? static_cast<double>(tsc_end - tsc_begin) / static_cast<double>(ns) : 1.0;
+#else
+            return 1.0;
+#endif
+        }
+
+        uint64_t percentile(const Histogram::Counts &counts, uint64_t total, double p) noexcept
+        {
+            auto rank = static_cast<uint64_t>(p * static_cast<double>(total));
+            uint64_t seen = 0;
+            for (size_t i = 0; i < Histogram::BUCKETS; ++i) {
+                seen += counts[i];
+                if (seen > rank) return Histogram::value_of(i);
+            }
+            return 0;
+        }
+    }
+
+    const char *msg_name(Msg msg) noexcept
+    {
+        switch (msg) {
+            case Msg::SH_ORDER:
+                return "sh_order";
+            case Msg::SH_TRADE:
+                return "sh_trade";
+            case Msg::SZ_ORDER:
+                return "sz_order";
+            case Msg::SZ_TRADE:
+                return "sz_trade";
+            default:
+                return "other";
+        }
+    }
+
+    const char *stage_name(Stage stage) noexcept
+    {
+        switch (stage) {
+            case Stage::DECODE:
+                return "decode";
+            case Stage::APPLY:
+                return "apply";
+            case Stage::PUBLISH:
+                return "publish";
+            case Stage::END_TO_END:
+                return "end_to_end";
+            default:
+                return "unknown";
+        }
+    }
+
+    const char *op_name(Op op) noexcept
+    {
+        switch (op) {
+            case Op::ADD:
+                return "add";
+            case Op::CANCEL:
+                return "cancel";
+            case Op::FILL:
+                return "fill";
+            case Op::MATCH:
+                return "match";
+            default:
+                return "unknown";
+        }
+    }
+
+    const char *kind_name(size_t kind) noexcept
+    {
+        return kind < STAGE_COUNT ? stage_name(static_cast<Stage>(kind)) : op_name(static_cast<Op>(kind - STAGE_COUNT));
+    }
+
+    double tsc_per_ns() noexcept
+    {
+        static const double ratio = calibrate();
+        return ratio;
+    }
+
+    LatencySummary summarize(const Histogram::Counts &counts) noexcept
+    {
+        LatencySummary summary;
+        for (size_t i = 0; i < Histogram::BUCKETS; ++i) {
+            summary.count += counts[i];
+            if (counts[i] > 0) summary.max = Histogram::value_of(i);
+        }
+        if (summary.count == 0) return summary;
+
+        summary.p50 = percentile(counts, summary.count, 0.5);
+        summary.p90 = percentile(counts, summary.count, 0.9);
+        summary.p99 = percentile(counts, summary.count, 0.99);
+        summary.p999 = percentile(counts, summary.count, 0.999);
+        return summary;
+    }
+
+    void LatencyRecorder::end_to_end(Msg msg, int64_t rec_time_us) noexcept
+    {
+        int64_t delay_us = util::now_time<std::chrono::microseconds>() - rec_time_us;
+        if (rec_time_us <= 0 || delay_us < 0 || delay_us > MAX_END_TO_END_US) return;
+        stage(msg, Stage::END_TO_END, static_cast<uint64_t>(delay_us) * 1'000);
+    }
+
+    LatencyRecorder &local_recorder()
+    {
+        //! 线程退出后 recorders 仍持有, 结束时的汇总不丢失数据
+        thread_local std::shared_ptr<LatencyRecorder> local;
+        if (!local) {
+            local = std::make_shared<LatencyRecorder>();
+            std::lock_guard<std::mutex> lock(recorders_mutex);
+            recorders.push_back(local);
+        }
+        return *local;
+    }
+
+    /*!
+     * @brief 全部线程合并后的计数
+    */
+    struct LatencyReporter::Snapshot
+    {
+        std::array<std::array<Histogram::Counts, STAGE_COUNT>, MSG_COUNT> stages{};
+        std::array<std::array<Histogram::Counts, OP_COUNT>, MSG_COUNT> ops{};
+
+        void collect()
+        {
+            std::lock_guard<std::mutex> lock(recorders_mutex);
+            for (const auto &recorder: recorders) {
+                for (size_t m = 0; m < MSG_COUNT; ++m) {
+                    for (size_t s = 0; s < STAGE_COUNT; ++s) {
+                        recorder->stage_histogram(static_cast<Msg>(m), static_cast<Stage>(s)).add_to(stages[m][s]);
+                    }
+                    for (size_t o = 0; o < OP_COUNT; ++o) {
+                        recorder->op_histogram(static_cast<Msg>(m), static_cast<Op>(o)).add_to(ops[m][o]);
+                    }
+                }
+            }
+        }
+    };
+
+    LatencyReporter::LatencyReporter(int64_t interval_ms)
+            : interval_ms_(interval_ms)
+    {
+        if (!LATENCY_ENABLED) return;
+
+        //! 标定放在启动时, 避免第一次记录时阻塞热路径
+        log::info("延迟统计已启用, TSC: {:.3f} cycles/ns, 输出周期: {}ms", tsc_per_ns(), interval_ms_);
+        previous_ = std::make_unique<Snapshot>();
+        if (interval_ms_ > 0) thread_ = std::thread(&LatencyReporter::run, this);
+    }
+
+    LatencyReporter::~LatencyReporter()
+    {
+        stop();
+    }
+
+    void LatencyReporter::stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopped_ || !LATENCY_ENABLED) return;
+            stopped_ = true;
+        }
+        cv_.notify_all();
+        if (thread_.joinable()) thread_.join();
+
+        auto total = std::make_unique<Snapshot>();
+        total->collect();
+        dump(*total, nullptr, "累计");
+    }
+
+    void LatencyReporter::run()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!cv_.wait_for(lock, std::chrono::milliseconds(interval_ms_), [this] { return stopped_; })) {
+            auto current = std::make_unique<Snapshot>();
+            current->collect();
+            dump(*current, previous_.get(), "区间");
+            previous_ = std::move(current);
+        }
+    }
+
+    /*!
+     * @brief 输出 current 相对 previous 的增量, previous 为空时输出 current 本身; 只输出有样本的直方图
+    */
+    void LatencyReporter::dump(const Snapshot &current, const Snapshot *previous, const char *title) const
+    {
+        auto print = [&](const Histogram::Counts &counts, const Histogram::Counts *base,
+                         const char *msg, const char *name) {
+            Histogram::Counts delta = counts;
+            if (base != nullptr) {
+                for (size_t i = 0; i < Histogram::BUCKETS; ++i) delta[i] -= (*base)[i];
+            }
+            auto summary = summarize(delta);
+            if (summary.count == 0) return;
+            log::info("延迟[{}] {:<8} {:<10} n: {}, p50: {}, p90: {}, p99: {}, p99.9: {}, max: {} (ns)",
+                      title, msg, name, summary.count, summary.p50, summary.p90, summary.p99, summary.p999,
+                      summary.max);
+        };
+
+        for (size_t m = 0; m < MSG_COUNT; ++m) {
+            const char *msg = msg_name(static_cast<Msg>(m));
+            for (size_t s = 0; s < STAGE_COUNT; ++s) {
+                print(current.stages[m][s], previous ? &previous->stages[m][s] : nullptr,
+                      msg, stage_name(static_cast<Stage>(s)));
+            }
+            for (size_t o = 0; o < OP_COUNT; ++o) {
+                print(current.ops[m][o], previous ? &previous->ops[m][o] : nullptr,
+                      msg, op_name(static_cast<Op>(o)));
+            }
+        }
+    }
+}
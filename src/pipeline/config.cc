@@ -0,0 +1,62 @@
+#include "pipeline/config.h"
+#include "utils.h"
+
+namespace x2h::pipeline
+{
+    namespace
+    {
+        using ConfigMap = std::unordered_map<std::string, std::string>;
+
+        std::string get(const ConfigMap &config, const std::string &key, const std::string &def = {})
+        {
+            auto it = config.find(key);
+            return it == config.end() ? def : it->second;
+        }
+
+        int64_t get_int(const ConfigMap &config, const std::string &key, int64_t def)
+        {
+            auto value = get(config, key);
+            return value.empty() ? def : std::stoll(value);
+        }
+
+        std::vector<StageConfig> load_stages(const ConfigMap &config, const std::string &prefix)
+        {
+            auto threads = static_cast<size_t>(get_int(config, prefix + ".threads", 1));
+            auto cpus = util::split(get(config, prefix + ".cpus"));
+            auto wait = parse_wait_strategy(get(config, prefix + ".wait"));
+
+            std::vector<StageConfig> stages(threads);
+            for (size_t i = 0; i < threads; ++i) {
+                stages[i].wait = wait;
+                if (i < cpus.size()) stages[i].cpu = std::stoi(cpus[i]);
+            }
+            return stages;
+        }
+    }
+
+    PipelineConfig PipelineConfig::load(const std::string &file_path)
+    {
+        auto config = util::read_config(file_path);
+        PipelineConfig result;
+
+        result.dat_file = get(config, "reader.file");
+        result.symbols = util::split(get(config, "symbols"));
+        result.queue_capacity = static_cast<size_t>(get_int(config, "queue.capacity", 1 << 16));
+
+        result.reader.cpu = static_cast<int>(get_int(config, "reader.cpu", -1));
+        result.reader.wait = parse_wait_strategy(get(config, "reader.wait"));
+        result.decoder.cpu = static_cast<int>(get_int(config, "decoder.cpu", -1));
+        result.decoder.wait = parse_wait_strategy(get(config, "decoder.wait"));
+
+        result.books = load_stages(config, "book");
+        result.max_books = static_cast<size_t>(get_int(config, "book.max_books", 0));
+        result.compact_idle_ms = get_int(config, "book.compact_idle_ms", 0);
+
+        result.sink_output = get(config, "sink.output", "-");
+        result.sink_levels = static_cast<int>(get_int(config, "sink.levels", 5));
+        result.sinks = result.sink_output == "none" ? std::vector<StageConfig>{} : load_stages(config, "sink");
+
+        if (result.books.empty()) result.books.emplace_back();
+        return result;
+    }
+}
@@ -0,0 +1,302 @@
+#include "pipeline/pipeline.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "book/book_set.h"
+#include "containers/fast_hash.h"
+#include "dat/decode.h"
+#include "dat/reader.h"
+#include "log/logger.h"
+#include "mdt/MDTStruct.h"
+#include "perf/alloc.h"
+#include "perf/counters.h"
+#include "utils.h"
+
+namespace x2h::pipeline
+{
+    namespace
+    {
+        /*!
+         * @brief 需要转发给解码线程的记录长度, 0 表示丢弃
+        */
+        uint32_t forward_len(MsgType type) noexcept
+        {
+            switch (type) {
+                case Msg_SSEL2_Order:
+                    return sizeof(SSEL2_Order);
+                case Msg_SSEL2_Transaction:
+                    return sizeof(SSEL2_Transaction);
+                case Msg_SZSEL2_Order:
+                    return sizeof(SZSEL2_Order);
+                case Msg_SZSEL2_Transaction:
+                    return sizeof(SZSEL2_Transaction);
+                default:
+                    return 0;
+            }
+        }
+
+        static_assert(sizeof(SSEL2_Order) <= MAX_RECORD_LEN && sizeof(SSEL2_Transaction) <= MAX_RECORD_LEN &&
+                      sizeof(SZSEL2_Order) <= MAX_RECORD_LEN && sizeof(SZSEL2_Transaction) <= MAX_RECORD_LEN);
+
+        bool decode_record(const RawRecord &record, type::data::Event &event) noexcept
+        {
+            X2H_COUNTERS(perf::ScopedCounters scoped_counters{perf::msg_of(record.type), perf::Stage::DECODE};)
+            X2H_ALLOC(perf::ScopedAlloc scoped_alloc{perf::msg_of(record.type), perf::Stage::DECODE};)
+            return dat::decode(record.type, record.data, event);
+        }
+
+        void publish_update(Sink &sink, const BookUpdate &update)
+        {
+            X2H_COUNTERS(perf::ScopedCounters scoped_counters{update.msg, perf::Stage::PUBLISH};)
+            X2H_ALLOC(perf::ScopedAlloc scoped_alloc{update.msg, perf::Stage::PUBLISH};)
+            sink.on_update(update);
+        }
+
+#ifdef OB_LATENCY
+        /*!
+         * @brief 输出完成: 更新 -> 输出的耗时, 以及 MDTTime(unix 微秒) -> 输出的墙上时间
+        */
+        void record_publish(const BookUpdate &update) noexcept
+        {
+            auto &recorder = perf::local_recorder();
+            recorder.stage(update.msg, perf::Stage::PUBLISH, perf::elapsed_ns(update.tsc));
+            recorder.end_to_end(update.msg, update.rec_time);
+        }
+#endif
+    }
+
+    FileSink::FileSink(const std::string &file_path)
+            : file_(file_path == "-" ? stdout : std::fopen(file_path.c_str(), "w")),
+              owned_(file_path != "-")
+    {
+        if (file_ == nullptr) {
+            log::error("输出文件 {} 打开失败", file_path);
+        }
+    }
+
+    FileSink::~FileSink()
+    {
+        flush();
+        if (owned_ && file_ != nullptr) std::fclose(file_);
+    }
+
+    void FileSink::on_update(const BookUpdate &update)
+    {
+        if (file_ == nullptr) return;
+
+        fmt::memory_buffer buf;
+        fmt::format_to(std::back_inserter(buf), "{} {}", update.ticker, update.time_ns);
+        for (int i = 0; i < update.bid_count; ++i) {
+            fmt::format_to(std::back_inserter(buf), " b{}:{}", update.bids[i].price, update.bids[i].qty);
+        }
+        for (int i = 0; i < update.ask_count; ++i) {
+            fmt::format_to(std::back_inserter(buf), " a{}:{}", update.asks[i].price, update.asks[i].qty);
+        }
+        buf.push_back('\n');
+        std::fwrite(buf.data(), 1, buf.size(), file_);
+    }
+
+    void FileSink::flush()
+    {
+        if (file_ != nullptr) std::fflush(file_);
+    }
+
+    Pipeline::Pipeline(PipelineConfig config)
+            : config_(std::move(config)),
+              raw_queue_(config_.queue_capacity),
+              decoder_waiter_(config_.decoder.wait)
+    {
+        for (const auto &stage: config_.books) {
+            event_queues_.push_back(std::make_unique<SpscQueue<type::data::Event>>(config_.queue_capacity));
+            book_waiters_.push_back(std::make_unique<Waiter>(stage.wait));
+            update_queues_.push_back(std::make_unique<SpscQueue<BookUpdate>>(config_.queue_capacity));
+        }
+        for (const auto &stage: config_.sinks) {
+            sink_waiters_.push_back(std::make_unique<Waiter>(stage.wait));
+        }
+
+        sink_factory_ = [this](size_t index) -> std::unique_ptr<Sink> {
+            auto path = config_.sink_output;
+            if (path != "-" && config_.sinks.size() > 1) path += fmt::format(".{}", index);
+            return std::make_unique<FileSink>(path);
+        };
+    }
+
+    Pipeline::~Pipeline() = default;
+
+    std::thread Pipeline::spawn(const char *name, const StageConfig &stage, std::function<void()> fn)
+    {
+        std::thread thread(std::move(fn));
+        if (stage.cpu >= 0 && util::cpu_affinity_of_thread(thread, static_cast<uint32_t>(stage.cpu)) != 0) {
+            log::warn("{} 线程绑定 CPU {} 失败", name, stage.cpu);
+        }
+        log::info("{} 线程启动, cpu: {}, wait: {}", name, stage.cpu, wait_strategy_name(stage.wait));
+        return thread;
+    }
+
+    void Pipeline::run()
+    {
+        std::vector<std::thread> threads;
+
+        for (size_t i = 0; i < config_.sinks.size(); ++i) {
+            threads.push_back(spawn("sink", config_.sinks[i], [this, i] { sink_stage(i); }));
+        }
+        for (size_t i = 0; i < config_.books.size(); ++i) {
+            threads.push_back(spawn("book", config_.books[i], [this, i] { book_stage(i); }));
+        }
+        threads.push_back(spawn("decoder", config_.decoder, [this] { decode_stage(); }));
+        threads.push_back(spawn("reader", config_.reader, [this] { read_stage(); }));
+
+        for (auto &thread: threads) thread.join();
+
+        log::info("流水线结束, records: {}, events: {}, applied: {}, published: {}",
+                  stats_.records.load(), stats_.events.load(), stats_.applied.load(), stats_.published.load());
+    }
+
+    void Pipeline::read_stage()
+    {
+        int spins = 0;
+        DatReader reader{config_.dat_file, [&](const std::shared_ptr<Item> &item) {
+            uint32_t len = forward_len(item->DataType);
+            if (len == 0) return;
+
+            RawRecord *slot;
+            while ((slot = raw_queue_.alloc()) == nullptr) {
+                backoff(config_.reader.wait, spins);
+            }
+            spins = 0;
+
+            slot->type = item->DataType;
+            slot->len = len;
+            X2H_LATENCY(slot->tsc = perf::rdtsc();)
+            std::memcpy(slot->data, item->Data, len);
+            raw_queue_.publish();
+            decoder_waiter_.notify();
+            stats_.records.fetch_add(1, std::memory_order_relaxed);
+        }};
+        //! 关注股票之外的记录在读取层丢弃, 不进入队列
+        reader.set_filter(SymbolFilter{config_.symbols});
+        reader.read();
+
+        raw_queue_.close();
+        decoder_waiter_.notify();
+    }
+
+    void Pipeline::decode_stage()
+    {
+        const size_t shards = event_queues_.size();
+        int spins = 0;
+
+        while (true) {
+            decoder_waiter_.wait([&] { return raw_queue_.front() != nullptr || raw_queue_.drained(); });
+
+            RawRecord *record = raw_queue_.front();
+            if (record == nullptr) break;
+
+            type::data::Event event;
+            if (decode_record(*record, event)) {
+                X2H_LATENCY(perf::local_recorder().stage(perf::msg_of(record->type), perf::Stage::DECODE,
+                                                         perf::elapsed_ns(record->tsc));)
+                auto key = book::BookSet::key(event.ticker());
+                size_t shard = FastHash{}(key) % shards;
+                auto &queue = *event_queues_[shard];
+                while (!queue.try_push(event)) {
+                    backoff(config_.decoder.wait, spins);
+                }
+                spins = 0;
+                book_waiters_[shard]->notify();
+                stats_.events.fetch_add(1, std::memory_order_relaxed);
+            }
+            raw_queue_.pop();
+        }
+
+        for (size_t i = 0; i < shards; ++i) {
+            event_queues_[i]->close();
+            book_waiters_[i]->notify();
+        }
+    }
+
+    void Pipeline::book_stage(size_t index)
+    {
+        book::BookSet books{config_.max_books};
+        books.set_compaction(config_.compact_idle_ms * 1'000'000);
+        auto &queue = *event_queues_[index];
+        auto &waiter = *book_waiters_[index];
+        auto &updates = *update_queues_[index];
+        const bool publish = !config_.sinks.empty();
+        const int levels = std::clamp(config_.sink_levels, 0, MAX_LEVELS);
+        int spins = 0;
+
+        while (true) {
+            waiter.wait([&] { return queue.front() != nullptr || queue.drained(); });
+
+            auto *event = queue.front();
+            if (event == nullptr) break;
+
+            auto *book = books.apply(*event);
+            stats_.applied.fetch_add(1, std::memory_order_relaxed);
+
+            if (book != nullptr && publish) {
+                BookUpdate *update;
+                while ((update = updates.alloc()) == nullptr) {
+                    backoff(config_.books[index].wait, spins);
+                }
+                spins = 0;
+
+                std::memcpy(update->ticker, event->ticker(), sizeof(update->ticker));
+                update->time_ns = event->time_ns();
+                update->rec_time = event->rec_time();
+                update->msg = perf::msg_of(*event);
+                X2H_LATENCY(update->tsc = perf::rdtsc();)
+                update->bid_count = book->bid_depth(update->bids, levels);
+                update->ask_count = book->ask_depth(update->asks, levels);
+                updates.publish();
+                sink_waiters_[index % sink_waiters_.size()]->notify();
+            }
+            queue.pop();
+        }
+
+        updates.close();
+        if (publish) sink_waiters_[index % sink_waiters_.size()]->notify();
+        books.log_memory(0);
+    }
+
+    void Pipeline::sink_stage(size_t index)
+    {
+        auto sink = sink_factory_(index);
+        auto &waiter = *sink_waiters_[index];
+
+        std::vector<SpscQueue<BookUpdate> *> inputs;
+        for (size_t i = index; i < update_queues_.size(); i += sink_waiters_.size()) {
+            inputs.push_back(update_queues_[i].get());
+        }
+
+        auto ready = [&] {
+            return std::any_of(inputs.begin(), inputs.end(), [](auto *q) { return q->front() != nullptr; }) ||
+                   std::all_of(inputs.begin(), inputs.end(), [](auto *q) { return q->drained(); });
+        };
+
+        while (true) {
+            waiter.wait(ready);
+
+            bool busy = false;
+            for (auto *input: inputs) {
+                //! 轮询各上游队列, 每次最多取一批, 避免单个队列独占
+                for (int i = 0; i < 256; ++i) {
+                    auto *update = input->front();
+                    if (update == nullptr) break;
+                    publish_update(*sink, *update);
+                    X2H_LATENCY(record_publish(*update);)
+                    input->pop();
+                    busy = true;
+                    stats_.published.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+
+            if (!busy && std::all_of(inputs.begin(), inputs.end(), [](auto *q) { return q->drained(); })) break;
+        }
+
+        sink->flush();
+    }
+}
@@ -0,0 +1,197 @@
+#include "replay/batch_runner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <semaphore>
+#include <thread>
+
+#include "book/book_set.h"
+#include "dat/decode.h"
+#include "dat/reader.h"
+#include "log/logger.h"
+#include "utils.h"
+
+namespace x2h::replay
+{
+    namespace
+    {
+        using ConfigMap = std::unordered_map<std::string, std::string>;
+
+        int64_t get_int(const ConfigMap &config, const std::string &key, int64_t def)
+        {
+            auto it = config.find(key);
+            return (it == config.end() || it->second.empty()) ? def : std::stoll(it->second);
+        }
+
+        /*!
+         * @brief 文件名的前 8 位数字为日期, 如 202109030705.dat -> 20210903
+        */
+        int64_t parse_date(const std::string &stem)
+        {
+            if (stem.size() < 8 || !std::all_of(stem.begin(), stem.begin() + 8, ::isdigit)) return -1;
+            return std::stoll(stem.substr(0, 8));
+        }
+
+        template<typename Map>
+        void write_levels(fmt::memory_buffer &buf, const char *side, const Map &book, int limit)
+        {
+            int i = 0;
+            for (const auto &[price, qty]: book) {
+                if (i++ >= limit) break;
+                fmt::format_to(std::back_inserter(buf), " {}{}:{}", side, price, qty);
+            }
+        }
+    }
+
+    BatchConfig BatchConfig::load(const std::string &file_path)
+    {
+        auto config = util::read_config(file_path);
+        BatchConfig result;
+
+        result.dir = config["batch.dir"];
+        result.from_date = get_int(config, "batch.from", 0);
+        result.to_date = get_int(config, "batch.to", 0);
+        result.threads = static_cast<size_t>(get_int(config, "batch.threads", std::thread::hardware_concurrency()));
+        result.max_mappings = static_cast<size_t>(get_int(config, "batch.max_mappings", 4));
+        result.max_books = static_cast<size_t>(get_int(config, "batch.max_books", 0));
+        result.levels = static_cast<int>(get_int(config, "batch.levels", 5));
+        if (!config["batch.output"].empty()) result.output_dir = config["batch.output"];
+        for (const auto &cpu: util::split(config["batch.cpus"])) {
+            result.cpus.push_back(std::stoi(cpu));
+        }
+        result.symbols = util::split(config["symbols"]);
+
+        return result;
+    }
+
+    BatchRunner::BatchRunner(BatchConfig config)
+            : config_(std::move(config))
+    {
+        if (config_.threads == 0) config_.threads = 1;
+        if (config_.max_mappings == 0) config_.max_mappings = 1;
+    }
+
+    std::vector<DayFile> BatchRunner::list_files() const
+    {
+        std::vector<DayFile> files;
+
+        std::error_code ec;
+        for (const auto &entry: std::filesystem::directory_iterator(config_.dir, ec)) {
+            if (!entry.is_regular_file() || entry.path().extension() != ".dat") continue;
+
+            auto date = parse_date(entry.path().stem().string());
+            if (date < 0) continue;
+            if (config_.from_date != 0 && date < config_.from_date) continue;
+            if (config_.to_date != 0 && date > config_.to_date) continue;
+
+            files.push_back({date, entry.path().string()});
+        }
+        if (ec) log::error("目录 {} 读取失败: {}", config_.dir, ec.message());
+
+        std::sort(files.begin(), files.end(), [](const DayFile &a, const DayFile &b) {
+            return a.path < b.path;
+        });
+        return files;
+    }
+
+    size_t BatchRunner::run()
+    {
+        auto files = list_files();
+        log::info("待处理 {} 个文件, threads: {}, max_mappings: {}, max_books: {}",
+                  files.size(), config_.threads, config_.max_mappings, config_.max_books);
+
+        std::filesystem::create_directories(config_.output_dir);
+
+        std::counting_semaphore<> mappings(static_cast<std::ptrdiff_t>(config_.max_mappings));
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+
+        auto worker = [&] {
+            size_t i;
+            while ((i = next.fetch_add(1, std::memory_order_relaxed)) < files.size()) {
+                //! 限制同时映射的文件数, 从而限制总内存
+                mappings.acquire();
+                bool ok = run_day(files[i]);
+                mappings.release();
+                if (ok) done.fetch_add(1, std::memory_order_relaxed);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < std::min(config_.threads, files.size()); ++i) {
+            threads.emplace_back(worker);
+            if (i < config_.cpus.size() && config_.cpus[i] >= 0) {
+                util::cpu_affinity_of_thread(threads.back(), static_cast<uint32_t>(config_.cpus[i]));
+            }
+        }
+        for (auto &thread: threads) thread.join();
+
+        log::info("处理完成 {}/{}", done.load(), files.size());
+        return done.load();
+    }
+
+    bool BatchRunner::run_day(const DayFile &file) const
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        std::vector<uint64_t> watch;
+        for (const auto &symbol: config_.symbols) {
+            char ticker[20]{};
+            std::strncpy(ticker, symbol.c_str(), sizeof(ticker) - 1);
+            watch.push_back(book::BookSet::key(ticker));
+        }
+        std::sort(watch.begin(), watch.end());
+
+        book::BookSet books{config_.max_books};
+        uint64_t events = 0;
+
+        DatReader reader{file.path, [&](const std::shared_ptr<Item> &item) {
+            type::data::Event event;
+            if (!dat::decode(item->DataType, item->Data, event)) return;
+            if (!watch.empty() &&
+                !std::binary_search(watch.begin(), watch.end(), book::BookSet::key(event.ticker()))) {
+                return;
+            }
+            books.apply(event);
+            ++events;
+        }, ReadMode::MMAP};
+        reader.read();
+
+        auto stem = std::filesystem::path(file.path).stem().string();
+        auto out_path = (std::filesystem::path(config_.output_dir) / (stem + ".txt")).string();
+        std::FILE *out = std::fopen(out_path.c_str(), "w");
+        if (out == nullptr) {
+            log::error("结果文件 {} 打开失败", out_path);
+            return false;
+        }
+
+        //! 按代码排序输出, 便于不同版本之间 diff
+        std::vector<const book::OrderBook *> sorted;
+        for (const auto &[key, book]: books) sorted.push_back(book.get());
+        std::sort(sorted.begin(), sorted.end(), [](auto *a, auto *b) {
+            return std::strncmp(a->symbol().code, b->symbol().code, sizeof(a->symbol().code)) < 0;
+        });
+
+        fmt::memory_buffer buf;
+        for (const auto *book: sorted) {
+            buf.clear();
+            fmt::format_to(std::back_inserter(buf), "{} {} bids:{} asks:{}",
+                           std::string_view(book->symbol().code, strnlen(book->symbol().code, sizeof(book->symbol().code))),
+                           book->last_msg_time(), book->bid_size(), book->ask_size());
+            write_levels(buf, "b", book->get_bid_book(), config_.levels);
+            write_levels(buf, "a", book->get_ask_book(), config_.levels);
+            buf.push_back('\n');
+            std::fwrite(buf.data(), 1, buf.size(), out);
+        }
+        std::fclose(out);
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+        log::info("{} 完成, events: {}, books: {}, rejected: {}, 耗时 {}", file.path, events, books.size(),
+                  books.rejected(), util::time_to_str(elapsed));
+        return true;
+    }
+}
@@ -0,0 +1,225 @@
+#include "replay/checkpoint.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+#include "dat/decode.h"
+#include "dat/reader.h"
+#include "log/logger.h"
+#include "timestamp.h"
+#include "utils.h"
+
+namespace x2h::replay
+{
+    namespace
+    {
+        constexpr char MAGIC[4] = {'O', 'B', 'C', 'K'};
+        constexpr uint32_t VERSION = 1;
+    }
+
+    Checkpointer::Checkpointer(std::string dat_file, std::string dir, int64_t interval_ns)
+            : dat_file_(std::move(dat_file)),
+              dir_(std::move(dir)),
+              interval_ns_(interval_ns > 0 ? interval_ns : 60'000'000'000)
+    {}
+
+    std::string Checkpointer::checkpoint_path(int64_t time_ns) const
+    {
+        auto stem = std::filesystem::path(dat_file_).filename().string();
+        return (std::filesystem::path(dir_) /
+                fmt::format("{}.{:09}.ckpt", stem, util::ns_to_hhmmssmmm(time_ns))).string();
+    }
+
+    bool Checkpointer::write(const std::string &path, const book::BookSet &books, const CheckpointHeader &header)
+    {
+        //! 先写临时文件再改名, 中断时不会留下残缺的存档
+        auto tmp = path + ".tmp";
+        std::FILE *file = std::fopen(tmp.c_str(), "wb");
+        if (file == nullptr) {
+            log::error("存档 {} 创建失败", tmp);
+            return false;
+        }
+
+        bool ok = util::write_pod(file, header) && books.save(file);
+        ok = (std::fclose(file) == 0) && ok;
+        if (ok) {
+            std::filesystem::rename(tmp, path);
+        } else {
+            log::error("存档 {} 写入失败", path);
+            std::filesystem::remove(tmp);
+        }
+        return ok;
+    }
+
+    bool Checkpointer::read(const std::string &path, book::BookSet &books, CheckpointHeader &header)
+    {
+        std::FILE *file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr) {
+            log::error("存档 {} 打开失败", path);
+            return false;
+        }
+
+        bool ok = util::read_pod(file, header) &&
+                  std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+                  header.version == VERSION &&
+                  books.load(file);
+        std::fclose(file);
+
+        if (!ok) log::error("存档 {} 格式错误", path);
+        return ok;
+    }
+
+    size_t Checkpointer::run()
+    {
+        std::filesystem::create_directories(dir_);
+
+        book::BookSet books{};
+        int64_t next_ns = -1;
+        uint64_t records = 0;
+        size_t written = 0;
+
+        DatReader *self = nullptr;
+        DatReader reader{dat_file_, [&](const std::shared_ptr<Item> &item) {
+            type::data::Event event;
+            if (dat::decode(item->DataType, item->Data, event)) {
+                int64_t time_ns = event.time_ns();
+                if (next_ns < 0) {
+                    next_ns = (time_ns / interval_ns_ + 1) * interval_ns_;
+                } else if (time_ns >= next_ns) {
+                    //! 存档在当前记录之前, 对应偏移为当前记录的起始位置
+                    CheckpointHeader header{};
+                    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+                    header.version = VERSION;
+                    header.offset = self->record_offset();
+                    header.time_ns = next_ns;
+                    header.records = records;
+                    if (write(checkpoint_path(next_ns), books, header)) ++written;
+
+                    next_ns = (time_ns / interval_ns_ + 1) * interval_ns_;
+                }
+                books.apply(event);
+            }
+            ++records;
+        }, ReadMode::MMAP};
+        self = &reader;
+        reader.read();
+
+        log::info("{} 重放完成, records: {}, 存档: {}", dat_file_, records, written);
+        return written;
+    }
+
+    std::vector<CheckpointInfo> Checkpointer::list() const
+    {
+        std::vector<CheckpointInfo> result;
+        auto prefix = std::filesystem::path(dat_file_).filename().string() + ".";
+
+        std::error_code ec;
+        for (const auto &entry: std::filesystem::directory_iterator(dir_, ec)) {
+            auto name = entry.path().filename().string();
+            if (entry.path().extension() != ".ckpt" || name.rfind(prefix, 0) != 0) continue;
+
+            auto time = name.substr(prefix.size(), name.size() - prefix.size() - 5);
+            if (time.empty() || !std::all_of(time.begin(), time.end(), ::isdigit)) continue;
+            result.push_back({entry.path().string(), util::hhmmssmmm_to_ns(std::stoll(time)), 0});
+        }
+
+        std::sort(result.begin(), result.end(), [](const auto &a, const auto &b) {
+            return a.time_ns < b.time_ns;
+        });
+        return result;
+    }
+
+    bool Checkpointer::bootstrap(const std::vector<std::string> &symbols, size_t end_offset,
+                                 book::BookSet &books) const
+    {
+        if (symbols.empty()) return false;
+
+        auto checkpoints = list();
+        CheckpointHeader header{};
+        book::BookSet saved{};
+        std::string used;
+        for (auto it = checkpoints.rbegin(); it != checkpoints.rend(); ++it) {
+            if (read(it->path, saved, header) && header.offset <= end_offset) {
+                used = it->path;
+                break;
+            }
+        }
+        if (used.empty()) {
+            header = {};
+            saved.clear();
+        }
+
+        for (const auto &symbol: symbols) {
+            char ticker[20]{};
+            std::strncpy(ticker, symbol.c_str(), sizeof(ticker) - 1);
+            auto key = book::BookSet::key(ticker);
+            if (auto book = saved.extract(key)) {
+                books.insert(std::move(book));
+            } else {
+                books.erase(key);
+            }
+        }
+
+        //! 不交给 DatReader 过滤, 以便在 end_offset 处及时停止
+        SymbolFilter filter{symbols};
+        uint64_t replayed = 0;
+        DatReader *self = nullptr;
+        DatReader reader{dat_file_, [&](const std::shared_ptr<Item> &item) {
+            if (self->record_offset() >= end_offset) {
+                self->stop();
+                return;
+            }
+            if (!filter.accept(item->DataType, item->Data, item->DataLen)) return;
+
+            type::data::Event event;
+            if (dat::decode(item->DataType, item->Data, event)) {
+                books.apply(event);
+                ++replayed;
+            }
+        }, ReadMode::MMAP};
+        self = &reader;
+        reader.seek(header.offset);
+        reader.read();
+
+        log::info("bootstrap {} 个股票: 存档 {}, 重放 [{}, {}) 中 {} 条事件", symbols.size(),
+                  used.empty() ? std::string("无") : used, header.offset, end_offset, replayed);
+        return !used.empty();
+    }
+
+    bool Checkpointer::seek(int64_t time_ns, book::BookSet &books) const
+    {
+        auto checkpoints = list();
+        auto it = std::upper_bound(checkpoints.begin(), checkpoints.end(), time_ns,
+                                   [](int64_t t, const CheckpointInfo &info) { return t < info.time_ns; });
+
+        CheckpointHeader header{};
+        bool found = false;
+        books.clear();
+        if (it != checkpoints.begin()) {
+            found = read(std::prev(it)->path, books, header);
+            if (!found) books.clear();
+        }
+        if (!found) header = {};
+
+        uint64_t replayed = 0;
+        DatReader *self = nullptr;
+        DatReader reader{dat_file_, [&](const std::shared_ptr<Item> &item) {
+            type::data::Event event;
+            if (!dat::decode(item->DataType, item->Data, event)) return;
+            if (event.time_ns() > time_ns) {
+                self->stop();
+                return;
+            }
+            books.apply(event);
+            ++replayed;
+        }, ReadMode::MMAP};
+        self = &reader;
+        reader.seek(header.offset);
+        reader.read();
+
+        log::info("seek {}: 存档 {}, 偏移 {}, 重放 {} 条事件", util::ns_to_hhmmssmmm(time_ns),
+                  found ? std::prev(it)->path : std::string("无"), header.offset, replayed);
+        return found;
+    }
+}
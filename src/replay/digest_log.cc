@@ -0,0 +1,181 @@
+#include "replay/digest_log.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "dat/mapped_file.h"
+#include "log/logger.h"
+#include "utils.h"
+
+namespace x2h::replay
+{
+    namespace
+    {
+        constexpr char DIGEST_MAGIC[4] = {'O', 'B', 'D', 'G'};
+        constexpr uint32_t DIGEST_VERSION = 1;
+
+        /*!
+         * @brief 内存映射的摘要文件
+        */
+        struct DigestFile
+        {
+            MappedFile file;
+            DigestHeader header{};
+            size_t count{0};
+
+            bool open(const std::string &path)
+            {
+                if (!file.open(path)) {
+                    log::error("无法打开摘要文件 {}", path);
+                    return false;
+                }
+                if (file.size() < sizeof(DigestHeader)) {
+                    log::error("摘要文件 {} 不完整", path);
+                    return false;
+                }
+                std::memcpy(&header, file.data(), sizeof(header));
+                if (std::memcmp(header.magic, DIGEST_MAGIC, sizeof(DIGEST_MAGIC)) != 0 ||
+                    header.version != DIGEST_VERSION) {
+                    log::error("摘要文件 {} 格式不匹配", path);
+                    return false;
+                }
+                //! 末尾不完整的记录忽略
+                count = (file.size() - sizeof(DigestHeader)) / sizeof(DigestRecord);
+                return true;
+            }
+
+            DigestRecord at(size_t index) const noexcept
+            {
+                DigestRecord record;
+                std::memcpy(&record, file.data() + sizeof(DigestHeader) + index * sizeof(DigestRecord),
+                            sizeof(record));
+                return record;
+            }
+        };
+
+        std::string format_time(int64_t time_ns)
+        {
+            int64_t ms = time_ns / 1'000'000;
+            return fmt::format("{:02}:{:02}:{:02}.{:03}", ms / 3'600'000, ms / 60'000 % 60, ms / 1'000 % 60,
+                               ms % 1'000);
+        }
+    }
+
+    DigestWriter::DigestWriter(const std::string &path, uint64_t every_events, int64_t every_ns,
+                               uint64_t begin, uint64_t end)
+    {
+        std::memcpy(header_.magic, DIGEST_MAGIC, sizeof(DIGEST_MAGIC));
+        header_.version = DIGEST_VERSION;
+        header_.every_events = every_events;
+        header_.every_ns = every_ns;
+        header_.begin = begin;
+        header_.end = end;
+
+        file_ = std::fopen(path.c_str(), "wb");
+        if (file_ == nullptr) {
+            log::error("无法创建摘要文件 {}", path);
+            return;
+        }
+        if (!util::write_pod(file_, header_)) {
+            log::error("写入摘要文件 {} 失败", path);
+            std::fclose(file_);
+            file_ = nullptr;
+        }
+    }
+
+    DigestWriter::~DigestWriter()
+    {
+        if (file_ != nullptr) std::fclose(file_);
+    }
+
+    void DigestWriter::on_event(int64_t time_ns, const book::BookSet &books)
+    {
+        ++events_;
+        if (file_ == nullptr || events_ < header_.begin || events_ >= header_.end) return;
+
+        bool due = header_.every_events > 0 && events_ % header_.every_events == 0;
+        if (header_.every_ns > 0 && time_ns >= next_ns_) {
+            //! 第一个事件只确定时间边界
+            due = due || next_ns_ != 0;
+            next_ns_ = (time_ns / header_.every_ns + 1) * header_.every_ns;
+        }
+
+        last_time_ns_ = time_ns;
+        written_ = due;
+        if (due) write(time_ns, books);
+    }
+
+    void DigestWriter::finish(const book::BookSet &books)
+    {
+        if (file_ == nullptr) return;
+        if (!written_) write(last_time_ns_, books);
+        written_ = true;
+        std::fflush(file_);
+    }
+
+    void DigestWriter::write(int64_t time_ns, const book::BookSet &books)
+    {
+        DigestRecord record{events_, time_ns, books.digest()};
+        if (!util::write_pod(file_, record)) {
+            log::error("写入摘要失败, event: {}", events_);
+            std::fclose(file_);
+            file_ = nullptr;
+            return;
+        }
+        ++records_;
+    }
+
+    int compare_digests(const std::string &a, const std::string &b)
+    {
+        DigestFile fa;
+        DigestFile fb;
+        if (!fa.open(a) || !fb.open(b)) return -1;
+        if (std::memcmp(&fa.header, &fb.header, sizeof(DigestHeader)) != 0) {
+            log::error("两个摘要文件的间隔配置不同, 无法比较");
+            return -1;
+        }
+
+        auto same = [&](size_t i) {
+            auto x = fa.at(i);
+            auto y = fb.at(i);
+            return x.event == y.event && x.digest == y.digest;
+        };
+
+        //! 找第一条不一致的记录
+        const size_t n = std::min(fa.count, fb.count);
+        size_t lo = 0;
+        size_t hi = n;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (same(mid)) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+
+        if (lo == n) {
+            if (fa.count == fb.count) {
+                log::info("摘要一致, records: {}", n);
+                return 0;
+            }
+            log::warn("前 {} 条摘要一致, 但记录数不同: {} / {}", n, fa.count, fb.count);
+            return 1;
+        }
+
+        auto x = fa.at(lo);
+        auto y = fb.at(lo);
+        uint64_t after = lo > 0 ? fa.at(lo - 1).event : std::max<uint64_t>(fa.header.begin, 1) - 1;
+        if (x.event != y.event) {
+            log::warn("第 {} 条记录的事件序号不同: {} / {}, 两次运行的事件流不一致", lo, x.event, y.event);
+        } else if (x.event == after + 1) {
+            log::warn("第一个不一致的事件: {}, 市场时间: {}, digest: {:016x} / {:016x}",
+                      x.event, format_time(x.time_ns), x.digest, y.digest);
+        } else {
+            log::warn("第一个不一致的记录: #{}, 事件区间 ({}, {}], 市场时间: {}, digest: {:016x} / {:016x}",
+                      lo, after, x.event, format_time(x.time_ns), x.digest, y.digest);
+            log::warn("以间隔 1, begin {}, end {} 重新生成摘要可定位到单个事件", after + 1, x.event + 1);
+        }
+        return 1;
+    }
+}
@@ -0,0 +1,135 @@
+#include "replay/parallel_replay.h"
+
+#include "book/book_set.h"
+#include "dat/decode.h"
+#include "dat/reader.h"
+#include "log/logger.h"
+#include "pipeline/wait_strategy.h"
+
+namespace x2h::replay
+{
+    ParallelReplay::ParallelReplay(ParallelReplayConfig config)
+            : config_(std::move(config)),
+              pool_(config_.threads, config_.cpus)
+    {}
+
+    ParallelReplay::~ParallelReplay()
+    {
+        pool_.wait_idle();
+    }
+
+    const book::OrderBook *ParallelReplay::find(const char *ticker) const noexcept
+    {
+        auto it = streams_.find(book::BookSet::key(ticker));
+        return it == streams_.end() ? nullptr : it->second->book.get();
+    }
+
+    void ParallelReplay::run(const std::string &dat_file)
+    {
+        DatReader reader{dat_file, [this](const std::shared_ptr<Item> &item) {
+            type::data::Event event;
+            if (dat::decode(item->DataType, item->Data, event)) {
+                feed(event);
+            }
+        }};
+        reader.read();
+        finish();
+    }
+
+    void ParallelReplay::feed(const type::data::Event &event)
+    {
+        auto key = book::BookSet::key(event.ticker());
+        auto it = streams_.find(key);
+        if (it == streams_.end()) {
+            auto stream = std::make_unique<SymbolStream>();
+            Symbol symbol{next_id_++, event.ticker(), event.exchange()};
+            stream->book = std::make_unique<book::OrderBook>(symbol);
+            stream->owner = this;
+            stream->pending.reserve(config_.batch_size);
+            it = streams_.emplace(key, std::move(stream)).first;
+        }
+
+        auto &stream = *it->second;
+        stream.pending.push_back(event);
+        ++events_;
+
+        if (stream.pending.size() >= config_.batch_size) {
+            flush(stream);
+        }
+    }
+
+    void ParallelReplay::finish()
+    {
+        for (auto &[key, stream]: streams_) {
+            if (!stream->pending.empty()) flush(*stream);
+        }
+        pool_.wait_idle();
+
+        auto stats = pool_.stats();
+        for (size_t i = 0; i < stats.size(); ++i) {
+            log::info("worker {}: executed {}, stolen {}", i, stats[i].executed, stats[i].stolen);
+        }
+    }
+
+    void ParallelReplay::flush(SymbolStream &stream)
+    {
+        //! 背压: 线程池处理不过来时等待, 限制内存占用
+        int spins = 0;
+        while (buffered_.load(std::memory_order_acquire) >= config_.max_buffered) {
+            pipeline::backoff(pipeline::WaitStrategy::SPIN_YIELD, spins);
+        }
+        buffered_.fetch_add(stream.pending.size(), std::memory_order_acq_rel);
+
+        bool schedule;
+        {
+            std::lock_guard<std::mutex> lock(stream.mutex);
+            stream.batches.push_back(std::move(stream.pending));
+            schedule = !stream.scheduled;
+            stream.scheduled = true;
+        }
+
+        stream.pending = {};
+        stream.pending.reserve(config_.batch_size);
+
+        if (schedule) pool_.submit({&ParallelReplay::run_stream, &stream});
+    }
+
+    /*!
+     * @brief 处理一个股票积压的批次. 同一股票同时只有一个该任务在运行
+    */
+    void ParallelReplay::run_stream(void *arg)
+    {
+        auto &stream = *static_cast<SymbolStream *>(arg);
+        auto *self = stream.owner;
+
+        for (size_t n = 0; n < self->config_.batches_per_task; ++n) {
+            std::vector<type::data::Event> batch;
+            {
+                std::lock_guard<std::mutex> lock(stream.mutex);
+                if (stream.batches.empty()) {
+                    stream.scheduled = false;
+                    return;
+                }
+                batch = std::move(stream.batches.front());
+                stream.batches.pop_front();
+            }
+
+            for (const auto &event: batch) {
+                if (event.type == type::data::EventType::ORDER) {
+                    stream.book->on_order(event.order);
+                } else {
+                    stream.book->on_trade(event.trade);
+                }
+            }
+            self->buffered_.fetch_sub(batch.size(), std::memory_order_acq_rel);
+        }
+
+        //! 还有积压时放到队列头部(pop_local 从尾部取), 让同一 worker 上已在等待的其它股票先推进
+        std::lock_guard<std::mutex> lock(stream.mutex);
+        if (stream.batches.empty()) {
+            stream.scheduled = false;
+        } else {
+            self->pool_.yield({&ParallelReplay::run_stream, &stream});
+        }
+    }
+}
@@ -0,0 +1,166 @@
+#include "replay/work_stealing_pool.h"
+
+#include "log/logger.h"
+#include "pipeline/wait_strategy.h"
+#include "utils.h"
+
+namespace x2h::replay
+{
+    namespace
+    {
+        /* 当前线程所属的 pool 与 worker 序号 */
+        thread_local const WorkStealingPool *local_pool = nullptr;
+        thread_local size_t local_index = 0;
+
+        class SpinGuard
+        {
+        public:
+            explicit SpinGuard(std::atomic_flag &flag) noexcept
+                    : flag_(flag)
+            {
+                while (flag_.test_and_set(std::memory_order_acquire)) {
+                    pipeline::cpu_relax();
+                }
+            }
+
+            ~SpinGuard()
+            { flag_.clear(std::memory_order_release); }
+
+        private:
+            std::atomic_flag &flag_;
+        };
+    }
+
+    WorkStealingPool::WorkStealingPool(size_t threads, const std::vector<int> &cpus)
+    {
+        if (threads == 0) threads = 1;
+
+        for (size_t i = 0; i < threads; ++i) {
+            workers_.push_back(std::make_unique<Worker>());
+        }
+        for (size_t i = 0; i < threads; ++i) {
+            threads_.emplace_back(&WorkStealingPool::run, this, i);
+            if (i < cpus.size() && cpus[i] >= 0 &&
+                util::cpu_affinity_of_thread(threads_.back(), static_cast<uint32_t>(cpus[i])) != 0) {
+                log::warn("worker {} 绑定 CPU {} 失败", i, cpus[i]);
+            }
+        }
+    }
+
+    WorkStealingPool::~WorkStealingPool()
+    {
+        running_.store(false, std::memory_order_release);
+        epoch_.fetch_add(1, std::memory_order_seq_cst);
+        epoch_.notify_all();
+        for (auto &thread: threads_) thread.join();
+    }
+
+    void WorkStealingPool::submit(Task task)
+    {
+        push(task, false);
+    }
+
+    void WorkStealingPool::yield(Task task)
+    {
+        push(task, true);
+    }
+
+    void WorkStealingPool::push(Task task, bool front)
+    {
+        pending_.fetch_add(1, std::memory_order_acq_rel);
+
+        size_t index = (local_pool == this) ? local_index
+                                            : next_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+        {
+            SpinGuard guard(workers_[index]->lock);
+            if (front) {
+                workers_[index]->tasks.push_front(task);
+            } else {
+                workers_[index]->tasks.push_back(task);
+            }
+        }
+
+        epoch_.fetch_add(1, std::memory_order_seq_cst);
+        if (sleepers_.load(std::memory_order_seq_cst) > 0) epoch_.notify_all();
+    }
+
+    void WorkStealingPool::wait_idle()
+    {
+        uint64_t pending;
+        while ((pending = pending_.load(std::memory_order_acquire)) != 0) {
+            pending_.wait(pending, std::memory_order_acquire);
+        }
+    }
+
+    std::vector<WorkerStats> WorkStealingPool::stats() const
+    {
+        std::vector<WorkerStats> result;
+        for (const auto &worker: workers_) {
+            result.push_back(worker->stats);
+        }
+        return result;
+    }
+
+    bool WorkStealingPool::pop_local(Worker &worker, Task &task)
+    {
+        SpinGuard guard(worker.lock);
+        if (worker.tasks.empty()) return false;
+        task = worker.tasks.back();
+        worker.tasks.pop_back();
+        return true;
+    }
+
+    bool WorkStealingPool::steal(size_t thief, Task &task)
+    {
+        const size_t n = workers_.size();
+        for (size_t i = 1; i < n; ++i) {
+            auto &victim = *workers_[(thief + i) % n];
+            SpinGuard guard(victim.lock);
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.front();
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void WorkStealingPool::run(size_t index)
+    {
+        local_pool = this;
+        local_index = index;
+        auto &self = *workers_[index];
+
+        int idle = 0;
+        while (true) {
+            uint32_t epoch = epoch_.load(std::memory_order_seq_cst);
+
+            Task task{};
+            bool found = pop_local(self, task);
+            if (!found && steal(index, task)) {
+                found = true;
+                ++self.stats.stolen;
+            }
+
+            if (found) {
+                idle = 0;
+                task.fn(task.arg);
+                ++self.stats.executed;
+                if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    pending_.notify_all();
+                }
+                continue;
+            }
+
+            if (!running_.load(std::memory_order_acquire)) break;
+
+            if (++idle < pipeline::Waiter::SPIN_LIMIT) {
+                pipeline::cpu_relax();
+            } else {
+                sleepers_.fetch_add(1, std::memory_order_seq_cst);
+                epoch_.wait(epoch, std::memory_order_seq_cst);
+                sleepers_.fetch_sub(1, std::memory_order_seq_cst);
+            }
+        }
+    }
+}
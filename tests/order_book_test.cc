@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <cstring>
+
+#include "book/order_book.h"
+#include "test.h"
+
+namespace
+{
+    using namespace x2h;
+
+    book::OrderBook make_book()
+    {
+        char code[8] = "000001";
+        return book::OrderBook{Symbol{1, code, type::data::Exchange::SZ}};
+    }
+
+    type::data::Trade sz_fill(double price, int64_t qty, int64_t bid_id, int64_t ask_id)
+    {
+        type::data::Trade trade{};
+        std::strcpy(trade.ticker, "000001");
+        trade.time = 20210903'09'30'00'000;
+        trade.time_ns = 34'200'000'000'000;
+        trade.price = price;
+        trade.qty = qty;
+        trade.bid_id = bid_id;
+        trade.ask_id = ask_id;
+        trade.trade_flag = 'F';
+        trade.exchange = type::data::Exchange::SZ;
+        return trade;
+    }
+}
+
+TEST(hybrid_bid_partial_fill_keeps_residual)
+{
+    auto book = make_book();
+    type::data::PriceLevel bids[] = {{10.00, 1000}, {9.99, 500}};
+    type::data::PriceLevel asks[] = {{10.01, 800}};
+    book.resync(bids, 2, asks, 1);
+    CHECK(book.hybrid());
+
+    //! 快照前挂出的买单(序号较小)在 10.00 被吃掉一部分
+    book.on_trade(sz_fill(10.00, 300, 1, 2));
+
+    auto bid = book.get_bid_book();
+    CHECK(bid.size() == 2);
+    CHECK(bid[10.00] == 700);
+    CHECK(bid[9.99] == 500);
+    CHECK(book.get_ask_book()[10.01] == 800);
+}
+
+TEST(hybrid_ask_partial_fill_keeps_residual)
+{
+    auto book = make_book();
+    type::data::PriceLevel bids[] = {{10.00, 1000}};
+    type::data::PriceLevel asks[] = {{10.01, 800}, {10.02, 400}};
+    book.resync(bids, 1, asks, 2);
+
+    book.on_trade(sz_fill(10.01, 300, 2, 1));
+
+    auto ask = book.get_ask_book();
+    CHECK(ask.size() == 2);
+    CHECK(ask[10.01] == 500);
+    CHECK(ask[10.02] == 400);
+    CHECK(book.get_bid_book()[10.00] == 1000);
+}
+
+TEST(depth_matches_full_book)
+{
+    auto book = make_book();
+    type::data::PriceLevel bids[] = {{10.00, 1000}, {9.98, 500}};
+    type::data::PriceLevel asks[] = {{10.02, 800}};
+    book.resync(bids, 2, asks, 1);
+
+    //! 挂单价位与快照余量交错, 且乱序到达
+    const double prices[] = {9.97, 9.99, 10.00, 9.95, 9.99, 9.96, 10.03, 10.01, 10.05, 10.02, 10.04};
+    int64_t id = 10;
+    for (double price: prices) {
+        type::data::Order order{};
+        std::strcpy(order.ticker, "000001");
+        order.time = 20210903'09'30'00'000;
+        order.time_ns = 34'200'000'000'000;
+        order.order_id = id;
+        order.business_no = id++;
+        order.price = price;
+        order.qty = 100;
+        order.side = price < 10.01 ? '1' : '2';
+        order.ord_type = '2';
+        order.exchange = type::data::Exchange::SZ;
+        book.restore_order(order);
+    }
+
+    auto check = [&] {
+        for (int32_t count: {1, 3, 10}) {
+            type::data::PriceLevel levels[10];
+            int32_t n = book.bid_depth(levels, count);
+            auto bid = book.get_bid_book();
+            CHECK(n == std::min<int32_t>(count, static_cast<int32_t>(bid.size())));
+            int32_t i = 0;
+            for (auto it = bid.begin(); i < n; ++it, ++i) {
+                CHECK(levels[i].price == it->first && levels[i].qty == it->second);
+            }
+
+            n = book.ask_depth(levels, count);
+            auto ask = book.get_ask_book();
+            CHECK(n == std::min<int32_t>(count, static_cast<int32_t>(ask.size())));
+            i = 0;
+            for (auto it = ask.begin(); i < n; ++it, ++i) {
+                CHECK(levels[i].price == it->first && levels[i].qty == it->second);
+            }
+        }
+    };
+    check();
+    book.compact();
+    check();
+}
@@ -0,0 +1,25 @@
+#include "dat/subscription.h"
+#include "test.h"
+
+TEST(subscription_rejects_switch_to_all)
+{
+    Subscription subscription{{"600000", "000001"}};
+    Subscription::Reader reader{subscription};
+
+    CHECK(!subscription.update({}));
+    CHECK(subscription.version() == 1);
+    CHECK(!reader.refresh());
+    CHECK(reader.table().symbols.size() == 2);
+    CHECK(reader.added().empty());
+}
+
+TEST(subscription_narrows_from_all)
+{
+    Subscription subscription{};
+    Subscription::Reader reader{subscription};
+
+    CHECK(subscription.update({"000001"}));
+    CHECK(reader.refresh());
+    CHECK(reader.table().symbols.size() == 1);
+    CHECK(reader.added().size() == 1 && reader.added()[0] == "000001");
+}
@@ -0,0 +1,55 @@
+//
+// Created by x2h1z on 2021/12/16.
+//
+
+#ifndef ORDERBOOK_TEST_H
+#define ORDERBOOK_TEST_H
+
+#include <vector>
+
+#include "fmt/format.h"
+
+namespace x2h::test
+{
+    struct Case
+    {
+        const char *name;
+        void (*fn)();
+    };
+
+    inline std::vector<Case> &cases()
+    {
+        static std::vector<Case> registry;
+        return registry;
+    }
+
+    /* 当前用例失败的检查数 */
+    inline int failures = 0;
+
+    struct Register
+    {
+        Register(const char *name, void (*fn)())
+        { cases().push_back({name, fn}); }
+    };
+}
+
+/*!
+ * @brief 定义一个用例, 由 test_main 按注册顺序执行
+*/
+#define TEST(name)                                                        \
+    static void test_##name();                                            \
+    static const x2h::test::Register register_##name{#name, &test_##name}; \
+    static void test_##name()
+
+/*!
+ * @brief 失败时记录位置并继续执行当前用例
+*/
+#define CHECK(expr)                                                                  \
+    do {                                                                             \
+        if (!(expr)) {                                                               \
+            ++x2h::test::failures;                                                   \
+            fmt::print(stderr, "  {}:{}: CHECK({}) 失败\n", __FILE__, __LINE__, #expr); \
+        }                                                                            \
+    } while (false)
+
+#endif //ORDERBOOK_TEST_H
@@ -0,0 +1,23 @@
+#include <string_view>
+
+#include "test.h"
+
+/*!
+ * 用法: ob_test [filter]
+ *   filter 只运行名称包含该字符串的用例
+*/
+int main(int argc, char **argv)
+{
+    std::string_view filter = argc >= 2 ? argv[1] : "";
+
+    int failed = 0;
+    for (const auto &test: x2h::test::cases()) {
+        if (!filter.empty() && std::string_view(test.name).find(filter) == std::string_view::npos) continue;
+
+        x2h::test::failures = 0;
+        test.fn();
+        fmt::print("{:<48} {}\n", test.name, x2h::test::failures == 0 ? "ok" : "FAILED");
+        if (x2h::test::failures != 0) ++failed;
+    }
+    return failed == 0 ? 0 : 1;
+}